@@ -16,7 +16,7 @@
 #include <algorithm>
 #include <cstdio>
 
-#define MAX_COMMANDS 40
+#define MAX_COMMANDS 80
 #define MAX_COMMAND_STRLEN	32
 
 enum class ParamType {
@@ -115,6 +115,28 @@ void BLETextServer::notify(const char* text) {
     Serial.println(text);
 }
 
+// Raw payload on the same characteristic; not echoed to Serial
+void BLETextServer::notifyBinary(const uint8_t* data, size_t length) {
+    if (_readChar && data && length > 0) {
+        _readChar->setValue(data, length);
+        _readChar->notify();
+    }
+}
+
+// Binary block for download: raw over BLE, "prefix=<hex>" on Serial for wired clients
+void BLETextServer::notifyBlock(const char* prefix, const uint8_t* data, size_t length) {
+    static const char HEX_DIGITS[] = "0123456789ABCDEF";
+    notifyBinary(data, length);
+
+    Serial.print(prefix);
+    Serial.print('=');
+    for (size_t i = 0; i < length; ++i) {
+        Serial.print(HEX_DIGITS[data[i] >> 4]);
+        Serial.print(HEX_DIGITS[data[i] & 0x0F]);
+    }
+    Serial.println();
+}
+
 void BLETextServer::notifyFormatted(const char* format, ...) {
     static char buf[BUFFER_SIZE];
     va_list args;
@@ -43,6 +43,8 @@ public:
     void stop();
 
     void notify(const char* text);
+    void notifyBinary(const uint8_t* data, size_t length);
+    void notifyBlock(const char* prefix, const uint8_t* data, size_t length);
     void notifyFormatted(const char* format, ...);
     void notifyString(const char* prefix, String str);
     void notifyValue(const char* prefix, int value);
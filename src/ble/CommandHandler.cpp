@@ -17,8 +17,13 @@
 #include "core/SystemPreferences.h"
 #include "ble/UserInfoFormatter.h"
 #include "core/LogUtils.h"
+#include "core/LatencyProfiler.h"
+#include "core/JobSession.h"
+#include "storage/JobLog.h"
+#include "storage/TimeSeriesLog.h"
 
 #define MAX_BLE_PACKET_SIZE 244  // Example BLE max size in bytes (adjust as needed)
+#define TASK_INFO_PACKET_OVERHEAD 24  // version prefix + pktId field
 
 static constexpr const char* CMD_SET_LOG_LEVEL              = "setLogLevel";
 
@@ -33,7 +38,18 @@ static constexpr const char* CMD_SET_IN_WORK_ZONE           = "setInWorkZone";
 
 static constexpr const char* CMD_SET_TARGET_FLOW_RATE_DAA   = "setTargetFlowRatePerDaa";
 static constexpr const char* CMD_SET_TARGET_FLOW_RATE_MIN   = "setTargetFlowRatePerMin";
+static constexpr const char* CMD_SET_FLOW_MODE              = "setFlowMode";
+static constexpr const char* CMD_SET_CONTROL_ALGORITHM      = "setCtrlAlgo";
+static constexpr const char* CMD_SET_FLOW_COEFF             = "setFlowCoeff";
+static constexpr const char* CMD_SET_BOOM_WIDTH             = "setBoomWidth";
+static constexpr const char* CMD_SET_RAMP_PROFILE           = "setRampProfile";
+static constexpr const char* CMD_SET_RAMP_RATE              = "setRampRate";
+static constexpr const char* CMD_SET_RAMP_ACCEL             = "setRampAccel";
+static constexpr const char* CMD_SET_ACTUATOR_LATENCY       = "setActuatorLatency";
+static constexpr const char* CMD_SET_LATENCY_LEARNING       = "setLatencyLearning";
+static constexpr const char* CMD_SET_LATERAL_OFFSET         = "setLateralOffset";
 static constexpr const char* CMD_SET_TANK_LEVEL             = "setTankLevel";
+static constexpr const char* CMD_SET_TANK_WARNING           = "setTankWarning";
 static constexpr const char* CMD_SET_MEASURED_WEIGHT        = "setMeasuredWeight";
 
 static constexpr const char* CMD_SET_SPEED_SOURCE           = "setSpeedSource";
@@ -45,10 +61,50 @@ static constexpr const char* CMD_SET_HEARTBEAT_PERIOD       = "setHeartBeat";
 static constexpr const char* CMD_GET_ERROR_INFO             = "reportError";
 static constexpr const char* CMD_SET_PI_KP                  = "setPIDKp";
 static constexpr const char* CMD_SET_PI_KI                  = "setPIDKi";
+static constexpr const char* CMD_SET_PI_KD                  = "setPIDKd";
 
 static constexpr const char* CMD_REPORT_PID_PARAMS          = "reportPIDParams";
 static constexpr const char* CMD_REPORT_USER_PARAMS         = "reportUserParams";
 
+static constexpr const char* CMD_ARM_CAPTURE                = "armCapture";
+static constexpr const char* CMD_TRIGGER_CAPTURE            = "triggerCapture";
+static constexpr const char* CMD_GET_CAPTURE_INFO           = "getCaptureInfo";
+static constexpr const char* CMD_GET_CAPTURE_CHUNK          = "getCaptureChunk";
+
+static constexpr const char* CMD_SET_LATENCY_PROFILING      = "setLatencyProfiling";
+static constexpr const char* CMD_GET_LATENCY_INFO           = "getLatencyInfo";
+static constexpr const char* CMD_RESET_LATENCY_INFO         = "resetLatencyInfo";
+
+static constexpr const char* CMD_SET_SHADOW_MODE            = "setShadowMode";
+static constexpr const char* CMD_SET_SHADOW_KP              = "setShadowKp";
+static constexpr const char* CMD_SET_SHADOW_KI              = "setShadowKi";
+static constexpr const char* CMD_SET_SHADOW_KD              = "setShadowKd";
+static constexpr const char* CMD_GET_SHADOW_INFO            = "getShadowInfo";
+static constexpr const char* CMD_PROMOTE_SHADOW             = "promoteShadow";
+
+static constexpr const char* CMD_GET_JOB_SESSION            = "getJobSession";
+static constexpr const char* CMD_RESUME_JOB                 = "resumeJob";
+
+static constexpr const char* CMD_GET_JOB_LOG_INFO           = "getJobLogInfo";
+static constexpr const char* CMD_LIST_JOBS                  = "listJobs";
+static constexpr const char* CMD_FIND_JOBS                  = "findJobs";
+static constexpr const char* CMD_GET_JOB_RECORD             = "getJobRecord";
+
+static constexpr const char* CMD_SET_TS_DECIMATION          = "setTsDecimation";
+static constexpr const char* CMD_SET_TS_RETENTION           = "setTsRetention";
+static constexpr const char* CMD_GET_TS_INFO                = "getTsInfo";
+static constexpr const char* CMD_GET_TS_BLOCK               = "getTsBlock";
+
+static constexpr const char* CMD_SET_OVERLAP_SHUTOFF        = "setOverlapShutoff";
+static constexpr const char* CMD_GET_COVERAGE_INFO          = "getCoverageInfo";
+static constexpr const char* CMD_RESET_COVERAGE             = "resetCoverage";
+
+static constexpr const char* CMD_GET_AS_APPLIED_INFO        = "getAsAppliedInfo";
+static constexpr const char* CMD_GET_AS_APPLIED_BLOCK       = "getAsAppliedBlock";
+
+static constexpr const char* CMD_GET_GPS_STATS              = "getGpsStats";
+static constexpr const char* CMD_SET_GPS_BACKEND            = "setGpsBackend";
+
 SystemContext* CommandHandler::context = nullptr;
 
 // when adding new commands, consider increasing 'MAX_COMMANDS' in BLECommandParser
@@ -66,22 +122,81 @@ void CommandHandler::registerHandlers(void) {
     parser.registerCommand(CMD_SET_IN_WORK_ZONE, handlerSetInWorkZone);
     parser.registerCommand(CMD_SET_TARGET_FLOW_RATE_DAA, handlerSetTargetFlowRatePerDaa);
     parser.registerCommand(CMD_SET_TARGET_FLOW_RATE_MIN, handlerSetTargetFlowRatePerMin);
+    parser.registerCommand(CMD_SET_FLOW_MODE, handlerSetFlowMode);
+    parser.registerCommand(CMD_SET_CONTROL_ALGORITHM, handlerSetControlAlgorithm);
+    parser.registerCommand(CMD_SET_FLOW_COEFF, handlerSetFlowCoeff);
+    parser.registerCommand(CMD_SET_BOOM_WIDTH, handlerSetBoomWidth);
+    parser.registerCommand(CMD_SET_RAMP_PROFILE, handlerSetRampProfile);
+    parser.registerCommand(CMD_SET_RAMP_RATE, handlerSetRampRate);
+    parser.registerCommand(CMD_SET_RAMP_ACCEL, handlerSetRampAccel);
+    parser.registerCommand(CMD_SET_ACTUATOR_LATENCY, handlerSetActuatorLatency);
+    parser.registerCommand(CMD_SET_LATENCY_LEARNING, handlerSetLatencyLearning);
+    parser.registerCommand(CMD_SET_LATERAL_OFFSET, handlerSetLateralOffset);
     parser.registerCommand(CMD_SET_MEASURED_WEIGHT, handlerSetMeasuredWeight);
     parser.registerCommand(CMD_SET_SPEED_SOURCE, handlerSetSpeedSource);
     parser.registerCommand(CMD_SET_MIN_WORKING_SPEED, handlerSetMinWorkingSpeed);
     parser.registerCommand(CMD_SET_SIM_SPEED, handlerSetSimSpeed);
     parser.registerCommand(CMD_SET_TANK_LEVEL, handlerSetTankLevel);
+    parser.registerCommand(CMD_SET_TANK_WARNING, handlerSetTankWarning);
     parser.registerCommand(CMD_SET_AUTO_REFRESH_PERIOD, handlerSetAutoRefreshPeriod);
     parser.registerCommand(CMD_SET_HEARTBEAT_PERIOD, handlerSetHeartBeatPeriod);
     parser.registerCommand(CMD_GET_ERROR_INFO, handlerGetErrorInfo);
     parser.registerCommand(CMD_SET_PI_KP, handlerSetPIDKp);
     parser.registerCommand(CMD_SET_PI_KI, handlerSetPIDKi);
+    parser.registerCommand(CMD_SET_PI_KD, handlerSetPIDKd);
     parser.registerCommand(CMD_REPORT_PID_PARAMS, handlerReportPIParams);
     parser.registerCommand(CMD_REPORT_USER_PARAMS, handlerReportUserParams);
+    parser.registerCommand(CMD_ARM_CAPTURE, handlerArmCapture);
+    parser.registerCommand(CMD_TRIGGER_CAPTURE, handlerTriggerCapture);
+    parser.registerCommand(CMD_GET_CAPTURE_INFO, handlerGetCaptureInfo);
+    parser.registerCommand(CMD_GET_CAPTURE_CHUNK, handlerGetCaptureChunk);
+    parser.registerCommand(CMD_SET_LATENCY_PROFILING, handlerSetLatencyProfiling);
+    parser.registerCommand(CMD_GET_LATENCY_INFO, handlerGetLatencyInfo);
+    parser.registerCommand(CMD_RESET_LATENCY_INFO, handlerResetLatencyInfo);
+    parser.registerCommand(CMD_SET_SHADOW_MODE, handlerSetShadowMode);
+    parser.registerCommand(CMD_SET_SHADOW_KP, handlerSetShadowGain);
+    parser.registerCommand(CMD_SET_SHADOW_KI, handlerSetShadowGain);
+    parser.registerCommand(CMD_SET_SHADOW_KD, handlerSetShadowGain);
+    parser.registerCommand(CMD_GET_SHADOW_INFO, handlerGetShadowInfo);
+    parser.registerCommand(CMD_PROMOTE_SHADOW, handlerPromoteShadow);
+    parser.registerCommand(CMD_GET_JOB_SESSION, handlerGetJobSession);
+    parser.registerCommand(CMD_RESUME_JOB, handlerResumeJob);
+    parser.registerCommand(CMD_GET_JOB_LOG_INFO, handlerGetJobLogInfo);
+    parser.registerCommand(CMD_LIST_JOBS, handlerListJobs);
+    parser.registerCommand(CMD_FIND_JOBS, handlerFindJobs);
+    parser.registerCommand(CMD_GET_JOB_RECORD, handlerGetJobRecord);
+    parser.registerCommand(CMD_SET_TS_DECIMATION, handlerSetTsDecimation);
+    parser.registerCommand(CMD_SET_TS_RETENTION, handlerSetTsRetention);
+    parser.registerCommand(CMD_GET_TS_INFO, handlerGetTsInfo);
+    parser.registerCommand(CMD_GET_TS_BLOCK, handlerGetTsBlock);
+    parser.registerCommand(CMD_SET_OVERLAP_SHUTOFF, handlerSetOverlapShutoff);
+    parser.registerCommand(CMD_GET_COVERAGE_INFO, handlerGetCoverageInfo);
+    parser.registerCommand(CMD_RESET_COVERAGE, handlerResetCoverage);
+    parser.registerCommand(CMD_GET_AS_APPLIED_INFO, handlerGetAsAppliedInfo);
+    parser.registerCommand(CMD_GET_AS_APPLIED_BLOCK, handlerGetAsAppliedBlock);
+    parser.registerCommand(CMD_GET_GPS_STATS, handlerGetGpsStats);
+    parser.registerCommand(CMD_SET_GPS_BACKEND, handlerSetGpsBackend);
 
     parser.sortCommands();
 }
 
+// Channel-indexed commands take the form "cmd<i>=value"; without an index they apply to all channels
+bool CommandHandler::resolveChannelRange(const ParsedInstruction& instr, size_t& first, size_t& last) {
+    if (instr.preParamType != ParamType::INT) {
+        first = 0;
+        last = context->getChannelCount() - 1;
+        return true;
+    }
+
+    if (instr.preParamInt < 0 || static_cast<size_t>(instr.preParamInt) >= context->getChannelCount()) {
+        LogUtils::warn("[CMD] %s: invalid channel index %d\n", instr.command, instr.preParamInt);
+        return false;
+    }
+
+    first = last = static_cast<size_t>(instr.preParamInt);
+    return true;
+}
+
 void CommandHandler::sendBLEPacketChecked(const String& packet) {
     if (packet.length() > MAX_BLE_PACKET_SIZE) {
         LogUtils::warn("[BLE] packet too long! Length=%d, Max=%d. Not sending.\n",
@@ -129,10 +244,10 @@ void CommandHandler::handlerGetDeviceInfo(const ParsedInstruction& instr) {
 void CommandHandler::handlerGetSpeedInfo(const ParsedInstruction& instr) {
     const GPSProvider& gpsProvider = context->getGPSProvider();
     Location_t loc = gpsProvider.getLocation();
-    const SystemParams& params = context->getParams();
+    SystemParams params = context->getParams();
 
     UserInfoFormatter::GPSInfoData gpsData = {
-        params.speedSource.c_str(),
+        SystemParams::speedSourceToString(params.speedSource),
         params.minWorkingSpeed,
         params.simSpeed,
         gpsProvider.getSpeed(),
@@ -146,48 +261,72 @@ void CommandHandler::handlerGetSpeedInfo(const ParsedInstruction& instr) {
 }
 
 void CommandHandler::handlerGetTaskInfo(const ParsedInstruction& instr) {
-    DispenserChannel& left = context->getLeftChannel();
-    DispenserChannel& right = context->getRightChannel();
-    ApplicationMetrics& leftMetrics = left.getTaskController().getMetrics();
-    ApplicationMetrics& rightMetrics = right.getTaskController().getMetrics();
-        
-    UserInfoFormatter::TaskChannelInfoData leftData = {
-        left.getTargetFlowRatePerDaa(), left.getTargetFlowRatePerMin(),
-        left.getRealFlowRatePerDaa(), left.getRealFlowRatePerMin(),
-        (int) ApplicationMetrics::getTankLevel(),
-        leftMetrics.getArea(), leftMetrics.getDuration(), leftMetrics.getConsumption()
-    };
+    String channelParts = "";
+
+    // Split across packets when all sections do not fit into one BLE notification
+    for (size_t i = 0; i < context->getChannelCount(); ++i) {
+        const DispenserChannel& channel = context->getChannel(i);
+        const ApplicationMetrics& metrics = channel.getTaskController().getMetrics();
 
-    UserInfoFormatter::TaskChannelInfoData rightData = {
-        right.getTargetFlowRatePerDaa(), right.getTargetFlowRatePerMin(),
-        right.getRealFlowRatePerDaa(), right.getRealFlowRatePerMin(),
-        (int) ApplicationMetrics::getTankLevel(),
-        rightMetrics.getArea(), rightMetrics.getDuration(), rightMetrics.getConsumption()
+        UserInfoFormatter::TaskChannelInfoData data = {
+            channel.getTargetFlowRatePerDaa(), channel.getTargetFlowRatePerMin(),
+            channel.getRealFlowRatePerDaa(), channel.getRealFlowRatePerMin(),
+            (int) ApplicationMetrics::getTankLevel(),
+            metrics.getArea(), metrics.getDuration(), metrics.getConsumption(),
+            static_cast<int>(channel.getFlowMode())
+        };
+
+        String part = UserInfoFormatter::makeTaskChannelPart(i, data);
+        if (channelParts.length() > 0 &&
+            channelParts.length() + part.length() + TASK_INFO_PACKET_OVERHEAD > MAX_BLE_PACKET_SIZE) {
+            sendBLEPacketChecked(UserInfoFormatter::makeTaskInfoPacket(channelParts));
+            channelParts = "";
+        }
+        channelParts += part;
+    }
+
+    // Tank prediction is shared by all sections and goes after the last one
+    const TankEstimator& tank = context->getTankEstimator();
+    UserInfoFormatter::TankInfoData tankData = {
+        tank.getLevelKg(), tank.getConsumptionKgPerMin(),
+        tank.getMinutesToEmpty(), tank.getHectaresToEmpty(),
+        tank.isLowWarning() ? 1 : 0
     };
+    String tankPart = UserInfoFormatter::makeTankPart(tankData);
+    if (channelParts.length() + tankPart.length() + TASK_INFO_PACKET_OVERHEAD > MAX_BLE_PACKET_SIZE) {
+        sendBLEPacketChecked(UserInfoFormatter::makeTaskInfoPacket(channelParts));
+        channelParts = "";
+    }
+    channelParts += tankPart;
 
-    String packet = UserInfoFormatter::makeTaskInfoPacket(leftData, rightData);
-    sendBLEPacketChecked(packet);
+    sendBLEPacketChecked(UserInfoFormatter::makeTaskInfoPacket(channelParts));
 }
 
 void CommandHandler::handlerReportPIParams(const ParsedInstruction& instr) {
-    UserInfoFormatter::PIInfoData piData = {
-        context->getLeftChannel().getPIController().getPIKp(),
-        context->getLeftChannel().getPIController().getPIKi()
-    };
+    PIGains gains = context->getChannel(0).getPIGains();
+    UserInfoFormatter::PIInfoData piData = { gains.kp, gains.ki, gains.kd };
 
     String packet = UserInfoFormatter::makePIPacket(piData);
     sendBLEPacketChecked(packet);
 }
 
+/*
+  State changes are queued for the control task, so the reply only says whether
+  the request got into the queue: <channel>,queued|dropped|invalid,<state>.
+  A queued request the transition table refuses is reported from loop() once
+  the control task has seen it, as <channel>,rejected,<from>,<to>.
+*/
 void CommandHandler::handlerSetTaskState(const ParsedInstruction& instr) {
     if (instr.preParamType == ParamType::INT) {
         const int channelIndex = instr.preParamInt;
         if (instr.postParamType == ParamType::INT) {
-            const UserTaskState newState = static_cast<UserTaskState>(instr.postParam.i);
-            if (channelIndex == 0) {
-                context->getLeftChannel().getTaskController().setTaskState(newState);
-            } else if (channelIndex == 1) {
-                context->getRightChannel().getTaskController().setTaskState(newState);
+            if (channelIndex >= 0 && static_cast<size_t>(channelIndex) < context->getChannelCount()) {
+                const char* result = "invalid";
+                if (instr.postParam.i >= 0 && static_cast<size_t>(instr.postParam.i) < TASK_STATE_COUNT) {
+                    const UserTaskState newState = static_cast<UserTaskState>(instr.postParam.i);
+                    result = context->getChannel(channelIndex).getTaskController().setTaskState(newState) ? "queued" : "dropped";
+                }
+                sendBLEPacketChecked(String(CMD_SET_TASK_STATE) + "=" + String(channelIndex) + "," + result + "," + String(instr.postParam.i));
             }
         } else {
             // TODO report current task state
@@ -195,6 +334,12 @@ void CommandHandler::handlerSetTaskState(const ParsedInstruction& instr) {
     }
 }
 
+void CommandHandler::notifyTaskStateRejected(size_t channel, const TaskStateController& controller) {
+    sendBLEPacketChecked(String(CMD_SET_TASK_STATE) + "=" + String(static_cast<int>(channel)) + ",rejected,"
+                         + String(static_cast<int>(controller.getLastRejectedFrom())) + ","
+                         + String(static_cast<int>(controller.getLastRejectedTo())));
+}
+
 void CommandHandler::handlerSetInWorkZone(const ParsedInstruction& instr) {
     if (instr.postParamType == ParamType::INT) {
         DispenserChannel::setClientInWorkZone(instr.postParam.i > 0);
@@ -206,25 +351,196 @@ void CommandHandler::handlerSetInWorkZone(const ParsedInstruction& instr) {
 }
 
 void CommandHandler::handlerSetTargetFlowRatePerDaa(const ParsedInstruction& instr) {
+    size_t first, last;
+    if (!resolveChannelRange(instr, first, last)) return;
+
     if (instr.postParamType == ParamType::FLOAT) {
-        context->getLeftChannel().setTargetFlowRatePerDaa(instr.postParam.f);
-        context->getLeftChannel().setTargetFlowRatePerMin(0.0f);
-        SystemPreferences::save(PrefKey::KEY_LEFT_RATE_DAA, context->getLeftChannel().getTargetFlowRatePerMin());
-        SystemPreferences::save(PrefKey::KEY_LEFT_RATE_MIN, context->getLeftChannel().getTargetFlowRatePerDaa());
+        for (size_t i = first; i <= last; ++i) {
+            DispenserChannel& channel = context->getChannel(i);
+            channel.setTargetFlowRatePerDaa(instr.postParam.f);
+            channel.setFlowMode(FlowControlMode::PerArea);
+            SystemPreferences::save(PrefKey::KEY_CH_RATE_DAA, i, channel.getTargetFlowRatePerDaa());
+            SystemPreferences::save(PrefKey::KEY_CH_FLOW_MODE, i, static_cast<int>(channel.getFlowMode()));
+        }
     }
 
-    context->getBLETextServer().notifyValue(CMD_SET_TARGET_FLOW_RATE_DAA, context->getLeftChannel().getTargetFlowRatePerDaa());
+    context->getBLETextServer().notifyIndexedValue(CMD_SET_TARGET_FLOW_RATE_DAA, first, context->getChannel(first).getTargetFlowRatePerDaa());
 }
 
 void CommandHandler::handlerSetTargetFlowRatePerMin(const ParsedInstruction& instr) {
+    size_t first, last;
+    if (!resolveChannelRange(instr, first, last)) return;
+
+    if (instr.postParamType == ParamType::FLOAT) {
+        for (size_t i = first; i <= last; ++i) {
+            DispenserChannel& channel = context->getChannel(i);
+            channel.setTargetFlowRatePerMin(instr.postParam.f);
+            channel.setFlowMode(FlowControlMode::PerMinute);
+            SystemPreferences::save(PrefKey::KEY_CH_RATE_MIN, i, channel.getTargetFlowRatePerMin());
+            SystemPreferences::save(PrefKey::KEY_CH_FLOW_MODE, i, static_cast<int>(channel.getFlowMode()));
+        }
+    }
+
+    context->getBLETextServer().notifyIndexedValue(CMD_SET_TARGET_FLOW_RATE_MIN, first, context->getChannel(first).getTargetFlowRatePerMin());
+}
+
+void CommandHandler::handlerSetFlowMode(const ParsedInstruction& instr) {
+    size_t first, last;
+    if (!resolveChannelRange(instr, first, last)) return;
+
+    if (instr.postParamType == ParamType::INT) {
+        for (size_t i = first; i <= last; ++i) {
+            DispenserChannel& channel = context->getChannel(i);
+            channel.setFlowMode(static_cast<FlowControlMode>(instr.postParam.i));
+            SystemPreferences::save(PrefKey::KEY_CH_FLOW_MODE, i, static_cast<int>(channel.getFlowMode()));
+        }
+    }
+
+    context->getBLETextServer().notifyIndexedValue(CMD_SET_FLOW_MODE, first, static_cast<int>(context->getChannel(first).getFlowMode()));
+}
+
+// 0 = PI, 1 = MPC
+void CommandHandler::handlerSetControlAlgorithm(const ParsedInstruction& instr) {
+    size_t first, last;
+    if (!resolveChannelRange(instr, first, last)) return;
+
+    if (instr.postParamType == ParamType::INT) {
+        if (instr.postParam.i < 0 || instr.postParam.i > static_cast<int>(GateControlAlgorithm::MPC)) {
+            LogUtils::warn("[CMD] %s: unknown algorithm %d\n", instr.command, instr.postParam.i);
+            return;
+        }
+        for (size_t i = first; i <= last; ++i) {
+            DispenserChannel& channel = context->getChannel(i);
+            channel.setControlAlgorithm(static_cast<GateControlAlgorithm>(instr.postParam.i));
+            SystemPreferences::save(PrefKey::KEY_CH_CONTROL_ALGORITHM, i, static_cast<int>(channel.getControlAlgorithm()));
+        }
+    }
+
+    context->getBLETextServer().notifyIndexedValue(CMD_SET_CONTROL_ALGORITHM, first, static_cast<int>(context->getChannel(first).getControlAlgorithm()));
+}
+
+void CommandHandler::handlerSetFlowCoeff(const ParsedInstruction& instr) {
+    size_t first, last;
+    if (!resolveChannelRange(instr, first, last)) return;
+
+    if (instr.postParamType == ParamType::FLOAT) {
+        for (size_t i = first; i <= last; ++i) {
+            context->getChannel(i).setFlowCoeff(instr.postParam.f);
+            SystemPreferences::save(PrefKey::KEY_CH_FLOW_COEFF, i, context->getChannel(i).getFlowCoeff());
+        }
+    }
+
+    context->getBLETextServer().notifyIndexedValue(CMD_SET_FLOW_COEFF, first, context->getChannel(first).getFlowCoeff());
+}
+
+void CommandHandler::handlerSetBoomWidth(const ParsedInstruction& instr) {
+    size_t first, last;
+    if (!resolveChannelRange(instr, first, last)) return;
+
     if (instr.postParamType == ParamType::FLOAT) {
-        context->getLeftChannel().setTargetFlowRatePerMin(instr.postParam.f);
-        context->getLeftChannel().setTargetFlowRatePerDaa(0.0f);
-        SystemPreferences::save(PrefKey::KEY_LEFT_RATE_DAA, context->getLeftChannel().getTargetFlowRatePerMin());
-        SystemPreferences::save(PrefKey::KEY_LEFT_RATE_MIN, context->getLeftChannel().getTargetFlowRatePerDaa());
+        for (size_t i = first; i <= last; ++i) {
+            context->getChannel(i).setBoomWidth(instr.postParam.f);
+            SystemPreferences::save(PrefKey::KEY_CH_BOOM_WIDTH, i, context->getChannel(i).getBoomWidth());
+        }
+    }
+
+    context->getBLETextServer().notifyIndexedValue(CMD_SET_BOOM_WIDTH, first, context->getChannel(first).getBoomWidth());
+}
+
+void CommandHandler::handlerSetRampProfile(const ParsedInstruction& instr) {
+    size_t first, last;
+    if (!resolveChannelRange(instr, first, last)) return;
+
+    if (instr.postParamType == ParamType::INT) {
+        for (size_t i = first; i <= last; ++i) {
+            SetpointShaper& shaper = context->getChannel(i).getSetpointShaper();
+            shaper.setProfile(static_cast<RampProfile>(instr.postParam.i));
+            SystemPreferences::save(PrefKey::KEY_CH_RAMP_PROFILE, i, static_cast<int>(shaper.getProfile()));
+        }
     }
 
-    context->getBLETextServer().notifyValue(CMD_SET_TARGET_FLOW_RATE_MIN, context->getLeftChannel().getTargetFlowRatePerMin());
+    const SetpointShaper& shaper = context->getChannel(first).getSetpointShaper();
+    context->getBLETextServer().notifyIndexedValue(CMD_SET_RAMP_PROFILE, first, static_cast<int>(shaper.getProfile()));
+}
+
+void CommandHandler::handlerSetRampRate(const ParsedInstruction& instr) {
+    size_t first, last;
+    if (!resolveChannelRange(instr, first, last)) return;
+
+    if (instr.postParamType == ParamType::FLOAT) {
+        for (size_t i = first; i <= last; ++i) {
+            SetpointShaper& shaper = context->getChannel(i).getSetpointShaper();
+            shaper.setLimits(instr.postParam.f, shaper.getMaxAccel());
+            SystemPreferences::save(PrefKey::KEY_CH_RAMP_PROFILE, i, static_cast<int>(shaper.getProfile()));
+            SystemPreferences::save(PrefKey::KEY_CH_RAMP_RATE, i, shaper.getMaxRate());
+            SystemPreferences::save(PrefKey::KEY_CH_RAMP_ACCEL, i, shaper.getMaxAccel());
+        }
+    }
+
+    context->getBLETextServer().notifyIndexedValue(CMD_SET_RAMP_RATE, first, context->getChannel(first).getSetpointShaper().getMaxRate());
+}
+
+void CommandHandler::handlerSetRampAccel(const ParsedInstruction& instr) {
+    size_t first, last;
+    if (!resolveChannelRange(instr, first, last)) return;
+
+    if (instr.postParamType == ParamType::FLOAT) {
+        for (size_t i = first; i <= last; ++i) {
+            SetpointShaper& shaper = context->getChannel(i).getSetpointShaper();
+            shaper.setLimits(shaper.getMaxRate(), instr.postParam.f);
+            SystemPreferences::save(PrefKey::KEY_CH_RAMP_PROFILE, i, static_cast<int>(shaper.getProfile()));
+            SystemPreferences::save(PrefKey::KEY_CH_RAMP_RATE, i, shaper.getMaxRate());
+            SystemPreferences::save(PrefKey::KEY_CH_RAMP_ACCEL, i, shaper.getMaxAccel());
+        }
+    }
+
+    context->getBLETextServer().notifyIndexedValue(CMD_SET_RAMP_ACCEL, first, context->getChannel(first).getSetpointShaper().getMaxAccel());
+}
+
+void CommandHandler::handlerSetActuatorLatency(const ParsedInstruction& instr) {
+    size_t first, last;
+    if (!resolveChannelRange(instr, first, last)) return;
+
+    if (instr.postParamType == ParamType::FLOAT) {
+        for (size_t i = first; i <= last; ++i) {
+            context->getChannel(i).setActuatorLatency(instr.postParam.f);
+            SystemPreferences::save(PrefKey::KEY_CH_LATENCY, i, context->getChannel(i).getActuatorLatency());
+        }
+    }
+
+    context->getBLETextServer().notifyIndexedValue(CMD_SET_ACTUATOR_LATENCY, first, context->getChannel(first).getActuatorLatency());
+}
+
+void CommandHandler::handlerSetLatencyLearning(const ParsedInstruction& instr) {
+    size_t first, last;
+    if (!resolveChannelRange(instr, first, last)) return;
+
+    if (instr.postParamType == ParamType::INT) {
+        for (size_t i = first; i <= last; ++i) {
+            context->getChannel(i).setLatencyLearning(instr.postParam.i > 0);
+            SystemPreferences::save(PrefKey::KEY_CH_LATENCY_LEARN, i, instr.postParam.i > 0 ? 1 : 0);
+        }
+    }
+
+    // Report the horizon actually in use (learned or configured)
+    context->getBLETextServer().notifyIndexedValue(CMD_SET_LATENCY_LEARNING, first, context->getChannel(first).getLookAheadSec());
+}
+
+// "setLateralOffset<i>=<m>" (positive to the right) or "=auto" to derive it from the boom widths
+void CommandHandler::handlerSetLateralOffset(const ParsedInstruction& instr) {
+    size_t first, last;
+    if (!resolveChannelRange(instr, first, last)) return;
+
+    bool isAuto = instr.postParamType == ParamType::STRING && strcmp(instr.postParamStr, "auto") == 0;
+    if (instr.postParamType == ParamType::FLOAT || instr.postParamType == ParamType::INT || isAuto) {
+        float offset = isAuto ? NAN : (instr.postParamType == ParamType::FLOAT ? instr.postParam.f : static_cast<float>(instr.postParam.i));
+        for (size_t i = first; i <= last; ++i) {
+            context->getChannel(i).setLateralOffset(offset);
+            SystemPreferences::save(PrefKey::KEY_CH_LATERAL_OFFSET, i, offset);
+        }
+    }
+
+    context->getBLETextServer().notifyIndexedValue(CMD_SET_LATERAL_OFFSET, first, context->getChannel(first).getLateralOffset());
 }
 
 void CommandHandler::handlerSetMeasuredWeight(const ParsedInstruction& instr) {
@@ -232,53 +548,71 @@ void CommandHandler::handlerSetMeasuredWeight(const ParsedInstruction& instr) {
 }
 
 void CommandHandler::handlerSetSpeedSource(const ParsedInstruction& instr) {
-    SystemParams& params = context->getParams();
+    SystemParams params = context->getParams();
     if (instr.postParamType == ParamType::STRING) {
-        params.speedSource = instr.postParamStr;
-        SystemPreferences::save(PrefKey::KEY_SPEED_SRC, params.speedSource);
+        params.speedSource = SystemParams::speedSourceFromString(instr.postParamStr);
+        context->setParams(params);
+        SystemPreferences::save(PrefKey::KEY_SPEED_SRC, String(SystemParams::speedSourceToString(params.speedSource)));
     }
-    context->getBLETextServer().notifyString(CMD_SET_SPEED_SOURCE, params.speedSource);
+    context->getBLETextServer().notifyString(CMD_SET_SPEED_SOURCE, SystemParams::speedSourceToString(params.speedSource));
 }
 
 void CommandHandler::handlerSetMinWorkingSpeed(const ParsedInstruction& instr) {
-    SystemParams& params = context->getParams();
+    SystemParams params = context->getParams();
     if (instr.postParamType == ParamType::FLOAT) {
         params.minWorkingSpeed = instr.postParam.f;
+        context->setParams(params);
         SystemPreferences::save(PrefKey::KEY_MIN_SPEED, params.minWorkingSpeed);
     }
     context->getBLETextServer().notifyValue(CMD_SET_MIN_WORKING_SPEED, params.minWorkingSpeed);
 }
 
 void CommandHandler::handlerSetSimSpeed(const ParsedInstruction& instr) {
-    SystemParams& params = context->getParams();
+    SystemParams params = context->getParams();
     if (instr.postParamType == ParamType::FLOAT) {
         params.simSpeed = instr.postParam.f;
+        context->setParams(params);
         SystemPreferences::save(PrefKey::KEY_SIM_SPEED, params.simSpeed);
     }
     context->getBLETextServer().notifyValue(CMD_SET_SIM_SPEED, params.simSpeed);
 }
 
 void CommandHandler::handlerSetTankLevel(const ParsedInstruction& instr) {
+    float level = ApplicationMetrics::getTankLevel();
     if (instr.postParamType == ParamType::INT) {
-        ApplicationMetrics::setTankLevel(instr.postParam.i);
-        SystemPreferences::save(PrefKey::KEY_TANK_LEVEL, ApplicationMetrics::getTankLevel());
+        level = static_cast<float>(instr.postParam.i);
+        ApplicationMetrics::requestTankLevel(level); // applied by the control task, which also restarts the estimator
+        SystemPreferences::save(PrefKey::KEY_TANK_LEVEL, level);
+    }
+    context->getBLETextServer().notifyValue(CMD_SET_TANK_LEVEL, level);
+}
+
+// setTankWarning=<minutes>: warn when the predicted time to empty falls below it, 0 disables
+void CommandHandler::handlerSetTankWarning(const ParsedInstruction& instr) {
+    TankEstimator& tank = context->getTankEstimator();
+    if (instr.postParamType == ParamType::INT || instr.postParamType == ParamType::FLOAT) {
+        float minutes = instr.postParamType == ParamType::INT ? instr.postParam.i : instr.postParam.f;
+        tank.setWarningMinutes(minutes);
+        SystemPreferences::save(PrefKey::KEY_TANK_WARNING, tank.getWarningMinutes());
     }
-    context->getBLETextServer().notifyValue(CMD_SET_TANK_LEVEL, ApplicationMetrics::getTankLevel());
+    context->getBLETextServer().notifyValue(CMD_SET_TANK_WARNING, tank.getWarningMinutes());
 }
 
 void CommandHandler::handlerSetAutoRefreshPeriod(const ParsedInstruction& instr) {
-    SystemParams& params = context->getParams();
+    SystemParams params = context->getParams();
     if (instr.postParamType == ParamType::INT) {
         params.autoRefreshPeriod = instr.postParam.i;
+        context->setParams(params);
         SystemPreferences::save(PrefKey::KEY_REFRESH, params.autoRefreshPeriod);
     }
     context->getBLETextServer().notifyValue(CMD_SET_AUTO_REFRESH_PERIOD, params.autoRefreshPeriod);
 }
 
 void CommandHandler::handlerSetHeartBeatPeriod(const ParsedInstruction& instr) {
-    SystemParams& params = context->getParams();
+    SystemParams params = context->getParams();
     if (instr.postParamType == ParamType::INT) {
         params.heartBeatPeriod = instr.postParam.i;
+        context->setParams(params);
         SystemPreferences::save(PrefKey::KEY_HEARTBEAT, params.heartBeatPeriod);
     }
     context->getBLETextServer().notifyValue(CMD_SET_HEARTBEAT_PERIOD, params.heartBeatPeriod);
@@ -289,29 +623,499 @@ void CommandHandler::handlerGetErrorInfo(const ParsedInstruction& instr) {
 }
 
 void CommandHandler::handlerSetPIDKp(const ParsedInstruction& instr) {
-    PIController& leftPI = context->getLeftChannel().getPIController();
-    PIController& rightPI = context->getRightChannel().getPIController();
-
     if (instr.postParamType == ParamType::FLOAT) {
-        leftPI.setPIKp(instr.postParam.f);
-        rightPI.setPIKp(instr.postParam.f);
-        SystemPreferences::save(PrefKey::KEY_PI_KP, leftPI.getPIKp());
+        for (size_t i = 0; i < context->getChannelCount(); ++i) {
+            PIGains gains = context->getChannel(i).getPIGains();
+            gains.kp = instr.postParam.f;
+            context->getChannel(i).requestPIGains(gains);
+        }
+        SystemPreferences::save(PrefKey::KEY_PI_KP, context->getChannel(0).getPIGains().kp);
     }
-    context->getBLETextServer().notifyValue(CMD_SET_PI_KP, leftPI.getPIKp());
+    context->getBLETextServer().notifyValue(CMD_SET_PI_KP, context->getChannel(0).getPIGains().kp);
 }
 
 void CommandHandler::handlerSetPIDKi(const ParsedInstruction& instr) {
-    PIController& leftPI = context->getLeftChannel().getPIController();
-    PIController& rightPI = context->getRightChannel().getPIController();
+    if (instr.postParamType == ParamType::FLOAT) {
+        for (size_t i = 0; i < context->getChannelCount(); ++i) {
+            PIGains gains = context->getChannel(i).getPIGains();
+            gains.ki = instr.postParam.f;
+            context->getChannel(i).requestPIGains(gains);
+        }
+        SystemPreferences::save(PrefKey::KEY_PI_KI, context->getChannel(0).getPIGains().ki);
+    }
+    context->getBLETextServer().notifyValue(CMD_SET_PI_KI, context->getChannel(0).getPIGains().ki);
+}
 
+void CommandHandler::handlerSetPIDKd(const ParsedInstruction& instr) {
     if (instr.postParamType == ParamType::FLOAT) {
-        leftPI.setPIKi(instr.postParam.f);
-        rightPI.setPIKi(instr.postParam.f);
-        SystemPreferences::save(PrefKey::KEY_PI_KI, leftPI.getPIKi());
+        for (size_t i = 0; i < context->getChannelCount(); ++i) {
+            PIGains gains = context->getChannel(i).getPIGains();
+            gains.kd = instr.postParam.f;
+            context->getChannel(i).requestPIGains(gains);
+        }
+        SystemPreferences::save(PrefKey::KEY_PI_KD, context->getChannel(0).getPIGains().kd);
     }
-    context->getBLETextServer().notifyValue(CMD_SET_PI_KI, leftPI.getPIKi());
+    context->getBLETextServer().notifyValue(CMD_SET_PI_KD, context->getChannel(0).getPIGains().kd);
 }
 
 void CommandHandler::handlerReportUserParams(const ParsedInstruction& instr) {
     // TODO: implement handlerReportUserParams
 }
+
+// "armCapture<i>=<seconds>" arms channel i (default 0); seconds=0 cancels
+void CommandHandler::handlerArmCapture(const ParsedInstruction& instr) {
+    StepResponseCapture& capture = context->getStepCapture();
+    size_t channel = 0;
+
+    if (instr.preParamType == ParamType::INT) {
+        if (instr.preParamInt < 0 || static_cast<size_t>(instr.preParamInt) >= context->getChannelCount()) {
+            LogUtils::warn("[CMD] %s: invalid channel index %d\n", instr.command, instr.preParamInt);
+            return;
+        }
+        channel = static_cast<size_t>(instr.preParamInt);
+    }
+
+    // The control task applies the request at its next tick, so the reply states the requested state
+    CaptureState reply = capture.getState();
+    if (instr.postParamType == ParamType::INT) {
+        if (instr.postParam.i <= 0) {
+            capture.cancel();
+            reply = CaptureState::Idle;
+        } else if (capture.arm(channel, instr.postParam.i)) {
+            reply = CaptureState::Armed;
+        } else {
+            LogUtils::warn("[CMD] %s: duration must be 1..%d s\n", instr.command, static_cast<int>(StepResponseCapture::MAX_CAPTURE_SECONDS));
+        }
+    }
+
+    context->getBLETextServer().notifyString(CMD_ARM_CAPTURE, StepResponseCapture::stateToString(reply));
+}
+
+void CommandHandler::handlerTriggerCapture(const ParsedInstruction& instr) {
+    StepResponseCapture& capture = context->getStepCapture();
+    capture.trigger();
+    context->getBLETextServer().notifyString(CMD_TRIGGER_CAPTURE, StepResponseCapture::stateToString(capture.getState()));
+}
+
+// Reply: state,channel,samples,chunks,sampleSize
+void CommandHandler::handlerGetCaptureInfo(const ParsedInstruction& instr) {
+    const StepResponseCapture& capture = context->getStepCapture();
+    context->getBLETextServer().notifyFormatted("%s=%s,%u,%u,%u,%u", CMD_GET_CAPTURE_INFO,
+        StepResponseCapture::stateToString(capture.getState()),
+        static_cast<unsigned>(capture.getChannel()),
+        static_cast<unsigned>(capture.getSampleCount()),
+        static_cast<unsigned>(capture.getChunkCount(MAX_BLE_PACKET_SIZE)),
+        static_cast<unsigned>(sizeof(CaptureSample)));
+}
+
+// Pull-based download: the app requests each chunk, so no bursts are queued on the radio
+void CommandHandler::handlerGetCaptureChunk(const ParsedInstruction& instr) {
+    static uint8_t chunk[MAX_BLE_PACKET_SIZE];
+
+    if (instr.postParamType != ParamType::INT || instr.postParam.i < 0) {
+        return;
+    }
+
+    size_t length = context->getStepCapture().readChunk(instr.postParam.i, chunk, sizeof(chunk));
+    if (length == 0) {
+        LogUtils::warn("[CMD] %s: chunk %d not available\n", instr.command, instr.postParam.i);
+        return;
+    }
+
+    context->getBLETextServer().notifyBinary(chunk, length);
+}
+
+void CommandHandler::handlerSetLatencyProfiling(const ParsedInstruction& instr) {
+    if (instr.postParamType == ParamType::INT) {
+        LatencyProfiler::setEnabled(instr.postParam.i > 0);
+    }
+    context->getBLETextServer().notifyValue(CMD_SET_LATENCY_PROFILING, LatencyProfiler::isEnabled() ? 1 : 0);
+}
+
+// One packet per stage: stage,min,avg,max,count,h0..h11 (all µs)
+void CommandHandler::handlerGetLatencyInfo(const ParsedInstruction& instr) {
+    LatencySnapshot snapshot = LatencyProfiler::getSnapshot();
+
+    for (size_t i = 0; i < static_cast<size_t>(LatencyStage::Count); ++i) {
+        LatencyStage stage = static_cast<LatencyStage>(i);
+        const LatencyStats& s = snapshot.get(stage);
+
+        String packet = String(CMD_GET_LATENCY_INFO) + "=" + LatencyProfiler::stageToString(stage) + ","
+                      + String(s.minUs) + "," + String(s.getAvgUs()) + "," + String(s.maxUs) + "," + String(s.count);
+        for (size_t b = 0; b < LatencyStats::HIST_BINS; ++b) {
+            packet += ",";
+            packet += String(s.hist[b]);
+        }
+
+        sendBLEPacketChecked(packet);
+    }
+}
+
+void CommandHandler::handlerResetLatencyInfo(const ParsedInstruction& instr) {
+    LatencyProfiler::requestReset();
+    context->getBLETextServer().notifyValue(CMD_RESET_LATENCY_INFO, 1);
+}
+
+void CommandHandler::handlerSetShadowMode(const ParsedInstruction& instr) {
+    size_t first, last;
+    if (!resolveChannelRange(instr, first, last)) return;
+
+    if (instr.postParamType == ParamType::INT) {
+        for (size_t i = first; i <= last; ++i) {
+            DispenserChannel& channel = context->getChannel(i);
+            bool enable = instr.postParam.i != 0;
+            // Candidates are PI gains scored against the active PI loop
+            if (enable && channel.getControlAlgorithm() == GateControlAlgorithm::MPC) {
+                LogUtils::warn("[CMD] %s: channel %u runs MPC, shadow mode needs PI\n", instr.command, static_cast<unsigned>(i));
+                continue;
+            }
+            channel.getShadowController().setEnabled(enable, channel.getPIGains());
+        }
+    }
+
+    context->getBLETextServer().notifyIndexedValue(CMD_SET_SHADOW_MODE, first,
+        context->getChannel(first).getShadowController().isEnabled() ? 1 : 0);
+}
+
+// setShadowKp/Ki/Kd share one handler; candidate gains are not persisted until promoted
+void CommandHandler::handlerSetShadowGain(const ParsedInstruction& instr) {
+    size_t first, last;
+    if (!resolveChannelRange(instr, first, last)) return;
+
+    bool isKp = strcmp(instr.command, CMD_SET_SHADOW_KP) == 0;
+    bool isKi = strcmp(instr.command, CMD_SET_SHADOW_KI) == 0;
+
+    if (instr.postParamType == ParamType::FLOAT) {
+        for (size_t i = first; i <= last; ++i) {
+            ShadowController& shadow = context->getChannel(i).getShadowController();
+            PIGains gains = shadow.getRequestedGains();
+            if (isKp) {
+                gains.kp = instr.postParam.f;
+            } else if (isKi) {
+                gains.ki = instr.postParam.f;
+            } else {
+                gains.kd = instr.postParam.f;
+            }
+            shadow.requestGains(gains); // scores restart when the control task applies it
+        }
+    }
+
+    PIGains gains = context->getChannel(first).getShadowController().getRequestedGains();
+    float value = isKp ? gains.kp : (isKi ? gains.ki : gains.kd);
+    context->getBLETextServer().notifyIndexedValue(instr.command, first, value);
+}
+
+// Reply: enabled,compareSec,activeIAE,shadowIAE,activeSettleSec,shadowSettleSec,plantGain,kp,ki,kd
+void CommandHandler::handlerGetShadowInfo(const ParsedInstruction& instr) {
+    size_t first, last;
+    if (!resolveChannelRange(instr, first, last)) return;
+
+    for (size_t i = first; i <= last; ++i) {
+        const ShadowController& shadow = context->getChannel(i).getShadowController();
+        PIGains gains = shadow.getRequestedGains();
+        context->getBLETextServer().notifyFormatted("%s%u=%d,%.0f,%.1f,%.1f,%.1f,%.1f,%.3f,%.2f,%.2f,%.2f,%.1f,%.1f,%.0f,%.0f",
+            CMD_GET_SHADOW_INFO, static_cast<unsigned>(i), shadow.isEnabled() ? 1 : 0,
+            shadow.getCompareSeconds(), shadow.getActiveIAE(), shadow.getShadowIAE(),
+            shadow.getActiveSettleSec(), shadow.getShadowSettleSec(), context->getChannel(i).getPlantModel().getGain(),
+            gains.kp, gains.ki, gains.kd,
+            shadow.getActiveOvershoot(), shadow.getShadowOvershoot(), shadow.getActiveTravel(), shadow.getShadowTravel());
+    }
+}
+
+/*
+  Gains are a boom-wide setting, so the winning channel's candidate gains
+  go to every channel and are saved like setPIDKp/Ki/Kd. Refused unless the
+  shadow has a lower IAE, with no worse overshoot and gate travel, over
+  MIN_COMPARE_SEC of work; "=1" forces it. Always refused while the channel
+  runs MPC, where the candidate was not scored against the active loop.
+*/
+void CommandHandler::handlerPromoteShadow(const ParsedInstruction& instr) {
+    size_t channel = 0;
+    if (instr.preParamType == ParamType::INT) {
+        if (instr.preParamInt < 0 || static_cast<size_t>(instr.preParamInt) >= context->getChannelCount()) {
+            LogUtils::warn("[CMD] %s: invalid channel index %d\n", instr.command, instr.preParamInt);
+            return;
+        }
+        channel = static_cast<size_t>(instr.preParamInt);
+    }
+
+    ShadowController& shadow = context->getChannel(channel).getShadowController();
+    bool force = instr.postParamType == ParamType::INT && instr.postParam.i == 1;
+
+    if (context->getChannel(channel).getControlAlgorithm() == GateControlAlgorithm::MPC) {
+        LogUtils::warn("[CMD] %s: channel %u runs MPC, its shadow gains were not scored\n",
+                       instr.command, static_cast<unsigned>(channel));
+        context->getBLETextServer().notifyIndexedValue(CMD_PROMOTE_SHADOW, channel, 0);
+        return;
+    }
+
+    if (!shadow.isEnabled() || (!force && !shadow.isProvenBetter())) {
+        LogUtils::warn("[CMD] %s: shadow on channel %u not proven better (%.0f s, IAE %.1f vs %.1f, "
+                       "overshoot %.1f vs %.1f %%, travel %.0f vs %.0f %%)\n",
+                       instr.command, static_cast<unsigned>(channel), shadow.getCompareSeconds(),
+                       shadow.getShadowIAE(), shadow.getActiveIAE(),
+                       shadow.getShadowOvershoot(), shadow.getActiveOvershoot(),
+                       shadow.getShadowTravel(), shadow.getActiveTravel());
+        context->getBLETextServer().notifyIndexedValue(CMD_PROMOTE_SHADOW, channel, 0);
+        return;
+    }
+
+    // Applied by the control task with the integral rescale; the comparison restarts there too
+    PIGains gains = shadow.getRequestedGains();
+    for (size_t i = 0; i < context->getChannelCount(); ++i) {
+        context->getChannel(i).requestPIGains(gains);
+    }
+
+    SystemPreferences::save(PrefKey::KEY_PI_KP, gains.kp);
+    SystemPreferences::save(PrefKey::KEY_PI_KI, gains.ki);
+    SystemPreferences::save(PrefKey::KEY_PI_KD, gains.kd);
+    LogUtils::info("[CMD] Promoted shadow gains from channel %u: Kp=%.2f Ki=%.2f Kd=%.2f\n",
+                   static_cast<unsigned>(channel), gains.kp, gains.ki, gains.kd);
+    context->getBLETextServer().notifyIndexedValue(CMD_PROMOTE_SHADOW, channel, 1);
+}
+
+// Reply: pending,durationSec,distanceM,areaM2,consumptionKg,tankLevelKg (totals over channels)
+void CommandHandler::handlerGetJobSession(const ParsedInstruction& instr) {
+    if (!JobSession::hasPending()) {
+        context->getBLETextServer().notifyFormatted("%s=0", CMD_GET_JOB_SESSION);
+        return;
+    }
+
+    const JobCheckpoint& job = JobSession::getPending();
+    MetricsSnapshot sum = MetricsSnapshot();
+    for (size_t i = 0; i < DISPENSER_CHANNEL_COUNT; ++i) {
+        // Channels share the tractor: time and distance are the longest, area and mass add up
+        if (job.totals[i].durationMs > sum.durationMs) sum.durationMs = job.totals[i].durationMs;
+        if (job.totals[i].distanceM > sum.distanceM) sum.distanceM = job.totals[i].distanceM;
+        sum.areaM2 += job.totals[i].areaM2;
+        sum.consumptionKg += job.totals[i].consumptionKg;
+    }
+
+    context->getBLETextServer().notifyFormatted("%s=1,%u,%.0f,%.1f,%.2f,%.2f", CMD_GET_JOB_SESSION,
+        static_cast<unsigned>(sum.durationMs / 1000), sum.distanceM, sum.areaM2, sum.consumptionKg, job.tankLevelKg);
+}
+
+// resumeJob=1 continues the interrupted job, resumeJob=0 discards it
+void CommandHandler::handlerResumeJob(const ParsedInstruction& instr) {
+    bool ok = false;
+
+    if (instr.postParamType == ParamType::INT) {
+        if (instr.postParam.i == 1) {
+            ok = JobSession::requestResume();
+        } else if (instr.postParam.i == 0 && JobSession::hasPending()) {
+            JobSession::discard();
+            LogUtils::info("[JOB] Interrupted job discarded.\n");
+            ok = true;
+        }
+    }
+
+    if (!ok) {
+        LogUtils::warn("[CMD] %s: no interrupted job to act on\n", instr.command);
+    }
+    context->getBLETextServer().notifyValue(CMD_RESUME_JOB, ok ? 1 : 0);
+}
+
+// Reply: count,firstJob,lastJob,recordSize,capacity
+void CommandHandler::handlerGetJobLogInfo(const ParsedInstruction& instr) {
+    const JobLog& log = context->getJobLog();
+    context->getBLETextServer().notifyFormatted("%s=%u,%u,%u,%u,%u", CMD_GET_JOB_LOG_INFO,
+        static_cast<unsigned>(log.getCount()), static_cast<unsigned>(log.getFirstJob()),
+        static_cast<unsigned>(log.getLastJob()), static_cast<unsigned>(sizeof(JobRecord)),
+        static_cast<unsigned>(log.getCapacity()));
+}
+
+// listJobs=<fromJob>: one line per job, job,start,end,area,kg; a page ends with "listJobs=end" or the next job to ask for
+void CommandHandler::handlerListJobs(const ParsedInstruction& instr) {
+    static constexpr size_t LIST_PAGE_SIZE = 8;
+    const JobLog& log = context->getJobLog();
+
+    uint32_t fromJob = (instr.postParamType == ParamType::INT && instr.postParam.i > 0) ? instr.postParam.i : 0;
+    size_t position = log.lowerBound(fromJob);
+    size_t sent = 0;
+    JobRecord record;
+
+    for (; position < log.getCount() && sent < LIST_PAGE_SIZE; ++position) {
+        if (!log.readJob(log.getEntry(position).jobNumber, record)) {
+            continue;
+        }
+        float area = 0.0f;
+        float consumption = 0.0f;
+        for (size_t i = 0; i < DISPENSER_CHANNEL_COUNT; ++i) {
+            area += record.channels[i].areaM2;
+            consumption += record.channels[i].consumptionKg;
+        }
+        context->getBLETextServer().notifyFormatted("%s=%u,%u,%u,%.1f,%.2f", CMD_LIST_JOBS,
+            static_cast<unsigned>(record.jobNumber), static_cast<unsigned>(record.startTime),
+            static_cast<unsigned>(record.endTime), area, consumption);
+        ++sent;
+    }
+
+    if (position < log.getCount()) {
+        context->getBLETextServer().notifyFormatted("%s=next,%u", CMD_LIST_JOBS, static_cast<unsigned>(log.getEntry(position).jobNumber));
+    } else {
+        context->getBLETextServer().notifyFormatted("%s=end", CMD_LIST_JOBS);
+    }
+}
+
+// findJobs=<unixTime>: first job started at or after that time, 0 if none; page through with listJobs
+void CommandHandler::handlerFindJobs(const ParsedInstruction& instr) {
+    if (instr.postParamType != ParamType::INT || instr.postParam.i < 0) {
+        LogUtils::warn("[CMD] %s: expected UTC seconds\n", instr.command);
+        return;
+    }
+    uint32_t job = context->getJobLog().findFirstJobAtOrAfter(static_cast<uint32_t>(instr.postParam.i));
+    context->getBLETextServer().notifyValue(CMD_FIND_JOBS, static_cast<int>(job));
+}
+
+// getJobRecord=<job>: binary ['J', version, size lo, size hi, job (LE32)] followed by the raw JobRecord
+void CommandHandler::handlerGetJobRecord(const ParsedInstruction& instr) {
+    static constexpr uint8_t RECORD_MAGIC = 'J';
+    static constexpr size_t RECORD_HEADER_SIZE = 8;
+    static_assert(RECORD_HEADER_SIZE + sizeof(JobRecord) <= MAX_BLE_PACKET_SIZE, "JobRecord must fit one notification");
+    static uint8_t packet[RECORD_HEADER_SIZE + sizeof(JobRecord)];
+
+    JobRecord record;
+    if (instr.postParamType != ParamType::INT || instr.postParam.i <= 0 ||
+        !context->getJobLog().readJob(static_cast<uint32_t>(instr.postParam.i), record)) {
+        LogUtils::warn("[CMD] %s: job not in history\n", instr.command);
+        context->getBLETextServer().notifyValue(CMD_GET_JOB_RECORD, 0);
+        return;
+    }
+
+    packet[0] = RECORD_MAGIC;
+    packet[1] = 1;
+    packet[2] = sizeof(JobRecord) & 0xFF;
+    packet[3] = (sizeof(JobRecord) >> 8) & 0xFF;
+    memcpy(packet + 4, &record.jobNumber, sizeof(uint32_t));
+    memcpy(packet + RECORD_HEADER_SIZE, &record, sizeof(JobRecord));
+    context->getBLETextServer().notifyBinary(packet, sizeof(packet));
+}
+
+// setTsDecimation=<n>: record every nth control tick
+void CommandHandler::handlerSetTsDecimation(const ParsedInstruction& instr) {
+    if (instr.postParamType != ParamType::INT || instr.postParam.i < 1 || instr.postParam.i > TimeSeriesLog::MAX_DECIMATION) {
+        LogUtils::warn("[CMD] %s: expected 1..%u\n", instr.command, static_cast<unsigned>(TimeSeriesLog::MAX_DECIMATION));
+        return;
+    }
+    TimeSeriesLog& log = context->getTimeSeriesLog();
+    log.setDecimation(static_cast<uint8_t>(instr.postParam.i));
+    SystemPreferences::save(PrefKey::KEY_TS_DECIMATION, static_cast<int>(log.getDecimation()));
+    context->getBLETextServer().notifyValue(CMD_SET_TS_DECIMATION, static_cast<int>(log.getDecimation()));
+}
+
+// setTsRetention=<minutes>: 0 keeps as much as the partition holds
+void CommandHandler::handlerSetTsRetention(const ParsedInstruction& instr) {
+    if (instr.postParamType != ParamType::INT || instr.postParam.i < 0 || instr.postParam.i > UINT16_MAX) {
+        LogUtils::warn("[CMD] %s: expected minutes\n", instr.command);
+        return;
+    }
+    TimeSeriesLog& log = context->getTimeSeriesLog();
+    log.setRetentionMinutes(static_cast<uint16_t>(instr.postParam.i));
+    SystemPreferences::save(PrefKey::KEY_TS_RETENTION, static_cast<int>(log.getRetentionMinutes()));
+    context->getBLETextServer().notifyValue(CMD_SET_TS_RETENTION, static_cast<int>(log.getRetentionMinutes()));
+}
+
+// Reply: decimation,retentionMin,ringSectors,ringBlocks,nextBlock,bytesPerSample,dropped
+void CommandHandler::handlerGetTsInfo(const ParsedInstruction& instr) {
+    const TimeSeriesLog& log = context->getTimeSeriesLog();
+    context->getBLETextServer().notifyFormatted("%s=%u,%u,%u,%u,%u,%.1f,%u", CMD_GET_TS_INFO,
+        static_cast<unsigned>(log.getDecimation()), static_cast<unsigned>(log.getRetentionMinutes()),
+        static_cast<unsigned>(log.getRingSectors()), static_cast<unsigned>(log.getRingBlocks()),
+        static_cast<unsigned>(log.getSequence()), log.getBytesPerSample(),
+        static_cast<unsigned>(log.getDroppedSamples()));
+}
+
+// getTsBlock=0 restarts at the oldest block, getTsBlock=1 continues; each reply is one raw block, "getTsBlock=end" after the last
+void CommandHandler::handlerGetTsBlock(const ParsedInstruction& instr) {
+    static_assert(TimeSeriesLog::MAX_BLOCK_BYTES <= MAX_BLE_PACKET_SIZE, "time series block must fit one notification");
+    static uint8_t block[TimeSeriesLog::MAX_BLOCK_BYTES];
+
+    TimeSeriesLog& log = context->getTimeSeriesLog();
+    if (instr.postParamType == ParamType::INT && instr.postParam.i == 0) {
+        log.rewindReader();
+    }
+
+    size_t length = log.readNextBlock(block, sizeof(block));
+    if (length == 0) {
+        context->getBLETextServer().notifyFormatted("%s=end", CMD_GET_TS_BLOCK);
+        return;
+    }
+    context->getBLETextServer().notifyBlock(CMD_GET_TS_BLOCK, block, length);
+}
+
+void CommandHandler::handlerSetOverlapShutoff(const ParsedInstruction& instr) {
+    CoverageMap& map = context->getCoverageMap();
+    if (instr.postParamType == ParamType::INT) {
+        map.setShutoffEnabled(instr.postParam.i != 0);
+        SystemPreferences::save(PrefKey::KEY_OVERLAP_SHUTOFF, map.isShutoffEnabled() ? 1 : 0);
+    }
+    context->getBLETextServer().notifyValue(CMD_SET_OVERLAP_SHUTOFF, map.isShutoffEnabled() ? 1 : 0);
+}
+
+// Reply: enabled,tilesUsed,poolTiles,evictions,coveredHa,closedMask (bit i = section i shut over covered ground)
+void CommandHandler::handlerGetCoverageInfo(const ParsedInstruction& instr) {
+    const CoverageMap& map = context->getCoverageMap();
+    unsigned closedMask = 0;
+    for (size_t i = 0; i < context->getChannelCount(); ++i) {
+        if (context->getChannel(i).isOverlapClosed()) {
+            closedMask |= 1u << i;
+        }
+    }
+
+    context->getBLETextServer().notifyFormatted("%s=%d,%u,%u,%u,%.2f,%u", CMD_GET_COVERAGE_INFO,
+        map.isShutoffEnabled() ? 1 : 0, static_cast<unsigned>(map.getTilesUsed()),
+        static_cast<unsigned>(CoverageMap::POOL_TILES), static_cast<unsigned>(map.getEvictions()),
+        map.getCoveredAreaM2() / Units::SQUARE_METERS_PER_HECTARE, closedMask);
+}
+
+void CommandHandler::handlerResetCoverage(const ParsedInstruction& instr) {
+    context->getCoverageMap().requestReset();
+    context->getBLETextServer().notifyValue(CMD_RESET_COVERAGE, 1);
+}
+
+// Reply: ringBlocks,nextBlock,points,bytesPerPoint,dropped
+void CommandHandler::handlerGetAsAppliedInfo(const ParsedInstruction& instr) {
+    const AsAppliedLog& log = context->getAsAppliedLog();
+    context->getBLETextServer().notifyFormatted("%s=%u,%u,%u,%.1f,%u", CMD_GET_AS_APPLIED_INFO,
+        static_cast<unsigned>(log.getRingBlocks()), static_cast<unsigned>(log.getSequence()),
+        static_cast<unsigned>(log.getPointCount()), log.getBytesPerPoint(),
+        static_cast<unsigned>(log.getDroppedPoints()));
+}
+
+// getAsAppliedBlock=0 restarts at the oldest block, =1 continues; one block per reply, "getAsAppliedBlock=end" after the last.
+// Decode with tools/asapplied_decode.py.
+void CommandHandler::handlerGetAsAppliedBlock(const ParsedInstruction& instr) {
+    static_assert(FlashBlockRing::MAX_BLOCK_BYTES <= MAX_BLE_PACKET_SIZE, "as-applied block must fit one notification");
+    static uint8_t block[FlashBlockRing::MAX_BLOCK_BYTES];
+
+    AsAppliedLog& log = context->getAsAppliedLog();
+    if (instr.postParamType == ParamType::INT && instr.postParam.i == 0) {
+        log.rewindReader();
+    }
+
+    size_t length = log.readNextBlock(block, sizeof(block));
+    if (length == 0) {
+        context->getBLETextServer().notifyFormatted("%s=end", CMD_GET_AS_APPLIED_BLOCK);
+        return;
+    }
+    context->getBLETextServer().notifyBlock(CMD_GET_AS_APPLIED_BLOCK, block, length);
+}
+
+// Reply: bytes,sentences,checksumFailures,overflows,frameErrors
+void CommandHandler::handlerGetGpsStats(const ParsedInstruction& instr) {
+    GPSStats stats = context->getGPSReceiver().getStats();
+    context->getBLETextServer().notifyFormatted("%s=%u,%u,%u,%u,%u", CMD_GET_GPS_STATS,
+        static_cast<unsigned>(stats.bytes), static_cast<unsigned>(stats.sentences),
+        static_cast<unsigned>(stats.checksumFailures), static_cast<unsigned>(stats.overflows),
+        static_cast<unsigned>(stats.frameErrors));
+}
+
+// setGpsBackend=0 TinyGPSPlus, =1 in-place NMEA parser; without a value replies the active one
+void CommandHandler::handlerSetGpsBackend(const ParsedInstruction& instr) {
+    GPSProvider& gps = context->getGPSProvider();
+    if (instr.postParamType == ParamType::INT && (instr.postParam.i == 0 || instr.postParam.i == 1)) {
+        gps.setParserBackend(static_cast<GPSParserBackend>(instr.postParam.i));
+        SystemPreferences::save(PrefKey::KEY_GPS_BACKEND, static_cast<int>(gps.getParserBackend()));
+    }
+    context->getBLETextServer().notifyValue(CMD_SET_GPS_BACKEND, static_cast<int>(gps.getParserBackend()));
+}
@@ -27,6 +27,7 @@ public:
 
     void registerHandlers();
     static void sendBLEPacketChecked(const String& packet);
+    static void notifyTaskStateRejected(size_t channel, const TaskStateController& controller);
 
     // Handlers
     static void handlerSetLogLevel(const ParsedInstruction& instr);
@@ -42,7 +43,18 @@ public:
 
     static void handlerSetTargetFlowRatePerDaa(const ParsedInstruction& instr);
     static void handlerSetTargetFlowRatePerMin(const ParsedInstruction& instr);
+    static void handlerSetFlowMode(const ParsedInstruction& instr);
+    static void handlerSetControlAlgorithm(const ParsedInstruction& instr);
+    static void handlerSetFlowCoeff(const ParsedInstruction& instr);
+    static void handlerSetBoomWidth(const ParsedInstruction& instr);
+    static void handlerSetRampProfile(const ParsedInstruction& instr);
+    static void handlerSetRampRate(const ParsedInstruction& instr);
+    static void handlerSetRampAccel(const ParsedInstruction& instr);
+    static void handlerSetActuatorLatency(const ParsedInstruction& instr);
+    static void handlerSetLatencyLearning(const ParsedInstruction& instr);
+    static void handlerSetLateralOffset(const ParsedInstruction& instr);
     static void handlerSetTankLevel(const ParsedInstruction& instr);
+    static void handlerSetTankWarning(const ParsedInstruction& instr);
     static void handlerSetMeasuredWeight(const ParsedInstruction& instr);
 
     static void handlerSetSpeedSource(const ParsedInstruction& instr);
@@ -54,12 +66,52 @@ public:
     static void handlerGetErrorInfo(const ParsedInstruction& instr);
     static void handlerSetPIDKp(const ParsedInstruction& instr);
     static void handlerSetPIDKi(const ParsedInstruction& instr);
+    static void handlerSetPIDKd(const ParsedInstruction& instr);
 
     static void handlerReportPIParams(const ParsedInstruction& instr);
     static void handlerReportUserParams(const ParsedInstruction& instr);
 
+    static void handlerArmCapture(const ParsedInstruction& instr);
+    static void handlerTriggerCapture(const ParsedInstruction& instr);
+    static void handlerGetCaptureInfo(const ParsedInstruction& instr);
+    static void handlerGetCaptureChunk(const ParsedInstruction& instr);
+
+    static void handlerSetLatencyProfiling(const ParsedInstruction& instr);
+    static void handlerGetLatencyInfo(const ParsedInstruction& instr);
+    static void handlerResetLatencyInfo(const ParsedInstruction& instr);
+
+    static void handlerSetShadowMode(const ParsedInstruction& instr);
+    static void handlerSetShadowGain(const ParsedInstruction& instr);
+    static void handlerGetShadowInfo(const ParsedInstruction& instr);
+    static void handlerPromoteShadow(const ParsedInstruction& instr);
+
+    static void handlerGetJobSession(const ParsedInstruction& instr);
+    static void handlerResumeJob(const ParsedInstruction& instr);
+
+    static void handlerGetJobLogInfo(const ParsedInstruction& instr);
+    static void handlerListJobs(const ParsedInstruction& instr);
+    static void handlerFindJobs(const ParsedInstruction& instr);
+    static void handlerGetJobRecord(const ParsedInstruction& instr);
+
+    static void handlerSetTsDecimation(const ParsedInstruction& instr);
+    static void handlerSetTsRetention(const ParsedInstruction& instr);
+    static void handlerGetTsInfo(const ParsedInstruction& instr);
+    static void handlerGetTsBlock(const ParsedInstruction& instr);
+
+    static void handlerSetOverlapShutoff(const ParsedInstruction& instr);
+    static void handlerGetCoverageInfo(const ParsedInstruction& instr);
+    static void handlerResetCoverage(const ParsedInstruction& instr);
+
+    static void handlerGetAsAppliedInfo(const ParsedInstruction& instr);
+    static void handlerGetAsAppliedBlock(const ParsedInstruction& instr);
+
+    static void handlerGetGpsStats(const ParsedInstruction& instr);
+    static void handlerSetGpsBackend(const ParsedInstruction& instr);
+
 private:
     CommandHandler() = default;
 
+    static bool resolveChannelRange(const ParsedInstruction& instr, size_t& first, size_t& last);
+
     static SystemContext* context;
 };
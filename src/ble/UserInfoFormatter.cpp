@@ -13,6 +13,11 @@
 
 uint32_t UserInfoFormatter::packetCounter = 0;
 
+// Channels 0 and 1 keep the historical "lft"/"rgt" prefixes expected by the app
+const char* const UserInfoFormatter::TaskChannelInfoData::PREFIXES[MAX_DISPENSER_CHANNELS] = {
+    "lft", "rgt", "s3", "s4", "s5", "s6", "s7", "s8"
+};
+
 // --- Static helpers ---
 
 String UserInfoFormatter::formatFloat(float value) {
@@ -61,16 +66,19 @@ String UserInfoFormatter::makeVersionInfoPacket() {
            makePktIdField();
 }
 
-String UserInfoFormatter::makeTaskInfoPacket(const TaskChannelInfoData& left, const TaskChannelInfoData& right) {
-    String leftPart = makeChannelData(TaskChannelInfoData::PREFIX_LEFT,
-        left.flowDaaSet, left.flowMinSet, left.flowDaaReal, left.flowMinReal,
-        left.tankLevel, left.areaDone, left.duration, left.consumed);
+String UserInfoFormatter::makeTaskChannelPart(uint8_t channel, const TaskChannelInfoData& data) {
+    return makeChannelData(TaskChannelInfoData::PREFIXES[channel],
+        data.flowDaaSet, data.flowMinSet, data.flowDaaReal, data.flowMinReal,
+        data.tankLevel, data.areaDone, data.duration, data.consumed, data.flowMode);
+}
 
-    String rightPart = makeChannelData(TaskChannelInfoData::PREFIX_RIGHT,
-        right.flowDaaSet, right.flowMinSet, right.flowDaaReal, right.flowMinReal,
-        right.tankLevel, right.areaDone, right.duration, right.consumed);
+String UserInfoFormatter::makeTankPart(const TankInfoData& data) {
+    return makeChannelData(TankInfoData::PREFIX,
+        data.levelKg, data.kgPerMin, data.minutesToEmpty, data.hectaresToEmpty, data.lowWarning);
+}
 
-    String packet = String(PACKET_VERSION) + leftPart + rightPart + makePktIdField();
+String UserInfoFormatter::makeTaskInfoPacket(const String& channelParts) {
+    String packet = String(PACKET_VERSION) + channelParts + makePktIdField();
     return packet;
 }
 
@@ -91,7 +99,7 @@ String UserInfoFormatter::makeGPSInfoPacket(const GPSInfoData& data) {
 
 String UserInfoFormatter::makePIPacket(const PIInfoData& data) {
     String packet = String(PACKET_VERSION) + makeChannelData(PIInfoData::PREFIX,
-        data.piKp, data.piKi) + makePktIdField();
+        data.piKp, data.piKi, data.piKd) + makePktIdField();
 
     return packet;
 }
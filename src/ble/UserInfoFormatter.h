@@ -45,11 +45,11 @@ public:
 
         float piKp;
         float piKi;
+        float piKd;
     };
 
     struct TaskChannelInfoData {
-        static constexpr const char* PREFIX_LEFT = "lft";
-        static constexpr const char* PREFIX_RIGHT = "rgt";
+        static const char* const PREFIXES[MAX_DISPENSER_CHANNELS];
 
         float flowDaaSet;
         float flowMinSet;
@@ -59,11 +59,24 @@ public:
         float areaDone;
         int duration;
         float consumed;
+        int flowMode;       // FlowControlMode, appended to keep older field indices
+    };
+
+    struct TankInfoData {
+        static constexpr const char* PREFIX = "tnk";
+
+        float levelKg;
+        float kgPerMin;
+        float minutesToEmpty;   // -1 while unknown
+        float hectaresToEmpty;  // -1 while unknown
+        int lowWarning;
     };
 
     // Public API
     static String makeVersionInfoPacket();
-    static String makeTaskInfoPacket(const TaskChannelInfoData& left, const TaskChannelInfoData& right);
+    static String makeTaskChannelPart(uint8_t channel, const TaskChannelInfoData& data);
+    static String makeTaskInfoPacket(const String& channelParts);
+    static String makeTankPart(const TankInfoData& data);
     static String makeDeviceInfoPacket(const DeviceInfoData& data);
     static String makeGPSInfoPacket(const GPSInfoData& data);
     static String makePIPacket(const PIInfoData& data);
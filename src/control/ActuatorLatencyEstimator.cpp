@@ -0,0 +1,55 @@
+// ============================================
+// File: ActuatorLatencyEstimator.cpp
+// Purpose: Learns how long the gate takes to follow a target change
+// Part of: Control Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include "ActuatorLatencyEstimator.h"
+#include <math.h>
+
+/*
+  A measurement starts when the target moves away from the last reference by
+  more than STEP_THRESHOLD. The level the target had at that moment is then
+  tracked until the gate gets within SETTLE_BAND of it; the elapsed time is
+  the lag of the gate behind the target, averaged over many steps.
+  A gate that is already within the band (a slow ramp it keeps up with), or a
+  target that turns back before the gate arrives, gives no sample: timing
+  either would say how the target moved, not how long the gate takes.
+*/
+void ActuatorLatencyEstimator::observe(float target, float measured, float dt) {
+    if (!tracking) {
+        float step = target - referenceTarget;
+        if (fabsf(step) >= STEP_THRESHOLD) {
+            referenceTarget = target;
+            if (fabsf(target - measured) > SETTLE_BAND) {
+                trackedLevel = target;
+                direction = (step > 0.0f) ? 1.0f : -1.0f;
+                elapsedSec = 0.0f;
+                tracking = true;
+            }
+        }
+        return;
+    }
+
+    elapsedSec += dt;
+
+    if (fabsf(trackedLevel - measured) <= SETTLE_BAND) {
+        estimateSec = (sampleCount == 0) ? elapsedSec : estimateSec + FILTER_ALPHA * (elapsedSec - estimateSec);
+        if (sampleCount < UINT16_MAX) sampleCount++;
+        tracking = false;
+        referenceTarget = target;
+    } else if (elapsedSec >= TIMEOUT_SEC || (target - trackedLevel) * direction < -SETTLE_BAND) {
+        tracking = false; // stalled or saturated gate, or the target turned back: not a latency sample
+        referenceTarget = target;
+    }
+}
+
+void ActuatorLatencyEstimator::reset() {
+    tracking = false;
+    elapsedSec = 0.0f;
+    estimateSec = 0.0f;
+    sampleCount = 0;
+}
@@ -0,0 +1,47 @@
+// ============================================
+// File: ActuatorLatencyEstimator.h
+// Purpose: Learns how long the gate takes to follow a target change
+// Part of: Control Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+
+class DispenserChannel; // Forward declaration
+
+class ActuatorLatencyEstimator {
+    friend class DispenserChannel; // Allow DispenserChannel to access private members
+public:
+    static constexpr float STEP_THRESHOLD = 3.0f;  // % change that starts a measurement
+    static constexpr float SETTLE_BAND = 1.0f;     // % distance counted as "arrived"
+    static constexpr float TIMEOUT_SEC = 10.0f;    // give up on measurements longer than this
+    static constexpr float FILTER_ALPHA = 0.2f;
+
+    ActuatorLatencyEstimator(const ActuatorLatencyEstimator&) = delete;
+    ActuatorLatencyEstimator& operator=(const ActuatorLatencyEstimator&) = delete;
+    ActuatorLatencyEstimator(ActuatorLatencyEstimator&&) = delete;
+    ActuatorLatencyEstimator& operator=(ActuatorLatencyEstimator&&) = delete;
+
+    void observe(float target, float measured, float dt);
+    void reset();
+
+    bool hasEstimate() const { return sampleCount > 0; }
+    float getEstimate() const { return estimateSec; }
+    uint16_t getSampleCount() const { return sampleCount; }
+
+private:
+    ActuatorLatencyEstimator() = default;
+
+    float referenceTarget = 0.0f;  // target the last measurement was started from
+    float trackedLevel = 0.0f;     // level the gate has to reach
+    float direction = 1.0f;        // sign of the step being measured
+    float elapsedSec = 0.0f;
+    bool tracking = false;
+
+    float estimateSec = 0.0f;
+    uint16_t sampleCount = 0;
+};
@@ -1,59 +1,127 @@
 #pragma once
 
+#include <stdint.h>
 #include "core/Constants.h"
+#include "core/SeqLock.h"
 
+// What readers outside the control task see; published after every integration step.
+// Plain aggregate so it can live in checkpoints; MetricsSnapshot() is all zeros.
+struct MetricsSnapshot {
+    uint64_t durationMs;
+    double distanceM;
+    double areaM2;
+    double consumptionKg;
+};
+
+/*
+  Integrated by the control task every tick with the trapezoidal rule over
+  the measured tick interval. Accumulators are double so a day-long job
+  still resolves a single 100 ms slice; the 1 Hz path only reads the
+  published snapshot. reset() runs from the Started entry hook, which also
+  executes in the control task.
+*/
 class ApplicationMetrics {
 private:
-    int duration = 0;
-    int distance = 0;
-    float area = 0.0f;
-    float consumption = 0.0f;
+    MetricsSnapshot totals = MetricsSnapshot();  // control task only
+    SeqLock<MetricsSnapshot> snapshot;
+
+    // Previous sample for the trapezoid; invalid after a reset or an idle tick
+    float prevSpeedMps = 0.0f;
+    float prevAreaPerSec = 0.0f;
+    float prevKgPerSec = 0.0f;
+    bool hasPrev = false;
 
-    static float tankLevel;  // Shared among all instances
+    static double tankLevelKg;     // integrated, shared among all instances
+    static volatile float tankLevel;  // published copy, a single 32-bit store
+    static float initialTankLevel;  // Persisted fill level, cached so task start needs no NVS read
+    static volatile float requestedTankLevel; // set by hand from another task, see requestTankLevel()
+    static volatile bool tankLevelRequested;
 
 public:
-    // Increments
-    void incrementDuration() { duration++; }
-    void increaseDistance(int length) { distance += length; }
-    void increaseArea(float value) { area += value; }
-    void increaseConsumption(float value) { consumption += value; }
-
-    // Clears
-    void clearDuration() { duration = 0; }
-    void clearDistance() { distance = 0; }
-    void clearArea() { area = 0.0f; }
-    void clearConsumption() { consumption = 0.0f; }
-
-    // Accessors
-    int getDuration() const { return duration; }
-    int getDistance() const { return distance; }
-    float getArea() const { return area; }
-    float getConsumption() const { return consumption; }
+    // Control task: one integration step; rates are zero when the channel is not dispensing
+    void integrate(float speedMps, float areaPerSec, float kgPerMin, bool working, float dt) {
+        if (!working) {
+            speedMps = areaPerSec = kgPerMin = 0.0f;
+        }
+        float kgPerSec = kgPerMin / Units::MINUTE_TO_SECOND;
+
+        if (hasPrev) {
+            totals.distanceM += 0.5 * (prevSpeedMps + speedMps) * dt;
+            totals.areaM2 += 0.5 * (prevAreaPerSec + areaPerSec) * dt;
+            double slice = 0.5 * (prevKgPerSec + kgPerSec) * dt;
+            totals.consumptionKg += slice;
+            decreaseTankLevel(slice);
+        }
+        if (working) {
+            totals.durationMs += static_cast<uint64_t>(dt * 1000.0f + 0.5f);
+        }
+
+        prevSpeedMps = speedMps;
+        prevAreaPerSec = areaPerSec;
+        prevKgPerSec = kgPerSec;
+        hasPrev = working;
+        snapshot.write(totals);
+    }
+
+    // Control task: live totals, and putting back a checkpointed job
+    const MetricsSnapshot& getTotals() const { return totals; }
+    void restore(const MetricsSnapshot& saved) {
+        totals = saved;
+        hasPrev = false;
+        snapshot.write(totals);
+    }
+
+    // Snapshot access, safe from any task
+    MetricsSnapshot getSnapshot() const { return snapshot.read(); }
+    int getDuration() const { return static_cast<int>(snapshot.read().durationMs / 1000); }
+    int getDistance() const { return static_cast<int>(snapshot.read().distanceM); }
+    float getArea() const { return static_cast<float>(snapshot.read().areaM2); }
+    float getConsumption() const { return static_cast<float>(snapshot.read().consumptionKg); }
 
     inline static float getTankLevel() { return tankLevel; }
-    inline static void setTankLevel(float level) { tankLevel = level; }
-    inline static void decreaseTankLevel(float value) { tankLevel -= value; }
+    inline static void setTankLevel(float level) { tankLevelKg = level; tankLevel = level; }
+    inline static void decreaseTankLevel(double value) { tankLevelKg -= value; tankLevel = static_cast<float>(tankLevelKg); }
+    inline static double getTankLevelKg() { return tankLevelKg; }  // control task
+    inline static void restoreTankLevel(double level) { tankLevelKg = level; tankLevel = static_cast<float>(level); }
+    inline static float getInitialTankLevel() { return initialTankLevel; }
+    inline static void setInitialTankLevel(float level) { initialTankLevel = level; }
+
+    // Any task: refill or correction by hand. The level is a double the control task
+    // decrements every tick, so it is only written there, at the start of the next tick.
+    inline static void requestTankLevel(float level) {
+        requestedTankLevel = level;
+        __sync_synchronize();
+        tankLevelRequested = true;
+    }
 
-    void applyFlowSlice(float flowRatePerMin) {
-        float slice = flowRatePerMin / Units::MINUTE_TO_SECOND; // Convert to per-second rate
-        increaseConsumption(slice);
-        decreaseTankLevel(slice);
+    // Control task: true when a requested level was applied (also the new initial level)
+    inline static bool applyTankLevelRequest() {
+        if (!tankLevelRequested) {
+            return false;
+        }
+        tankLevelRequested = false;
+        __sync_synchronize();
+        float level = requestedTankLevel; // a request racing this one is applied again next tick
+        setTankLevel(level);
+        setInitialTankLevel(level);
+        return true;
     }
 
-    // Reset all
+    // Reset all (control task)
     void reset() {
-        duration = 0;
-        distance = 0;
-        area = 0.0f;
-        consumption = 0.0f;
+        totals = MetricsSnapshot();
+        hasPrev = false;
+        snapshot.write(totals);
     }
 
-    // Merge another instance into this one
+    // Merge another instance's published totals into this one
     ApplicationMetrics& operator+=(const ApplicationMetrics& other) {
-        duration += other.duration;
-        distance += other.distance;
-        area += other.area;
-        consumption += other.consumption;
+        MetricsSnapshot theirs = other.getSnapshot();
+        totals.durationMs += theirs.durationMs;
+        totals.distanceM += theirs.distanceM;
+        totals.areaM2 += theirs.areaM2;
+        totals.consumptionKg += theirs.consumptionKg;
+        snapshot.write(totals);
         return *this;
     }
 };
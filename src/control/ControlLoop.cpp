@@ -0,0 +1,200 @@
+// ============================================
+// File: ControlLoop.cpp
+// Purpose: Runs one control cycle over all dispenser channels
+// Part of: Control Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include "ControlLoop.h"
+#include "core/SystemContext.h"
+#include "core/LatencyProfiler.h"
+#include "core/JobSession.h"
+#include <esp_timer.h>
+#include <math.h>
+
+SensorFrame ControlLoop::sensors;
+float ControlLoop::target[DISPENSER_CHANNEL_COUNT];
+bool ControlLoop::jobOpen = false;
+
+void ControlLoop::tick(SystemContext& context) {
+    const size_t count = context.getChannelCount();
+
+    // Pass 0: apply task state changes and tank refills queued since the last tick
+    for (size_t i = 0; i < count; ++i) {
+        context.getChannel(i).getTaskController().processEvents();
+    }
+    JobSession::processResume(context);
+    if (ApplicationMetrics::applyTankLevelRequest()) {
+        context.getTankEstimator().requestRestart(); // the jump is a refill, not consumption
+    }
+
+    // Refresh GPS motion estimate used by look-ahead targets
+    context.getGPSProvider().update();
+
+    // Pass 1: freeze every sensor input for this tick and share it with the 1 Hz path
+    context.captureSensorFrame(sensors);
+    context.publishSensorFrame(sensors);
+
+    if (LatencyProfiler::isEnabled()) {
+        int64_t age = esp_timer_get_time() - sensors.adcSampleUs;
+        LatencyProfiler::recordSampleAge(age > 0 ? static_cast<uint32_t>(age) : 0);
+    }
+    LatencyProfiler::markSampled();
+
+    // Pass 1b: coverage look-ahead, closing sections over ground already dispensed on
+    updateCoverage(context);
+
+    // Pass 2: resolve targets (task state, test sweep, rate model, ramp shaping)
+    for (size_t i = 0; i < count; ++i) {
+        target[i] = context.getChannel(i).computeControlTarget(sensors);
+    }
+
+    // Pass 3: PI update
+    for (size_t i = 0; i < count; ++i) {
+        context.getChannel(i).computePIControl(target[i], sensors.positionPercent[i]);
+    }
+    LatencyProfiler::markComputed();
+
+    // Pass 4: actuation, back to back so all sections see the same sample age
+    for (size_t i = 0; i < count; ++i) {
+        context.getChannel(i).applyControlSignal();
+    }
+    LatencyProfiler::markActuated();
+
+    // Pass 5: actual flow estimate from the sampled positions, then metrics integration
+    for (size_t i = 0; i < count; ++i) {
+        context.getChannel(i).updateFlowEstimate(sensors);
+        context.getChannel(i).integrateMetrics(sensors);
+    }
+
+    // Pass 6: step-response capture for the armed channel, if any
+    recordCapture(context);
+
+    // Pass 7: RTC checkpoint of the job totals just integrated
+    JobSession::checkpoint(context);
+
+    // Pass 8: stage this tick for the flash time series (decimated, only while a job is open)
+    recordTimeSeries(context);
+
+    // Pass 9: stage an as-applied map point (once a second while dispensing, and on section edges)
+    recordAsApplied(context);
+}
+
+static inline int16_t toHundredths(float value) {
+    float scaled = value * 100.0f;
+    if (scaled > 32767.0f) return 32767;
+    if (scaled < -32768.0f) return -32768;
+    return static_cast<int16_t>(scaled);
+}
+
+void ControlLoop::recordCapture(SystemContext& context) {
+    StepResponseCapture& capture = context.getStepCapture();
+    capture.applyRequest();
+    if (!capture.isRecording() || capture.getChannel() >= context.getChannelCount()) {
+        return;
+    }
+
+    const size_t i = capture.getChannel();
+    DispenserChannel& channel = context.getChannel(i);
+    const PIController& pi = channel.getPIController();
+    float current = sensors.motorCurrent[i] * 1000.0f;
+
+    CaptureSample sample;
+    sample.target = toHundredths(target[i]);
+    sample.measured = toHundredths(sensors.positionPercent[i]);
+    sample.error = toHundredths(channel.getControlError());
+    sample.integral = toHundredths(channel.getControlAlgorithm() == GateControlAlgorithm::PILoop ? pi.getIntegral() : 0.0f);
+    sample.control = static_cast<int8_t>(channel.getControlSignal());
+    sample.taskState = static_cast<uint8_t>(channel.getTaskController().getTaskState());
+    sample.current = current > 0.0f ? (current < 65535.0f ? static_cast<uint16_t>(current) : 65535) : 0;
+
+    capture.record(sample, channel.getRawTargetPosition(), sample.taskState);
+}
+
+void ControlLoop::recordTimeSeries(SystemContext& context) {
+    bool recording = false;
+    for (size_t i = 0; i < context.getChannelCount(); ++i) {
+        recording |= !context.getChannel(i).getTaskController().isTaskStopped();
+    }
+
+    TimeSeriesLog& log = context.getTimeSeriesLog();
+    if (!log.isSampleDue(recording)) {
+        return;
+    }
+
+    TimeSeriesSample sample;
+    sample.speed = toHundredths(sensors.speedMps);
+    for (size_t i = 0; i < context.getChannelCount(); ++i) {
+        const DispenserChannel& channel = context.getChannel(i);
+        sample.position[i] = toHundredths(sensors.positionPercent[i]);
+        sample.target[i] = toHundredths(target[i]);
+        sample.rate[i] = toHundredths(channel.getFlowEstimator().getKgPerMin());
+        sample.errorFlags[i] = static_cast<uint16_t>(channel.getTaskController().getErrorManager().getErrorFlags());
+    }
+    log.push(sample);
+}
+
+void ControlLoop::updateCoverage(SystemContext& context) {
+    CoverageMap& map = context.getCoverageMap();
+    const size_t count = context.getChannelCount();
+
+    // A job started from all-stopped is a fresh pass over the field
+    bool open = false;
+    for (size_t i = 0; i < count; ++i) {
+        open |= !context.getChannel(i).getTaskController().isTaskStopped();
+    }
+    if (open && !jobOpen) {
+        map.reset();
+    }
+    jobOpen = open;
+
+    // Without a fix the sections fall back to dispensing; standing still holds their state
+    if (!map.updatePose(sensors.gpsValid, sensors.location, sensors.courseDeg)) {
+        for (size_t i = 0; i < count; ++i) {
+            context.getChannel(i).updateOverlapShutoff(0.0f, false);
+        }
+        return;
+    }
+    if (sensors.getSpeedKmph() < sensors.params.minWorkingSpeed) {
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        DispenserChannel& channel = context.getChannel(i);
+        float width = channel.getBoomWidth();
+        float offset = channel.getLateralOffset();
+
+        float ahead = sensors.speedMps * channel.getLookAheadSec();
+        channel.updateOverlapShutoff(map.queryCovered(offset, width, ahead), map.isShutoffEnabled());
+
+        if (channel.getTaskController().isTaskActive() && channel.getFlowEstimator().getKgPerMin() > 0.0f) {
+            map.markSection(offset, width);
+        }
+    }
+}
+
+void ControlLoop::recordAsApplied(SystemContext& context) {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < context.getChannelCount(); ++i) {
+        const DispenserChannel& channel = context.getChannel(i);
+        if (channel.getTaskController().isTaskActive() && channel.getFlowEstimator().getKgPerMin() > 0.0f) {
+            mask |= 1UL << i;
+        }
+    }
+
+    AsAppliedLog& log = context.getAsAppliedLog();
+    if (!log.isPointDue(sensors.gpsValid, mask)) {
+        return;
+    }
+
+    AsAppliedPoint point;
+    point.lat = static_cast<int32_t>(lround(sensors.location.lat * 1e7));
+    point.lng = static_cast<int32_t>(lround(sensors.location.lng * 1e7));
+    for (size_t i = 0; i < context.getChannelCount(); ++i) {
+        float rate = (mask & (1UL << i)) ? context.getChannel(i).getRealFlowRatePerDaa() * 100.0f : 0.0f;
+        point.rate[i] = rate > 0.0f ? (rate < 65535.0f ? static_cast<uint16_t>(rate + 0.5f) : 65535) : 0;
+    }
+    log.push(point);
+}
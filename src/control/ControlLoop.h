@@ -0,0 +1,34 @@
+// ============================================
+// File: ControlLoop.h
+// Purpose: Runs one control cycle over all dispenser channels
+// Part of: Control Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stddef.h>
+#include "io/IOConfig.h"
+#include "core/SensorFrame.h"
+
+class SystemContext; // Forward declaration
+
+class ControlLoop {
+public:
+    static void tick(SystemContext& context);
+
+private:
+    ControlLoop() = default;
+
+    static void recordCapture(SystemContext& context);
+    static void recordTimeSeries(SystemContext& context);
+    static void recordAsApplied(SystemContext& context);
+    static void updateCoverage(SystemContext& context);
+
+    // Per-tick working set: immutable sensor inputs plus one target per channel
+    static SensorFrame sensors;
+    static float target[DISPENSER_CHANNEL_COUNT];
+    static bool jobOpen; // any channel out of Stopped on the previous tick
+};
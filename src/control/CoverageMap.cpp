@@ -0,0 +1,230 @@
+// ============================================
+// File: CoverageMap.cpp
+// Purpose: Tiled bitmap of dispensed ground for automatic overlap shutoff
+// Part of: Control Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include "CoverageMap.h"
+#include <math.h>
+#include <string.h>
+
+static constexpr double METRES_PER_DEG_LAT = 6371000.0 * M_PI / 180.0;
+
+void CoverageMap::reset() {
+    memset(table, 0xFF, sizeof(table));
+    tilesUsed = 0;
+    lastTile = nullptr;
+    useCounter = 0;
+    evictions = 0;
+    markedCells = 0;
+    hasOrigin = false;
+    hasPrevPose = false;
+    resetRequested = false;
+}
+
+bool CoverageMap::updatePose(bool gpsValid, const Location_t& location, float courseDeg) {
+    if (resetRequested) {
+        reset();
+    }
+
+    if (!gpsValid) {
+        hasPrevPose = false; // do not bridge a gap with a straight strip
+        return false;
+    }
+
+    if (!hasOrigin) {
+        originLat = location.lat;
+        originLng = location.lng;
+        metresPerDegLng = METRES_PER_DEG_LAT * cos(originLat * M_PI / 180.0);
+        hasOrigin = true;
+    }
+
+    float newX = static_cast<float>((location.lng - originLng) * metresPerDegLng);
+    float newY = static_cast<float>((location.lat - originLat) * METRES_PER_DEG_LAT);
+    if (fabsf(newX) > MAX_RANGE_M || fabsf(newY) > MAX_RANGE_M) {
+        reset(); // a different field; start over around this fix
+        return updatePose(gpsValid, location, courseDeg);
+    }
+
+    float course = courseDeg * static_cast<float>(M_PI / 180.0);
+    prevX = x;
+    prevY = y;
+    prevHx = hx;
+    prevHy = hy;
+    x = newX;
+    y = newY;
+    hx = sinf(course);
+    hy = cosf(course);
+
+    bool continuous = hasPrevPose && fabsf(x - prevX) + fabsf(y - prevY) <= MAX_STEP_M;
+    if (!continuous) {
+        prevX = x;
+        prevY = y;
+        prevHx = hx;
+        prevHy = hy;
+    }
+    hasPrevPose = true;
+    return true;
+}
+
+uint32_t CoverageMap::hashTile(int32_t tx, int32_t ty) {
+    return (static_cast<uint32_t>(tx) * 73856093u) ^ (static_cast<uint32_t>(ty) * 19349663u);
+}
+
+// Linear-probing delete: shift later members of the probe run back into the hole
+void CoverageMap::removeFromTable(int16_t poolIndex) {
+    uint32_t hole = hashTile(tiles[poolIndex].tx, tiles[poolIndex].ty) & (TABLE_SIZE - 1);
+    while (table[hole] != poolIndex) {
+        hole = (hole + 1) & (TABLE_SIZE - 1);
+    }
+
+    uint32_t slot = hole;
+    for (;;) {
+        slot = (slot + 1) & (TABLE_SIZE - 1);
+        if (table[slot] < 0) {
+            break;
+        }
+        const Tile& tile = tiles[table[slot]];
+        uint32_t home = hashTile(tile.tx, tile.ty) & (TABLE_SIZE - 1);
+        // Move it only if its home is not cyclically inside (hole, slot]
+        bool homeInRange = (hole <= slot) ? (home > hole && home <= slot) : (home > hole || home <= slot);
+        if (!homeInRange) {
+            table[hole] = table[slot];
+            hole = slot;
+        }
+    }
+    table[hole] = -1;
+}
+
+CoverageMap::Tile* CoverageMap::findTile(int32_t tx, int32_t ty, bool create) {
+    if (lastTile && lastTile->tx == tx && lastTile->ty == ty) {
+        lastTile->lastUse = useCounter;
+        return lastTile;
+    }
+
+    uint32_t slot = hashTile(tx, ty) & (TABLE_SIZE - 1);
+    while (table[slot] >= 0) {
+        Tile& tile = tiles[table[slot]];
+        if (tile.tx == tx && tile.ty == ty) {
+            tile.lastUse = useCounter;
+            lastTile = &tile;
+            return lastTile;
+        }
+        slot = (slot + 1) & (TABLE_SIZE - 1);
+    }
+
+    if (!create) {
+        return nullptr;
+    }
+
+    Tile* tile;
+    if (tilesUsed < POOL_TILES) {
+        tile = &tiles[tilesUsed++];
+    } else {
+        // Pool full: recycle the tile touched longest ago
+        tile = &tiles[0];
+        for (size_t i = 1; i < POOL_TILES; ++i) {
+            if (useCounter - tiles[i].lastUse > useCounter - tile->lastUse) {
+                tile = &tiles[i];
+            }
+        }
+        for (int row = 0; row < TILE_CELLS; ++row) {
+            markedCells -= __builtin_popcount(tile->rows[row]);
+        }
+        ++evictions;
+
+        // Dropping the old key can pull entries back over the free slot found above
+        removeFromTable(static_cast<int16_t>(tile - tiles));
+        slot = hashTile(tx, ty) & (TABLE_SIZE - 1);
+        while (table[slot] >= 0) {
+            slot = (slot + 1) & (TABLE_SIZE - 1);
+        }
+    }
+
+    tile->tx = static_cast<int16_t>(tx);
+    tile->ty = static_cast<int16_t>(ty);
+    tile->lastUse = useCounter;
+    memset(tile->rows, 0, sizeof(tile->rows));
+    table[slot] = static_cast<int16_t>(tile - tiles);
+    lastTile = tile;
+    return tile;
+}
+
+bool CoverageMap::testCell(float px, float py) {
+    int32_t cx = static_cast<int32_t>(floorf(px / CELL_SIZE_M));
+    int32_t cy = static_cast<int32_t>(floorf(py / CELL_SIZE_M));
+    Tile* tile = findTile(cx >> 5, cy >> 5, false);
+    return tile && (tile->rows[cy & (TILE_CELLS - 1)] & (1u << (cx & (TILE_CELLS - 1))));
+}
+
+void CoverageMap::setCell(float px, float py) {
+    int32_t cx = static_cast<int32_t>(floorf(px / CELL_SIZE_M));
+    int32_t cy = static_cast<int32_t>(floorf(py / CELL_SIZE_M));
+    Tile* tile = findTile(cx >> 5, cy >> 5, true);
+    uint32_t& row = tile->rows[cy & (TILE_CELLS - 1)];
+    uint32_t bit = 1u << (cx & (TILE_CELLS - 1));
+    if (!(row & bit)) {
+        row |= bit;
+        ++markedCells;
+    }
+}
+
+static_assert(CoverageMap::TILE_CELLS == 32, "cell addressing uses >> 5 and one uint32_t per row");
+
+// Section line at a pose: right of the heading is (hy, -hx); positive offsets are to the right
+float CoverageMap::queryCovered(float lateralOffsetM, float widthM, float aheadM) {
+    if (!hasPrevPose || widthM <= 0.0f) {
+        return 0.0f;
+    }
+    ++useCounter;
+
+    if (aheadM < MIN_LOOKAHEAD_M) aheadM = MIN_LOOKAHEAD_M;
+    float cx = x + hx * aheadM;
+    float cy = y + hy * aheadM;
+
+    int samples = static_cast<int>(widthM / SAMPLE_STEP_M) + 1;
+    int covered = 0;
+    for (int i = 0; i < samples; ++i) {
+        float offset = lateralOffsetM - widthM / 2.0f + (i + 0.5f) * widthM / samples;
+        covered += testCell(cx + hy * offset, cy - hx * offset) ? 1 : 0;
+    }
+    return static_cast<float>(covered) / samples;
+}
+
+void CoverageMap::markLine(float px, float py, float phx, float phy, float lateralOffsetM, float widthM) {
+    int samples = static_cast<int>(widthM / SAMPLE_STEP_M) + 1;
+    for (int i = 0; i < samples; ++i) {
+        float offset = lateralOffsetM - widthM / 2.0f + (i + 0.5f) * widthM / samples;
+        setCell(px + phy * offset, py - phx * offset);
+    }
+}
+
+void CoverageMap::markSection(float lateralOffsetM, float widthM) {
+    if (!hasPrevPose || widthM <= 0.0f) {
+        return;
+    }
+    ++useCounter;
+
+    float dx = x - prevX;
+    float dy = y - prevY;
+    int steps = static_cast<int>(sqrtf(dx * dx + dy * dy) / SAMPLE_STEP_M) + 1;
+
+    // Interpolated lines from just after the previous pose up to the current one
+    for (int k = 1; k <= steps; ++k) {
+        float t = static_cast<float>(k) / steps;
+        float lhx = prevHx + (hx - prevHx) * t;
+        float lhy = prevHy + (hy - prevHy) * t;
+        float norm = sqrtf(lhx * lhx + lhy * lhy);
+        if (norm < 1e-3f) {
+            lhx = hx;
+            lhy = hy;
+        } else {
+            lhx /= norm;
+            lhy /= norm;
+        }
+        markLine(prevX + dx * t, prevY + dy * t, lhx, lhy, lateralOffsetM, widthM);
+    }
+}
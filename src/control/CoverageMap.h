@@ -0,0 +1,107 @@
+// ============================================
+// File: CoverageMap.h
+// Purpose: Tiled bitmap of dispensed ground for automatic overlap shutoff
+// Part of: Control Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "gps/GPSProvider.h"
+
+/*
+  Ground is a local east/north grid in metres, centred on the first fix
+  after a reset, with CELL_SIZE_M cells grouped into TILE_CELLS² tiles of
+  one bit per cell. Tiles live in a fixed pool found through a small
+  open-addressing table; when the pool is full the least recently used
+  tile is recycled, so memory stays bounded and only ground far behind
+  the machine is forgotten (which just means no shutoff there).
+
+  Each tick the control task projects the pose once, asks for the covered
+  fraction of a line across each section at its look-ahead distance, and
+  marks the strip swept since the last tick by every section that is
+  dispensing. The query line is never closer than MIN_LOOKAHEAD_M, which
+  exceeds a cell diagonal, so a section never sees its own fresh marks.
+*/
+class CoverageMap {
+    friend class SystemContext; // Allow SystemContext to access private members
+public:
+    static constexpr float CELL_SIZE_M = 1.0f;
+    static constexpr int TILE_CELLS = 32;                   // one uint32_t per tile row
+    static constexpr size_t POOL_TILES = 256;               // 256 × 32 m × 32 m ≈ 26 ha in 35 KB
+    static constexpr size_t TABLE_SIZE = 2 * POOL_TILES;    // power of two
+    static constexpr float MIN_LOOKAHEAD_M = 1.5f * CELL_SIZE_M;
+    static constexpr float SAMPLE_STEP_M = 0.5f * CELL_SIZE_M;
+    static constexpr float MAX_STEP_M = 10.0f;              // larger pose jumps are GPS glitches, not travel
+    static constexpr float MAX_RANGE_M = 20000.0f;          // farther from the origin restarts the map
+    static constexpr float CLOSE_FRACTION = 0.7f;           // close a section over ≥ 70 % covered ground
+    static constexpr float OPEN_FRACTION = 0.3f;            // and reopen below 30 %
+
+    CoverageMap(const CoverageMap&) = delete;
+    CoverageMap& operator=(const CoverageMap&) = delete;
+    CoverageMap(CoverageMap&&) = delete;
+    CoverageMap& operator=(CoverageMap&&) = delete;
+
+    void reset();
+    inline void requestReset() { resetRequested = true; } // from other tasks; applied on the next tick
+
+    // Control task, once per tick before query/mark; false without a usable pose
+    bool updatePose(bool gpsValid, const Location_t& location, float courseDeg);
+
+    // Covered fraction of the line across a section, aheadM in front of the antenna
+    float queryCovered(float lateralOffsetM, float widthM, float aheadM);
+
+    // Strip swept by a section between the previous and current pose
+    void markSection(float lateralOffsetM, float widthM);
+
+    inline void setShutoffEnabled(bool enabled) { shutoffEnabled = enabled; }
+    inline bool isShutoffEnabled() const { return shutoffEnabled; }
+
+    inline size_t getTilesUsed() const { return tilesUsed; }
+    inline uint32_t getEvictions() const { return evictions; }
+    inline uint32_t getMarkedCells() const { return markedCells; }
+    inline float getCoveredAreaM2() const { return markedCells * CELL_SIZE_M * CELL_SIZE_M; }
+
+private:
+    CoverageMap() { reset(); }
+
+    struct Tile {
+        int16_t tx;
+        int16_t ty;
+        uint32_t lastUse;
+        uint32_t rows[TILE_CELLS];
+    };
+
+    Tile* findTile(int32_t tx, int32_t ty, bool create);
+    void removeFromTable(int16_t poolIndex);
+    static uint32_t hashTile(int32_t tx, int32_t ty);
+    bool testCell(float x, float y);
+    void setCell(float x, float y);
+    void markLine(float x, float y, float hx, float hy, float lateralOffsetM, float widthM);
+
+    Tile tiles[POOL_TILES];
+    int16_t table[TABLE_SIZE];     // pool index or -1
+    size_t tilesUsed = 0;
+    Tile* lastTile = nullptr;      // consecutive lookups mostly hit the same tile
+    uint32_t useCounter = 0;
+    uint32_t evictions = 0;
+    uint32_t markedCells = 0;
+
+    // Local frame
+    bool hasOrigin = false;
+    double originLat = 0.0;
+    double originLng = 0.0;
+    double metresPerDegLng = 0.0;
+
+    // Current and previous pose: position and unit heading (east, north)
+    bool hasPrevPose = false;
+    float x = 0.0f, y = 0.0f, hx = 0.0f, hy = 1.0f;
+    float prevX = 0.0f, prevY = 0.0f, prevHx = 0.0f, prevHy = 1.0f;
+
+    volatile bool shutoffEnabled = true;
+    volatile bool resetRequested = false;
+};
@@ -17,43 +17,49 @@
 #include <driver/ledc.h>
 
 // Define the static variable
-float ApplicationMetrics::tankLevel = 0.0f;
+double ApplicationMetrics::tankLevelKg = 0.0;
+volatile float ApplicationMetrics::tankLevel = 0.0f;
+float ApplicationMetrics::initialTankLevel = 0.0f;
+volatile float ApplicationMetrics::requestedTankLevel = 0.0f;
+volatile bool ApplicationMetrics::tankLevelRequested = false;
 
 bool DispenserChannel::clientInWorkZone = false; // Default client work zone status
 SystemContext* DispenserChannel::context = nullptr;
 
-void DispenserChannel::init(String name, SystemContext* ctx, const VNH7070ASPins &motorPins) {
-  context = ctx;
-  channelName = name;
-  channelIndex = 0;
-  _adcChannel = ADS1115Channels::CH0;  
+static const char* const CHANNEL_NAMES[MAX_DISPENSER_CHANNELS] = {
+  "Left", "Right", "Sec3", "Sec4", "Sec5", "Sec6", "Sec7", "Sec8"
+};
 
-  if (name == "Right") {
-    channelIndex = 1;
-    _adcChannel = ADS1115Channels::CH1;
-  }
+void DispenserChannel::init(uint8_t index, SystemContext* ctx, const DispenserChannelPins &pins) {
+  context = ctx;
+  channelIndex = index;
+  channelName = CHANNEL_NAMES[index];
+  _positionAdcChannel = pins.positionAdcChannel;
+  _currentAdcChannel = pins.currentAdcChannel;
 
-  motorDriver.init(motorPins, channelIndex);
+  motorDriver.init(pins.motor, channelIndex);
 }
 
-void DispenserChannel::checkLowSpeedState() {
-    SystemParams & params = context->getParams();
-    if (getTargetFlowRatePerDaa() > 0.0f) {
-        if (context->getGroundSpeed() < params.minWorkingSpeed) {
+void DispenserChannel::checkLowSpeedState(const SensorFrame& frame) {
+    const SystemParams& params = frame.params;
+    if (flowMode == FlowControlMode::PerArea && getTargetFlowRatePerDaa() > 0.0f) {
+        if (frame.getSpeedKmph() < params.minWorkingSpeed) {
             if (params.minWorkingSpeed > 0) {
                 if (taskStateController.isTaskActive()) {
                     lowSpeedFlag = true;
                     taskStateController.setTaskState(UserTaskState::Paused);
-                    LogUtils::warn("[FLOW] %s Channel Task Paused due to Low Speed\n", channelName);
+                    LogUtils::warn("[FLOW] %s Channel Task Paused due to Low Speed\n", channelName.c_str());
                 }
             }
         } else {
             if (lowSpeedFlag) {
+                // Requested every second until the control task has applied it; a dropped
+                // request would otherwise leave the task paused with nothing to resume it
                 if (taskStateController.isTaskPaused()) {
-                    LogUtils::info("[FLOW] Resuming %s Channel Task\n", channelName);
-                    lowSpeedFlag = false;
-                    // Optional: channel.setTaskState(UserTaskState::Resuming);
+                    LogUtils::info("[FLOW] Resuming %s Channel Task\n", channelName.c_str());
                     taskStateController.setTaskState(UserTaskState::Resuming);
+                } else {
+                    lowSpeedFlag = false; // resumed, or stopped meanwhile
                 }
             }
         }
@@ -61,22 +67,20 @@ void DispenserChannel::checkLowSpeedState() {
 }
 
 void DispenserChannel::reportErrorFlags(void) {
-  static int oldErrorFlags = NO_ERROR;
-  static int counter = 0;
   int heartBeatPeriod = context->getParams().heartBeatPeriod;
   uint32_t errorFlags = taskStateController.getErrorManager().getErrorFlags();
 
   // error is reported periodically and instantly if it is only NO_ERROR
-  bool reportInstantly = (oldErrorFlags != errorFlags) && (errorFlags == NO_ERROR);
-  if (reportInstantly || (++counter == heartBeatPeriod)) {
-    counter = 0;
+  bool reportInstantly = (lastReportedErrorFlags != errorFlags) && (errorFlags == NO_ERROR);
+  if (reportInstantly || (++reportCounter >= heartBeatPeriod)) {
+    reportCounter = 0;
     String packet = UserInfoFormatter::makeErrorInfoPacket(errorFlags, true);
     context->getCommandHandler().sendBLEPacketChecked(packet);
   }
-  oldErrorFlags = errorFlags;
+  lastReportedErrorFlags = errorFlags;
 }
 
-void DispenserChannel::updateApplicationMetrics() {
+void DispenserChannel::updateApplicationMetrics(const SensorFrame& frame) {
   if (!taskStateController.isTaskActive()) {
     return;  // Don't update metrics if not active
   }
@@ -84,32 +88,20 @@ void DispenserChannel::updateApplicationMetrics() {
   ApplicationMetrics & metrics = taskStateController.getMetrics();
   ErrorManager & errorManager = taskStateController.getErrorManager();
 
-  SystemParams & params = context->getParams();
-  float groundSpeedKMPH = context->getGroundSpeed();
-  float groundSpeedMPS = context->getGroundSpeed(true);
-
-  float flowRatePerMin = getRealFlowRatePerMin();
-  bool isBoomWidthOK = (getBoomWidth() > 0);
-  bool isSpeedOK = (groundSpeedKMPH >= params.minWorkingSpeed);
-  bool isFlowOK = (flowRatePerMin > 0);
-  const float deltaTime = 1.0f; // This method is called every second
+  const SystemParams& params = frame.params;
+  bool isFlowOK = (getRealFlowRatePerMin() > 0);
 
-  if (isSpeedOK && isBoomWidthOK) {
+  // Distance, area and consumption are integrated at control rate in integrateMetrics()
+  // A gate shut by the coverage map is not a flow fault
+  if (isWorking(frame) && !overlapClosed) {
     if (isFlowOK) {
-      // Update shared metrics only once per update (safe here — same slice for both channels)
-      float processedAreaPerSec = getProcessedAreaPerSec();
-
-      // Update metrics
-      metrics.increaseDistance(groundSpeedMPS * deltaTime);
-      metrics.increaseArea(processedAreaPerSec);
-      metrics.incrementDuration();
-      metrics.applyFlowSlice(flowRatePerMin);
-
-      LogUtils::info("[FLOW] Ground Speed, Boom Width and Min Flow OK for one channel!\n");
-
+      // Logged on recovery only; this runs every second for the whole job
+      if (errorManager.hasError(INSUFFICIENT_FLOW)) {
+        LogUtils::info("[FLOW] Ground Speed, Boom Width and Min Flow OK for one channel!\n");
+      }
       errorManager.clearError(INSUFFICIENT_FLOW);
 
-      if (abs(piController.getError()) >= FLOW_ERROR_WARNING_THRESHOLD) {
+      if (fabsf(getControlError()) >= FLOW_ERROR_WARNING_THRESHOLD) {
         if (++counter >= params.heartBeatPeriod) {
           errorManager.setError(FLOW_NOT_SETTLED);
           counter = 0;
@@ -136,8 +128,14 @@ void DispenserChannel::updateApplicationMetrics() {
     errorManager.setError(LIQUID_TANK_EMPTY);
   }
 
+  if (context->getTankEstimator().isLowWarning()) {
+    errorManager.setError(TANK_LOW_WARNING);
+  } else {
+    errorManager.clearError(TANK_LOW_WARNING);
+  }
+
   // GPS satellite check (same for both)
-  int satCount = context->getGPSProvider().getSatelliteCount();
+  int satCount = frame.satellites;
   if (satCount < GPSProvider::MIN_SATELLITES_NEEDED) {
     errorManager.setError(NO_SATELLITE_CONNECTED);
   } else {
@@ -145,13 +143,89 @@ void DispenserChannel::updateApplicationMetrics() {
   }
 }
 
-float DispenserChannel::getProcessedAreaPerSec() const {
-  // Area covered per second in m²/s = speed × boom width
-  return context->getGroundSpeed(true) * getBoomWidth();
+// Constant-flow mode dispenses regardless of motion (e.g. stationary calibration)
+bool DispenserChannel::isWorking(const SensorFrame& frame) const {
+  bool isBoomWidthOK = (getBoomWidth() > 0);
+  bool isSpeedOK = (frame.getSpeedKmph() >= frame.params.minWorkingSpeed);
+  return (flowMode == FlowControlMode::PerMinute) || (isSpeedOK && isBoomWidthOK);
+}
+
+/*
+  Control-rate integration over the measured interval between ADC sweeps,
+  so a late or early tick is weighted by the time it actually covered.
+*/
+void DispenserChannel::integrateMetrics(const SensorFrame& frame) {
+  const float nominalDt = 1.0f / CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
+  float dt = nominalDt;
+
+  if (lastMetricsSampleUs != 0 && frame.adcSampleUs > lastMetricsSampleUs) {
+    dt = (frame.adcSampleUs - lastMetricsSampleUs) * 1e-6f;
+    if (dt > MAX_METRICS_DT_SEC) {
+      dt = nominalDt; // stalled task or first tick after a long gap: do not extrapolate
+    }
+  }
+  lastMetricsSampleUs = frame.adcSampleUs;
+
+  float kgPerMin = flowEstimator.getKgPerMin();
+  bool working = taskStateController.isTaskActive() && isWorking(frame) && kgPerMin > 0.0f;
+
+  taskStateController.getMetrics().integrate(frame.speedMps, getProcessedAreaPerSec(frame), kgPerMin, working, dt);
+}
+
+float DispenserChannel::getProcessedAreaPerSec(const SensorFrame& frame, float lookAheadSec) const {
+  // Area covered per second in m²/s = section speed × boom width
+  float speed = (lookAheadSec > 0.0f) ? frame.getPredictedSpeedMps(lookAheadSec) : frame.speedMps;
+  speed *= frame.getSectionSpeedFactor(getLateralOffset());
+  return speed * getBoomWidth();
+}
+
+/*
+  Unless configured, sections are assumed to sit side by side in channel order,
+  left to right, centred on the GPS track.
+*/
+float DispenserChannel::getLateralOffset() const {
+  if (!isLateralOffsetAuto()) return lateralOffset;
+
+  float totalWidth = 0.0f;
+  float leftEdge = 0.0f;
+  for (size_t i = 0; i < context->getChannelCount(); ++i) {
+    float width = context->getChannel(i).getBoomWidth();
+    if (i < channelIndex) leftEdge += width;
+    totalWidth += width;
+  }
+
+  return leftEdge + getBoomWidth() / 2.0f - totalWidth / 2.0f;
+}
+
+void DispenserChannel::setLatencyLearning(bool enabled) {
+  if (enabled && !latencyLearning) {
+    latencyEstimator.reset();
+  }
+  latencyLearning = enabled;
+}
+
+// Hysteresis so a section does not chatter along the edge of a previous pass
+void DispenserChannel::updateOverlapShutoff(float coveredFraction, bool enabled) {
+  if (!enabled || flowMode != FlowControlMode::PerArea) {
+    overlapClosed = false;
+  } else if (coveredFraction >= CoverageMap::CLOSE_FRACTION) {
+    overlapClosed = true;
+  } else if (coveredFraction <= CoverageMap::OPEN_FRACTION) {
+    overlapClosed = false;
+  }
+}
+
+float DispenserChannel::getLookAheadSec() const {
+  float latency = (latencyLearning && latencyEstimator.hasEstimate()) ? latencyEstimator.getEstimate() : actuatorLatencySec;
+  return constrain(latency, 0.0f, GPSProvider::MAX_PREDICTION_HORIZON_SEC);
 }
 
-float DispenserChannel::getTargetPositionForRate(float desiredKgPerDaa) const {
-    float areaPerSec = getProcessedAreaPerSec();
+/*
+  The gate reaches a new target only after the actuator lag, so the target is
+  computed for the speed the machine will have by then (look-ahead).
+*/
+float DispenserChannel::getTargetPositionForRate(const SensorFrame& frame, float desiredKgPerDaa) const {
+    float areaPerSec = getProcessedAreaPerSec(frame, getLookAheadSec());
     if (!isfinite(areaPerSec) || areaPerSec <= 0.0f || flowCoeff <= 0.0f) return 0.0f;
 
     float desiredFlowPerSec = (desiredKgPerDaa / Units::SQUARE_METERS_PER_DAA) * areaPerSec;
@@ -160,28 +234,95 @@ float DispenserChannel::getTargetPositionForRate(float desiredKgPerDaa) const {
     return constrain(desiredPositionPercent, 0.0f, 100.0f);
 }
 
+float DispenserChannel::getTargetPositionForFlow(float desiredKgPerMin) const {
+    if (!isfinite(desiredKgPerMin) || desiredKgPerMin <= 0.0f || flowCoeff <= 0.0f) return 0.0f;
+
+    // Same flow model as the per-area mode, without the ground speed term
+    float desiredFlowPerSec = desiredKgPerMin / Units::MINUTE_TO_SECOND;
+    float desiredPositionPercent = desiredFlowPerSec * flowCoeff;
+
+    return constrain(desiredPositionPercent, 0.0f, 100.0f);
+}
+
+/*
+  Switching modes only changes which rate model produces the raw target; the
+  setpoint shaper ramps from the current target and the PI state is kept, so
+  the transfer is bumpless.
+*/
+void DispenserChannel::setFlowMode(FlowControlMode mode) {
+  if (mode != FlowControlMode::PerArea && mode != FlowControlMode::PerMinute) return;
+
+  if (mode != flowMode) {
+    LogUtils::info("[FLOW] %s Channel mode %s -> %s\n", channelName.c_str(), flowModeToString(flowMode), flowModeToString(mode));
+
+    // A low-speed pause does not apply to constant flow
+    if (lowSpeedFlag && mode == FlowControlMode::PerMinute && taskStateController.isTaskPaused()) {
+      taskStateController.setTaskState(UserTaskState::Resuming);
+    }
+    lowSpeedFlag = false;
+  }
+  flowMode = mode;
+}
+
+// Applied by the control task on its next tick; the incoming controller starts from the duty last applied
+void DispenserChannel::setControlAlgorithm(GateControlAlgorithm algorithm) {
+  if (algorithm != controlAlgorithm) {
+    LogUtils::info("[CTRL] %s Channel controller %s -> %s\n", channelName.c_str(),
+                   controlAlgorithmToString(controlAlgorithm), controlAlgorithmToString(algorithm));
+  }
+  controlAlgorithm = algorithm;
+}
+
+const char* DispenserChannel::controlAlgorithmToString(GateControlAlgorithm algorithm) {
+  switch (algorithm) {
+    case GateControlAlgorithm::PILoop: return "PI";
+    case GateControlAlgorithm::MPC:    return "MPC";
+    default:                           return "Unknown";
+  }
+}
+
+const char* DispenserChannel::flowModeToString(FlowControlMode mode) {
+  switch (mode) {
+    case FlowControlMode::PerArea:   return "PerArea";
+    case FlowControlMode::PerMinute: return "PerMinute";
+    default:                         return "Unknown";
+  }
+}
+
 float DispenserChannel::getCurrentPositionPercent() const {
-    return getCurrentPositionPercent(_adcChannel);
+    return getCurrentPositionPercent(_positionAdcChannel);
 }
 
-float DispenserChannel::getCurrentPositionPercent(ADS1115Channels adcChannel) const {
-    float voltage = context->getADS1115().readFilteredVoltage(adcChannel);
+float DispenserChannel::getCurrentPositionPercent(uint8_t adcChannel) const {
+    // Latest sweep only: it was taken at the start of this control tick
+    float voltage = context->getADS1115().readLatestVoltage(adcChannel);
     voltage = constrain(voltage, MIN_POT_VOLTAGE, MAX_POT_VOLTAGE);
     
     return (voltage - MIN_POT_VOLTAGE) / (MAX_POT_VOLTAGE - MIN_POT_VOLTAGE) * 100.0f;
 }
 
+float DispenserChannel::getMotorCurrent() const {
+    return context->getADS1115().readFilteredCurrent(_currentAdcChannel);
+}
+
 /*
   position zero means no flow, position 100 means maximum flow.
-  The position is calculated based on the voltage read from the potentiometer.
-  The voltage is mapped to a percentage of the full range (0-100%).
+  The measured position comes from the tick's SensorFrame, mapped from the
+  potentiometer voltage to a percentage of the full range (0-100%).
 */
-void DispenserChannel::applyPIControl() {
-  float measured = getCurrentPositionPercent(_adcChannel);
-  float target = getTargetPositionForRate(targetFlowRatePerDaa);
-
-  if (taskStateController.isTaskPassive()) {
-    target = 0.0f; // If stopped, no flow
+float DispenserChannel::computeControlTarget(const SensorFrame& frame) {
+  const float dt = 1.0f / CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
+  const float measured = frame.positionPercent[channelIndex];
+  float target = (flowMode == FlowControlMode::PerMinute) ?
+      getTargetPositionForFlow(targetFlowRatePerMin) :
+      getTargetPositionForRate(frame, targetFlowRatePerDaa);
+  rawTargetPosition = target;
+
+  if (taskStateController.isTaskPassive() || overlapClosed) {
+    target = 0.0f; // If stopped or over covered ground, no flow
+    rawTargetPosition = target;
+    // Close without ramping; restart ramps from wherever the gate actually is
+    setpointShaper.reset(measured);
   } else if (taskStateController.getTaskState() == UserTaskState::Testing) {
     testTick += (testDirection ? 1 : -1);
 
@@ -194,27 +335,114 @@ void DispenserChannel::applyPIControl() {
     }
 
     target = testTick;
+    rawTargetPosition = target;
+    setpointShaper.reset(target); // the test sweep is already a ramp
+  } else {
+    if (latencyLearning) {
+      latencyEstimator.observe(rawTargetPosition, measured, dt);
+    }
+    target = setpointShaper.update(target, dt);
   }
 
-  applyPIControl(target, measured);
+  shapedTargetPosition = target;
+  return target;
 }
 
 void DispenserChannel::applyPIControl(float target, float measured) {
-  float signal = piController.compute(target, measured);
-  if (piController.isControlSignalChanged()) {
-    motorDriver.setSpeed(static_cast<int8_t>(signal));
+  computePIControl(target, measured);
+  applyControlSignal();
+}
+
+// Split so the control loop can compute every channel before touching the drivers
+void DispenserChannel::computePIControl(float target, float measured) {
+  UserTaskState state = taskStateController.getTaskState();
+
+  GateControlAlgorithm algorithm = controlAlgorithm;
+
+  // Gain changes from BLE land here, between two compute() calls; the comparison restarts under the new gains
+  PIGains gains;
+  if (piGainRequest.take(gains)) {
+    piController.setGains(gains);
+    shadowController.setActiveGains(gains);
+  }
+  shadowController.applyRequests();
+
+  // Starting from Stopped or Paused the gate was driven shut: drop the integral built up
+  // while closing. Anywhere else the gate is running, so the incoming state or controller
+  // takes over from the duty last applied, with the integral back-calculated to it (no bump)
+  if (state != controlState || algorithm != activeAlgorithm) {
+    bool fromClosed = controlState == UserTaskState::Stopped || controlState == UserTaskState::Paused;
+    if (fromClosed) {
+      piController.reset(measured);
+      mpcController.reset(measured);
+    } else {
+      int applied = getControlSignal(); // still the outgoing controller's
+      piController.track(target, measured, applied);
+      mpcController.track(measured, applied);
+    }
+    shadowController.resync(measured);
+    controlState = state;
+    activeAlgorithm = algorithm;
+  }
+
+  if (algorithm == GateControlAlgorithm::MPC) {
+    mpcController.setPlantGain(plantModel.getGain());
+    mpcController.setReferenceTrend(setpointShaper.getRate(), rawTargetPosition);
+    mpcController.compute(target, measured);
+  } else {
+    piController.compute(target, measured);
+  }
+  plantModel.observe(measured, getControlSignal(), 1.0f / CONTROL_LOOP_UPDATE_FREQUENCY_HZ);
+
+  // Candidate controller: computed on a gate model, never applied. Its reference is the
+  // active PI loop, so there is nothing to score it against while the channel runs MPC
+  if (shadowController.isEnabled() && algorithm == GateControlAlgorithm::PILoop) {
+    shadowController.update(rawTargetPosition, target, plantModel, taskStateController.isTaskActive());
+  }
+}
+
+void DispenserChannel::applyControlSignal() {
+  bool changed = (activeAlgorithm == GateControlAlgorithm::MPC) ?
+      mpcController.isControlSignalChanged() : piController.isControlSignalChanged();
+
+  if (changed) {
+    motorDriver.setSpeed(static_cast<int8_t>(getControlSignal()));
   }
 }
 
-void DispenserChannel::printMotorCurrent(void) {
-  ADS1115& ads1115 = context->getADS1115();
-  ads1115.pushBuffer(); // Push all channels to the buffer
-  
-  // --- Compute averages and convert to voltage ---
-  float pos1 = getCurrentPositionPercent(ADS1115Channels::CH0);
-  float pos2 = getCurrentPositionPercent(ADS1115Channels::CH1);
-  float current1 = ads1115.readFilteredCurrent(ADS1115Channels::CH2);
-  float current2 = ads1115.readFilteredCurrent(ADS1115Channels::CH3);
+int DispenserChannel::getControlSignal() const {
+  return (activeAlgorithm == GateControlAlgorithm::MPC) ?
+      mpcController.getControlSignal() : piController.getControlSignal();
+}
+
+float DispenserChannel::getControlError() const {
+  return (activeAlgorithm == GateControlAlgorithm::MPC) ?
+      mpcController.getError() : piController.getError();
+}
+
+/*
+  Runs at control rate; the 1 Hz metrics path only sees the decimated values
+  published once per second through realFlowRatePerMin/PerDaa.
+*/
+void DispenserChannel::updateFlowEstimate(const SensorFrame& frame) {
+  const float dt = 1.0f / CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
+
+  if (!flowEstimator.update(frame.positionPercent[channelIndex], flowCoeff, getProcessedAreaPerSec(frame), dt)) {
+    return;
+  }
+
+  setRealFlowRatePerMin(flowEstimator.getPublishedKgPerMin());
+  setRealFlowRatePerDaa(flowEstimator.getPublishedKgPerDaa());
+
+  bool perMinute = (flowMode == FlowControlMode::PerMinute);
+  float target = perMinute ? targetFlowRatePerMin : targetFlowRatePerDaa;
+  float real = perMinute ? realFlowRatePerMin : realFlowRatePerDaa;
+
+  flowRateError = real - target;
+  flowRateErrorPercent = (target > 0.0f) ? flowRateError / target * 100.0f : 0.0f;
+}
 
-  DebugInfoPrinter::printMotorDiagnostics(pos1, pos2, current1, current2);
+void DispenserChannel::printMotorCurrent(const SensorFrame& frame) const {
+  // Values from the last control tick; no I2C access from the printing task
+  DebugInfoPrinter::printMotorDiagnostics(channelName.c_str(), frame.positionPercent[channelIndex], frame.motorCurrent[channelIndex]);
 }
\ No newline at end of file
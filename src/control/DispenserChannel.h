@@ -12,17 +12,36 @@
 #include <stdint.h>
 #include <Arduino.h>
 #include "PIController.h"
+#include "SetpointShaper.h"
+#include "ShadowController.h"
+#include "MPCController.h"
+#include "GatePlantModel.h"
+#include "ActuatorLatencyEstimator.h"
+#include "FlowEstimator.h"
 #include "io/VNH7070AS.h"
 #include "io/IOConfig.h"
 #include "io/ADS1115.h"
+#include "io/DispenserChannelPins.h"
+#include "core/SensorFrame.h"
 #include "core/SystemPreferences.h"
 #include "control/ApplicationMetrics.h"
 #include "control/TaskStateController.h"
 
 class SystemContext; // Forward declaration
 
+enum class FlowControlMode : uint8_t {
+    PerArea = 0,    // kg/daa, gate follows ground speed
+    PerMinute       // kg/min, speed independent constant flow
+};
+
+enum class GateControlAlgorithm : uint8_t {
+    PILoop = 0,     // PIController (name avoids the Arduino PI macro)
+    MPC             // MPCController on the learned GatePlantModel
+};
+
 constexpr float MIN_POT_VOLTAGE = 0.00f; // Minimum voltage for potentiometer
 constexpr float MAX_POT_VOLTAGE = 3.30f; // Maximum voltage for potentiometer
+constexpr float MAX_METRICS_DT_SEC = 0.5f; // longer tick gaps are integrated as one nominal period
 
 class DispenserChannel {
     friend class SystemContext; // Allow SystemContext to access private members
@@ -38,8 +57,20 @@ public:
     const VNH7070AS& getMotor() const { return motorDriver; }
     PIController& getPIController() { return piController; }
     const PIController& getPIController() const { return piController; }
+    SetpointShaper& getSetpointShaper() { return setpointShaper; }
+    const SetpointShaper& getSetpointShaper() const { return setpointShaper; }
+    MPCController& getMPCController() { return mpcController; }
+    const MPCController& getMPCController() const { return mpcController; }
+    const GatePlantModel& getPlantModel() const { return plantModel; }
+    ShadowController& getShadowController() { return shadowController; }
+    const ShadowController& getShadowController() const { return shadowController; }
+    const ActuatorLatencyEstimator& getLatencyEstimator() const { return latencyEstimator; }
+    const FlowEstimator& getFlowEstimator() const { return flowEstimator; }
+
+    void init(uint8_t index, SystemContext* ctx, const DispenserChannelPins& pins);
 
-    void init(String name, SystemContext* ctx, const VNH7070ASPins& motorPins);
+    inline uint8_t getIndex() const { return channelIndex; }
+    inline const String& getName() const { return channelName; }
 
     // Setters
     inline void setTargetFlowRatePerDaa(float val) { targetFlowRatePerDaa = val; }
@@ -47,27 +78,60 @@ public:
     inline void setRealFlowRatePerDaa(float val) { realFlowRatePerDaa = val; }
     inline void setRealFlowRatePerMin(float val) { realFlowRatePerMin = val; }
     inline void setFlowCoeff(float val) { flowCoeff = val; }
+    void setFlowMode(FlowControlMode mode);
+    void setControlAlgorithm(GateControlAlgorithm algorithm);
     inline void setBoomWidth(float val) { boomWidth = val; }
+    inline void setActuatorLatency(float seconds) { actuatorLatencySec = seconds > 0.0f ? seconds : 0.0f; }
+    void setLatencyLearning(bool enabled);
+    inline void setLateralOffset(float meters) { lateralOffset = meters; } // NAN = derive from boom layout
+    // Any task: staged, then applied bumplessly by the control task at the start of its next PI pass
+    inline void requestPIGains(const PIGains& gains) { piGainRequest.write(gains); }
 
     // Getters
     inline float getTargetFlowRatePerDaa() const { return targetFlowRatePerDaa; }
     inline float getTargetFlowRatePerMin() const { return targetFlowRatePerMin; }
     inline float getRealFlowRatePerDaa() const { return realFlowRatePerDaa; }
     inline float getRealFlowRatePerMin() const { return realFlowRatePerMin; }
+    inline float getFlowRateError() const { return flowRateError; }
+    inline float getFlowRateErrorPercent() const { return flowRateErrorPercent; }
     inline float getFlowCoeff() const { return flowCoeff; }
+    inline FlowControlMode getFlowMode() const { return flowMode; }
+    inline GateControlAlgorithm getControlAlgorithm() const { return controlAlgorithm; }
+    inline PIGains getPIGains() const { return piGainRequest.read(); } // latest requested, live from the next tick
+    int getControlSignal() const;
+    float getControlError() const;
     inline float getBoomWidth() const { return boomWidth; }
+    inline float getRawTargetPosition() const { return rawTargetPosition; }
+    inline float getShapedTargetPosition() const { return shapedTargetPosition; }
+    inline float getActuatorLatency() const { return actuatorLatencySec; }
+    inline bool isLatencyLearning() const { return latencyLearning; }
+    float getLookAheadSec() const;
+    inline bool isOverlapClosed() const { return overlapClosed; }
+    void updateOverlapShutoff(float coveredFraction, bool enabled);
+    inline bool isLateralOffsetAuto() const { return isnan(lateralOffset); }
+    float getLateralOffset() const;
 
     // Helper methods
-    void checkLowSpeedState();
-    void updateApplicationMetrics();
-    float getProcessedAreaPerSec() const;
+    void checkLowSpeedState(const SensorFrame& frame);
+    void updateApplicationMetrics(const SensorFrame& frame);
+    void integrateMetrics(const SensorFrame& frame);
+    bool isWorking(const SensorFrame& frame) const;
+    float getProcessedAreaPerSec(const SensorFrame& frame, float lookAheadSec = 0.0f) const;
     float getCurrentPositionPercent() const;
-    float getCurrentPositionPercent(ADS1115Channels adcChannel) const;
-    float getTargetPositionForRate(float desiredKgPerDaa) const;
+    float getCurrentPositionPercent(uint8_t adcChannel) const;
+    float getMotorCurrent() const;
+    float getTargetPositionForRate(const SensorFrame& frame, float desiredKgPerDaa) const;
+    float getTargetPositionForFlow(float desiredKgPerMin) const;
+    float computeControlTarget(const SensorFrame& frame);
     void reportErrorFlags(void);
-    void applyPIControl();
     void applyPIControl(float target, float measured);
-    void printMotorCurrent(void);
+    void computePIControl(float target, float measured);
+    void applyControlSignal();
+    void updateFlowEstimate(const SensorFrame& frame);
+    void printMotorCurrent(const SensorFrame& frame) const;
+
+    static const char* flowModeToString(FlowControlMode mode);
+    static const char* controlAlgorithmToString(GateControlAlgorithm algorithm);
 
     static bool isClientInWorkZone() { return clientInWorkZone; }
     static void setClientInWorkZone(bool inWorkZone) { clientInWorkZone = inWorkZone; }
@@ -76,21 +140,44 @@ private:
     static SystemContext* context;
 
     PIController piController;
+    PIGainRequest piGainRequest;
+    SetpointShaper setpointShaper;
+    MPCController mpcController;
+    GatePlantModel plantModel;
+    ShadowController shadowController;
+    ActuatorLatencyEstimator latencyEstimator;
+    FlowEstimator flowEstimator;
     VNH7070AS motorDriver;
     TaskStateController taskStateController;
 
     String channelName;
-    uint8_t channelIndex = 0;  // CH0 for left, CH1 for right
-    ADS1115Channels _adcChannel = ADS1115Channels::CH0; // Default to CH0
+    uint8_t channelIndex = 0;  // position in SystemContext's channel array
+    uint8_t _positionAdcChannel = ADS1115Channels::CH0;
+    uint8_t _currentAdcChannel = ADS1115Channels::CH2;
 
     float targetFlowRatePerDaa = 0.0f;
     float targetFlowRatePerMin = 0.0f;
     float realFlowRatePerDaa = 0.0f;
     float realFlowRatePerMin = 0.0f;
+    float flowRateError = 0.0f;        // real - target, in the unit of the active flow mode
+    float flowRateErrorPercent = 0.0f; // relative to target, 0 when there is no target
     float flowCoeff = 1.0f;
+    FlowControlMode flowMode = FlowControlMode::PerArea;
+    volatile GateControlAlgorithm controlAlgorithm = GateControlAlgorithm::PILoop;
+    GateControlAlgorithm activeAlgorithm = GateControlAlgorithm::PILoop; // what the control task last ran
     float boomWidth = 0.0f; // in meters, used for area calculations
+    float lateralOffset = NAN; // section centre from the GPS track, meters, positive to the right
+    float rawTargetPosition = 0.0f;    // gate target straight from the rate model, %
+    float shapedTargetPosition = 0.0f; // after setpoint shaping, fed to the PI loop, %
+    float actuatorLatencySec = 0.0f;   // configured gate lag, used as look-ahead horizon
+    UserTaskState controlState = UserTaskState::Stopped; // state the controller last ran under
+    bool latencyLearning = false;      // use the learned lag instead once available
+    volatile bool overlapClosed = false; // gate held shut over ground already dispensed on
 
     int counter = 0;
+    int64_t lastMetricsSampleUs = 0; // ADC sweep time of the previous integration step
+    int reportCounter = 0;
+    uint32_t lastReportedErrorFlags = NO_ERROR;
     bool lowSpeedFlag = false;
     int testTick = 0;
     bool testDirection = true;  // true = forward, false = backward
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
 
 // Flow-related constant
 constexpr float FLOW_ERROR_WARNING_THRESHOLD = 2.0f;
@@ -20,9 +21,12 @@ enum UserErrorCodes {
     INVALID_GPS_SPEED       = 1 << 9,
     INVALID_PARAM_COUNT     = 1 << 10,
     MESSAGE_PARSE_ERROR     = 1 << 11,
-    HARDWARE_ERROR          = 1 << 12
+    HARDWARE_ERROR          = 1 << 12,
+    TANK_LOW_WARNING        = 1 << 13   // predicted time to empty below the configured minutes
 };
 
+constexpr size_t ERROR_FLAG_COUNT = 14; // bits used by UserErrorCodes
+
 class ErrorManager {
 private:
     uint32_t errorFlags = NO_ERROR;
@@ -0,0 +1,52 @@
+// ============================================
+// File: FlowEstimator.cpp
+// Purpose: Estimates actual flow from measured gate position
+// Part of: Control Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include "FlowEstimator.h"
+#include "core/Constants.h"
+#include <math.h>
+
+/*
+  Inverse of the flow model used for targets (position = kg/s × flowCoeff):
+  the measured gate position gives kg/s, which is scaled to kg/min and, with
+  the area covered per second, to kg/daa.
+*/
+bool FlowEstimator::update(float positionPercent, float flowCoeff, float areaPerSec, float dt) {
+    float rawKgPerSec = (flowCoeff > 0.0f && positionPercent > 0.0f) ? positionPercent / flowCoeff : 0.0f;
+    float rawKgPerMin = rawKgPerSec * Units::MINUTE_TO_SECOND;
+    float rawKgPerDaa = (areaPerSec > 0.0f) ? rawKgPerSec / areaPerSec * Units::SQUARE_METERS_PER_DAA : 0.0f;
+
+    // First order low-pass against ADC noise
+    float alpha = dt / (FILTER_TIME_CONSTANT_SEC + dt);
+    kgPerMin += alpha * (rawKgPerMin - kgPerMin);
+    kgPerDaa += alpha * (rawKgPerDaa - kgPerDaa);
+
+    sumKgPerMin += kgPerMin;
+    sumKgPerDaa += kgPerDaa;
+
+    if (++windowTicks < PUBLISH_DECIMATION) {
+        return false;
+    }
+
+    publishedKgPerMin = sumKgPerMin / windowTicks;
+    publishedKgPerDaa = sumKgPerDaa / windowTicks;
+    sumKgPerMin = 0.0f;
+    sumKgPerDaa = 0.0f;
+    windowTicks = 0;
+    return true;
+}
+
+void FlowEstimator::reset() {
+    kgPerMin = 0.0f;
+    kgPerDaa = 0.0f;
+    sumKgPerMin = 0.0f;
+    sumKgPerDaa = 0.0f;
+    windowTicks = 0;
+    publishedKgPerMin = 0.0f;
+    publishedKgPerDaa = 0.0f;
+}
@@ -0,0 +1,52 @@
+// ============================================
+// File: FlowEstimator.h
+// Purpose: Estimates actual flow from measured gate position
+// Part of: Control Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+#include "PIController.h"
+
+class DispenserChannel; // Forward declaration
+
+class FlowEstimator {
+    friend class DispenserChannel; // Allow DispenserChannel to access private members
+public:
+    static constexpr float FILTER_TIME_CONSTANT_SEC = 0.5f;
+    static constexpr int PUBLISH_DECIMATION = CONTROL_LOOP_UPDATE_FREQUENCY_HZ; // ticks per published sample (1 Hz)
+
+    FlowEstimator(const FlowEstimator&) = delete;
+    FlowEstimator& operator=(const FlowEstimator&) = delete;
+    FlowEstimator(FlowEstimator&&) = delete;
+    FlowEstimator& operator=(FlowEstimator&&) = delete;
+
+    // Returns true when a new decimated sample has been published
+    bool update(float positionPercent, float flowCoeff, float areaPerSec, float dt);
+    void reset();
+
+    // Filtered, at control rate
+    float getKgPerMin() const { return kgPerMin; }
+    float getKgPerDaa() const { return kgPerDaa; }
+
+    // Window averages, refreshed every PUBLISH_DECIMATION ticks
+    float getPublishedKgPerMin() const { return publishedKgPerMin; }
+    float getPublishedKgPerDaa() const { return publishedKgPerDaa; }
+
+private:
+    FlowEstimator() = default;
+
+    float kgPerMin = 0.0f;
+    float kgPerDaa = 0.0f;
+
+    float sumKgPerMin = 0.0f;
+    float sumKgPerDaa = 0.0f;
+    int windowTicks = 0;
+
+    float publishedKgPerMin = 0.0f;
+    float publishedKgPerDaa = 0.0f;
+};
@@ -0,0 +1,33 @@
+// ============================================
+// File: GatePlantModel.cpp
+// Purpose: Learned integrator model of the gate actuator (speed per unit duty)
+// Part of: Control Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include "GatePlantModel.h"
+#include <Arduino.h>
+
+void GatePlantModel::observe(float measured, int appliedSignal, float dt) {
+    if (hasLast && abs(lastSignal) >= DEADBAND_DUTY && dt > 0.0f) {
+        float rate = (measured - lastMeasured) / dt;
+
+        // Stalled, at an end stop or reversing: not a clean sample
+        if (fabsf(rate) >= MIN_OBSERVED_RATE && (rate > 0.0f) == (lastSignal > 0)) {
+            gain += GAIN_ALPHA * (rate / lastSignal - gain);
+        }
+    }
+
+    lastMeasured = measured;
+    lastSignal = appliedSignal;
+    hasLast = true;
+}
+
+float GatePlantModel::step(float position, int signal, float dt) const {
+    if (abs(signal) < DEADBAND_DUTY) {
+        return position;
+    }
+    return constrain(position + gain * signal * dt, 0.0f, 100.0f);
+}
@@ -0,0 +1,46 @@
+// ============================================
+// File: GatePlantModel.h
+// Purpose: Learned integrator model of the gate actuator (speed per unit duty)
+// Part of: Control Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+
+/*
+  The gate is a DC motor on a screw: with the load it sees, its speed is
+  close to proportional to duty once the duty clears static friction.
+  observe() learns that gain from the live loop (measured speed caused by
+  the duty applied one tick earlier); step() predicts one tick ahead.
+  Used by the shadow controller as its plant and by the MPC as its model.
+*/
+class GatePlantModel {
+public:
+    static constexpr int DEADBAND_DUTY = 10;          // below this duty the gate does not move
+    static constexpr float INITIAL_GAIN = 0.3f;       // %/s per duty, ~3 s full stroke at full duty
+    static constexpr float GAIN_ALPHA = 0.05f;        // EWMA weight of one gain observation
+    static constexpr float MIN_OBSERVED_RATE = 1.0f;  // %/s, slower motion is too noisy to learn from
+
+    GatePlantModel() = default;
+    GatePlantModel(const GatePlantModel&) = delete;
+    GatePlantModel& operator=(const GatePlantModel&) = delete;
+
+    // Control task: call once per tick with the new measurement and the duty applied this tick
+    void observe(float measured, int appliedSignal, float dt);
+    void restart() { hasLast = false; }
+
+    // Position after dt with a constant duty, clamped to the travel range
+    float step(float position, int signal, float dt) const;
+
+    float getGain() const { return gain; }
+
+private:
+    float gain = INITIAL_GAIN;
+    float lastMeasured = 0.0f;
+    int lastSignal = 0;
+    bool hasLast = false;
+};
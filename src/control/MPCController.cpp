@@ -0,0 +1,119 @@
+// ============================================
+// File: MPCController.cpp
+// Purpose: Horizon-limited model-predictive gate controller
+// Part of: Control Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include "MPCController.h"
+#include <Arduino.h>
+#include "io/VNH7070AS.h"
+
+float MPCController::compute(float setpoint, float measurement) {
+    setpoint = constrain(setpoint, 0.0f, 100.0f);
+    measurement = constrain(measurement, 0.0f, 100.0f);
+    error = setpoint - measurement;
+
+    // Explicit optimum: u = sum(c_j * (r_j - x0)) + moveWeight*uPrev over sum(c_j^2) + weights
+    float numerator = moveWeight * controlSignal;
+    float denominator = effortWeight + moveWeight;
+
+    for (int j = 1; j <= HORIZON_STEPS; ++j) {
+        float reference = setpoint + referenceRate * j * dt;
+        if (referenceRate > 0.0f && reference > referenceLimit) {
+            reference = referenceLimit;
+        } else if (referenceRate < 0.0f && reference < referenceLimit) {
+            reference = referenceLimit;
+        }
+        reference = constrain(reference, 0.0f, 100.0f);
+
+        float c = plantGain * j * dt;
+        numerator += c * (reference - measurement);
+        denominator += c * c;
+    }
+
+    float u = numerator / denominator;
+
+    // Last tick's push left the gate where it was: stiction is above the current breakaway duty
+    bool pushed = hasLastMeasurement && controlSignal != 0 && abs(controlSignal) >= breakawayDuty;
+    bool moved = fabsf(measurement - lastMeasurement) >= MIN_MOVE;
+    if (pushed && !moved) {
+        breakawayDuty = abs(controlSignal) + BREAKAWAY_STEP;
+        if (breakawayDuty > MAX_BREAKAWAY_DUTY) {
+            breakawayDuty = MAX_BREAKAWAY_DUTY;
+        }
+        movingTicks = 0;
+    } else if (pushed && ++movingTicks >= BREAKAWAY_DECAY_TICKS) {
+        // Sustained motion: probe lower; a stall on the next push raises it straight back
+        breakawayDuty -= BREAKAWAY_STEP;
+        if (breakawayDuty < GatePlantModel::DEADBAND_DUTY) {
+            breakawayDuty = GatePlantModel::DEADBAND_DUTY;
+        }
+        movingTicks = 0;
+    }
+    lastMeasurement = measurement;
+    hasLastMeasurement = true;
+
+    // Below breakaway the gate does not move: either push through it or hold
+    if (fabsf(u) < breakawayDuty) {
+        u = (fabsf(error) > HOLD_ERROR_BAND) ? (error > 0.0f ? breakawayDuty : -breakawayDuty) : 0.0f;
+    }
+
+    // Constraint interval, applied last so it bounds what is actually output: slew, duty limits,
+    // and the duty that would leave 0..100 % travel in one tick (rounded inwards)
+    int slewLow = controlSignal - MAX_DUTY_STEP;
+    int slewHigh = controlSignal + MAX_DUTY_STEP;
+    slewLow = slewLow > -VNH7070AS::MAX_DUTY ? slewLow : -VNH7070AS::MAX_DUTY;
+    slewHigh = slewHigh < VNH7070AS::MAX_DUTY ? slewHigh : VNH7070AS::MAX_DUTY;
+    int travelLow = static_cast<int>(ceilf(-measurement / (plantGain * dt)));
+    int travelHigh = static_cast<int>(floorf((100.0f - measurement) / (plantGain * dt)));
+    int lowest = slewLow > travelLow ? slewLow : travelLow;
+    int highest = slewHigh < travelHigh ? slewHigh : travelHigh;
+
+    // Empty only when slew and travel disagree, running into an end stop: brake at the slew limit
+    if (lowest > highest) {
+        lowest = highest = (travelHigh < slewLow) ? slewLow : slewHigh;
+    }
+
+    int signal = static_cast<int>(lroundf(u));
+    signal = signal < lowest ? lowest : (signal > highest ? highest : signal);
+
+    // A clamped push that no longer clears breakaway would not move the gate; hold instead.
+    // Only when holding is reachable: ramping down from a large duty, the slew limit wins.
+    if (signal != 0 && abs(signal) < breakawayDuty && lowest <= 0 && highest >= 0) {
+        signal = 0;
+    }
+
+    controlSignal = signal;
+    return static_cast<float>(controlSignal);
+}
+
+// breakawayDuty is learned and survives resets; sustained motion relaxes it instead
+void MPCController::reset() {
+    error = 0.0f;
+    controlSignal = 0;
+    referenceRate = 0.0f;
+    hasLastMeasurement = false;
+}
+
+void MPCController::reset(float measurement) {
+    reset();
+    lastMeasurement = constrain(measurement, 0.0f, 100.0f);
+}
+
+void MPCController::track(float measurement, int appliedSignal) {
+    reset(measurement);
+    controlSignal = appliedSignal;
+    lastSignal = appliedSignal; // the driver already runs at this duty
+}
+
+bool MPCController::isControlSignalChanged(void) {
+    if (lastSignal != controlSignal) {
+        lastSignal = controlSignal;
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,92 @@
+// ============================================
+// File: MPCController.h
+// Purpose: Horizon-limited model-predictive gate controller
+// Part of: Control Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+#include "PIController.h"
+#include "GatePlantModel.h"
+
+/*
+  Single-move MPC on the learned integrator model x[j] = x0 + b*u*j*dt.
+  Over HORIZON_STEPS ticks it minimises
+
+      sum_j (r[j] - x[j])^2 + effortWeight*u^2 + moveWeight*(u - uPrev)^2
+
+  where r[j] extrapolates the setpoint shaper's current ramp towards the
+  raw target, so the gate starts moving before the ramp arrives. With a
+  single decision variable the optimum is explicit (one division) and the
+  constraints are an interval on u: duty limits, duty slew, and the duty
+  that would leave 0..100 % travel in one tick.
+
+  The model has no integral action, so a real stiction threshold above
+  the modelled deadband would leave a steady offset. Small outputs are
+  therefore replaced by a breakaway duty that grows while the gate fails
+  to move. After a stretch of motion without a stall it is probed one step
+  lower, so a stiction peak (cold grease, a cleared jam) does not stay in
+  the output for good. The constraint interval is applied
+  after that substitution, so the output always respects it; a push the
+  interval cuts below breakaway becomes a hold. Breakaway is capped at the
+  slew step so it stays reachable from rest. Where the slew limit and the
+  travel limit cannot both hold (running into an end stop faster than the
+  slew allows taking back), the slew limit wins: it protects the gearbox,
+  the end stop only ends the travel.
+
+  Public interface mirrors PIController so DispenserChannel can switch
+  between them per channel.
+*/
+class MPCController {
+    friend class DispenserChannel; // Allow DispenserChannel to access private members
+public:
+    static constexpr int HORIZON_STEPS = CONTROL_LOOP_UPDATE_FREQUENCY_HZ; // 1 s look-ahead
+    static constexpr float DEFAULT_EFFORT_WEIGHT = 0.001f;
+    static constexpr float DEFAULT_MOVE_WEIGHT = 0.002f;
+    static constexpr int MAX_DUTY_STEP = 40;          // duty change per tick, spares the gearbox
+    static constexpr float HOLD_ERROR_BAND = 0.5f;    // %, inside this a sub-deadband duty is dropped
+    static constexpr int BREAKAWAY_STEP = 2;          // duty added per tick while a push does not move the gate
+    static constexpr int MAX_BREAKAWAY_DUTY = MAX_DUTY_STEP; // reachable from rest in one tick
+    static constexpr int BREAKAWAY_DECAY_TICKS = 3 * CONTROL_LOOP_UPDATE_FREQUENCY_HZ; // moving ticks per step down
+    static constexpr float MIN_MOVE = 0.05f;          // %, smaller change counts as not moving
+
+    MPCController(const MPCController&) = delete;
+    MPCController& operator=(const MPCController&) = delete;
+    MPCController(MPCController&&) = delete;
+    MPCController& operator=(MPCController&&) = delete;
+
+    // Reference trend for the next compute(): shaper rate (%/s) and the raw target it ramps to
+    void setReferenceTrend(float ratePerSec, float rawTarget) { referenceRate = ratePerSec; referenceLimit = rawTarget; }
+    void setPlantGain(float gain) { plantGain = gain > 0.0f ? gain : GatePlantModel::INITIAL_GAIN; }
+    void setWeights(float effort, float move) { effortWeight = effort; moveWeight = move; }
+
+    float getError(void) const { return error; }
+    bool isControlSignalChanged(void);
+    int getControlSignal(void) const { return controlSignal; }
+
+    float compute(float setpoint, float measurement);
+    void reset();
+    void reset(float measurement);
+    void track(float measurement, int appliedSignal); // slew and move weight start from the applied duty
+
+private:
+    MPCController() = default;
+
+    float dt = 1.0f / CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
+    float plantGain = GatePlantModel::INITIAL_GAIN;
+    float effortWeight = DEFAULT_EFFORT_WEIGHT;
+    float moveWeight = DEFAULT_MOVE_WEIGHT;
+    float referenceRate = 0.0f;
+    float referenceLimit = 0.0f;
+    float error = 0.0f;
+    float lastMeasurement = 0.0f;
+    bool hasLastMeasurement = false;
+    int breakawayDuty = GatePlantModel::DEADBAND_DUTY;
+    int movingTicks = 0; // pushed and moving since the last stall
+    int controlSignal = 0;
+    int lastSignal = 0;
+};
@@ -1,6 +1,6 @@
 // ============================================
 // File: PIController.cpp
-// Purpose: PI controller implementation for flow control
+// Purpose: PID controller implementation for flow control
 // Part of: Control Layer
 //
 // License: Proprietary License
@@ -10,20 +10,50 @@
 #include "PIController.h"
 #include "io/VNH7070AS.h"
 
-float PIController::compute(float setpoint, float measurement) {
-    setpoint = constrain(setpoint, 0.0f, 100.0f);
-    measurement = constrain(measurement, 0.0f, 100.0f);
-    float outputMin = -VNH7070AS::MAX_DUTY;
-    float outputMax = VNH7070AS::MAX_DUTY;
-    
+template <typename T>
+float PIControllerT<T>::compute(float setpoint, float measurement) {
+    return Num::toFloat(computeRaw(Num::fromFloat(setpoint), Num::fromFloat(measurement)));
+}
+
+template <typename T>
+T PIControllerT<T>::computeRaw(T setpoint, T measurement) {
+    const T ZERO = Num::fromInt(0);
+    const T HUNDRED = Num::fromInt(100);
+    const T outputMin = Num::fromInt(-VNH7070AS::MAX_DUTY);
+    const T outputMax = Num::fromInt(VNH7070AS::MAX_DUTY);
+
+    setpoint = constrain(setpoint, ZERO, HUNDRED);
+    measurement = constrain(measurement, ZERO, HUNDRED);
+
     error = setpoint - measurement;
 
     // Update integral
     _integral += error * dt;
+    clampIntegral();
 
-    // Anti-windup: clamp integral to output limits / Ki
-    if (_Ki != 0.0f) {
-        float value = _integral * _Ki;
+    // Derivative on measurement, low-pass filtered; first sample only seeds the state
+    if (hasLastMeasurement) {
+        T rate = (measurement - lastMeasurement) * Num::fromInt(CONTROL_LOOP_UPDATE_FREQUENCY_HZ);
+        _derivative += derivativeAlpha * (rate - _derivative);
+    }
+    lastMeasurement = measurement;
+    hasLastMeasurement = true;
+
+    controlSignal = _Kp * error + _Ki * _integral - _Kd * _derivative;
+    controlSignal = constrain(controlSignal, outputMin, outputMax);
+
+    return controlSignal;
+}
+
+// Anti-windup: clamp integral to output limits / Ki
+template <typename T>
+void PIControllerT<T>::clampIntegral() {
+    const T ZERO = Num::fromInt(0);
+    const T outputMin = Num::fromInt(-VNH7070AS::MAX_DUTY);
+    const T outputMax = Num::fromInt(VNH7070AS::MAX_DUTY);
+
+    if (_Ki != ZERO) {
+        T value = _integral * _Ki;
 
         if (value > outputMax) {
             _integral = outputMax / _Ki;
@@ -31,27 +61,89 @@ float PIController::compute(float setpoint, float measurement) {
             _integral = outputMin / _Ki;
         }
     }
+}
 
-    controlSignal = _Kp * error + _Ki * _integral;
-    controlSignal = constrain(controlSignal, outputMin, outputMax);
+// Move the integral so Ki * I absorbs a step in the proportional/derivative terms
+template <typename T>
+void PIControllerT<T>::rescaleIntegral(T outputDelta) {
+    if (_Ki != Num::fromInt(0)) {
+        _integral += outputDelta / _Ki;
+        clampIntegral();
+    }
+}
 
-    return controlSignal;
+template <typename T>
+void PIControllerT<T>::setPIKp(float value) {
+    T Kp = Num::fromFloat(value);
+    rescaleIntegral((_Kp - Kp) * error);
+    _Kp = Kp;
 }
 
-void PIController::reset() {
-    _integral = 0.0f;
-    error = 0.0f;
-    controlSignal = 0.0f;
+template <typename T>
+void PIControllerT<T>::setPIKi(float value) {
+    T Ki = Num::fromFloat(value);
+
+    // Keep Ki * I unchanged; with Ki = 0 the integral is kept for when it comes back
+    if (Ki != Num::fromInt(0)) {
+        _integral = (_integral * _Ki) / Ki;
+    }
+    _Ki = Ki;
+    clampIntegral();
 }
 
-bool PIController::isControlSignalChanged(void) {
-    static int oldSignal = 0;
-  
-    if (oldSignal != controlSignal) {
-      oldSignal = controlSignal;
+template <typename T>
+void PIControllerT<T>::setPIKd(float value) {
+    T Kd = Num::fromFloat(value);
+    rescaleIntegral((Kd - _Kd) * _derivative);
+    _Kd = Kd;
+}
+
+template <typename T>
+void PIControllerT<T>::reset() {
+    _integral = Num::fromInt(0);
+    error = Num::fromInt(0);
+    controlSignal = Num::fromInt(0);
+    _derivative = Num::fromInt(0);
+    lastMeasurement = Num::fromInt(0);
+    hasLastMeasurement = false;
+}
+
+template <typename T>
+void PIControllerT<T>::reset(float measurement) {
+    reset();
+    lastMeasurement = constrain(Num::fromFloat(measurement), Num::fromInt(0), Num::fromInt(100));
+    hasLastMeasurement = true;
+}
+
+// Next computeRaw() with the same inputs: Kp*e + Ki*(I + e*dt) = appliedSignal, derivative seeded at rest
+template <typename T>
+void PIControllerT<T>::track(float setpoint, float measurement, int appliedSignal) {
+    reset(measurement);
+
+    const T applied = Num::fromInt(appliedSignal);
+    const T e = constrain(Num::fromFloat(setpoint), Num::fromInt(0), Num::fromInt(100)) - lastMeasurement;
+    if (_Ki != Num::fromInt(0)) {
+        _integral = (applied - _Kp * e) / _Ki - e * dt;
+        clampIntegral();
+    }
+
+    // The driver already runs at this duty
+    controlSignal = applied;
+    lastSignal = appliedSignal;
+}
+
+template <typename T>
+bool PIControllerT<T>::isControlSignalChanged(void) {
+    int signal = getControlSignal();
+
+    if (lastSignal != signal) {
+      lastSignal = signal;
       return true;
     }
-  
+
     return false;
-  }
-  
\ No newline at end of file
+}
+
+// Both variants are always built so either can be selected without other changes
+template class PIControllerT<float>;
+template class PIControllerT<Q16_16>;
@@ -1,6 +1,6 @@
 // ============================================
 // File: PIController.h
-// Purpose: PI controller implementation for flow control
+// Purpose: PID controller implementation for flow control
 // Part of: Control Layer
 //
 // License: Proprietary License
@@ -11,35 +11,133 @@
 
 #include <stdint.h>
 #include "core/SystemPreferences.h"
+#include "core/FixedPoint.h"
+#include "core/SeqLock.h"
 
 class DispenserChannel; // Forward declaration
 
 constexpr int CONTROL_LOOP_UPDATE_FREQUENCY_HZ = 10; // Control loop frequency in Hz
 
-class PIController {
+// Conversions between the public float interface and the internal number type
+template <typename T> struct PINumeric;
+
+template <> struct PINumeric<float> {
+    static float fromInt(int v) { return static_cast<float>(v); }
+    static float fromFloat(float v) { return v; }
+    static float toFloat(float v) { return v; }
+    static int toInt(float v) { return static_cast<int>(v); }
+};
+
+template <int FRAC_BITS> struct PINumeric<Fixed<FRAC_BITS> > {
+    static Fixed<FRAC_BITS> fromInt(int v) { return Fixed<FRAC_BITS>::fromInt(v); }
+    static Fixed<FRAC_BITS> fromFloat(float v) { return Fixed<FRAC_BITS>::fromFloat(v); }
+    static float toFloat(Fixed<FRAC_BITS> v) { return v.toFloat(); }
+    static int toInt(Fixed<FRAC_BITS> v) { return v.toInt(); }
+};
+
+// One gain set, so a change made from another task is applied as a whole
+struct PIGains {
+    float kp;
+    float ki;
+    float kd;
+};
+
+/*
+  Gains written by the BLE task and picked up by the control task at the
+  start of a tick. The rescale in the setters is a read-modify-write of the
+  integral, so it must never interleave with compute().
+*/
+class PIGainRequest {
+public:
+    // Any task; the latest request wins
+    inline void write(const PIGains& gains) { requested.write(gains); }
+    inline PIGains read() const { return requested.read(); }
+
+    // Control task: true, with the gains, when a request arrived since the last call
+    bool take(PIGains& gains) {
+        uint32_t sequence = requested.getSequence();
+        if (sequence == takenSequence) {
+            return false;
+        }
+        gains = requested.read(); // a newer write meanwhile is taken again next tick
+        takenSequence = sequence;
+        return true;
+    }
+
+private:
+    SeqLock<PIGains> requested;
+    uint32_t takenSequence = 0;
+};
+
+/*
+  T is float or a Fixed<> Q-format type. The arithmetic in compute() is
+  written once for both, so the fixed-point build follows the float one
+  step for step (same clamping order, same anti-windup), differing only
+  by quantization. Gains and I/O stay float at the interface; the hot path
+  computeRaw() needs no FPU when T is fixed-point.
+
+  The derivative acts on the filtered measurement, not the error, so
+  setpoint steps do not kick the output. Gain changes rescale the integral
+  so the output stays continuous. reset(measurement) starts from a closed
+  gate with no history; track() takes over a running gate instead, with
+  the integral back-calculated so the first output is the duty already
+  applied.
+*/
+template <typename T>
+class PIControllerT {
     friend class DispenserChannel; // Allow DispenserChannel to access private members
+    friend class ShadowController; // Owns the candidate instance
 public:
-    PIController(const PIController&) = delete;
-    PIController& operator=(const PIController&) = delete;
-    PIController(PIController&&) = delete;
-    PIController& operator=(PIController&&) = delete;
-
-    const float getPIKp(void) const {return _Kp; }
-    const float getPIKi(void) const {return _Ki; }
-    void setPIKp(float value) { _Kp = value; }
-    void setPIKi(float value) { _Ki = value; }
-    void setPIParams(float Kp, float Ki) { _Kp = Kp; _Ki = Ki; }
-    float getError(void) const { return error; }
+    typedef PINumeric<T> Num;
+
+    PIControllerT(const PIControllerT&) = delete;
+    PIControllerT& operator=(const PIControllerT&) = delete;
+    PIControllerT(PIControllerT&&) = delete;
+    PIControllerT& operator=(PIControllerT&&) = delete;
+
+    float getPIKp(void) const {return Num::toFloat(_Kp); }
+    float getPIKi(void) const {return Num::toFloat(_Ki); }
+    float getPIKd(void) const {return Num::toFloat(_Kd); }
+    void setPIKp(float value);
+    void setPIKi(float value);
+    void setPIKd(float value);
+    void setPIParams(float Kp, float Ki) { setPIKp(Kp); setPIKi(Ki); }
+    PIGains getGains() const { PIGains gains = { getPIKp(), getPIKi(), getPIKd() }; return gains; }
+    void setGains(const PIGains& gains) { setPIParams(gains.kp, gains.ki); setPIKd(gains.kd); }
+    float getError(void) const { return Num::toFloat(error); }
+    float getIntegral(void) const { return Num::toFloat(_integral); }
+    float getDerivative(void) const { return Num::toFloat(_derivative); }
     bool isControlSignalChanged(void);
-    const int getControlSignal(void) const {return controlSignal; }
+    int getControlSignal(void) const {return Num::toInt(controlSignal); }
 
-    void setParams(float Kp, float Ki) {_Kp = Kp; _Ki = Ki; }
+    void setParams(float Kp, float Ki) { setPIParams(Kp, Ki); }
     float compute(float setpoint, float measurement);
-    void reset(); // Reset integral term
+    T computeRaw(T setpoint, T measurement);
+    void reset(); // Reset integral and derivative state
+    void reset(float measurement); // Same, with the derivative seeded at the current position
+    void track(float setpoint, float measurement, int appliedSignal); // Bumpless takeover at appliedSignal
 private:
-    PIController(float Kp = DEFAULT_KP_VALUE, float Ki = DEFAULT_KI_VALUE)
-    : _Kp(Kp), _Ki(Ki), _integral(0.0f) { reset(); }
+    // First-order filter on the measured rate; 2 control periods keeps pot noise out of Kd
+    static constexpr float DERIVATIVE_FILTER_TAU_SEC = 0.2f;
+
+    PIControllerT(float Kp = DEFAULT_KP_VALUE, float Ki = DEFAULT_KI_VALUE, float Kd = DEFAULT_KD_VALUE)
+    : _Kp(Num::fromFloat(Kp)), _Ki(Num::fromFloat(Ki)), _Kd(Num::fromFloat(Kd)), _integral() { reset(); }
 
-    float dt = 1.0f / CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
-    float _Kp, _Ki, controlSignal, error, _integral;
+    void rescaleIntegral(T outputDelta);
+    void clampIntegral();
+
+    T dt = Num::fromFloat(1.0f / CONTROL_LOOP_UPDATE_FREQUENCY_HZ);
+    T derivativeAlpha = Num::fromFloat((1.0f / CONTROL_LOOP_UPDATE_FREQUENCY_HZ) /
+                                       (DERIVATIVE_FILTER_TAU_SEC + 1.0f / CONTROL_LOOP_UPDATE_FREQUENCY_HZ));
+    T _Kp, _Ki, _Kd, controlSignal, error, _integral;
+    T _derivative, lastMeasurement;
+    bool hasLastMeasurement = false;
+    int lastSignal = 0; // per instance, so channels do not mask each other's changes
 };
+
+// Build with -D PI_CONTROLLER_FIXED_POINT to run the loop in Q16.16
+#ifdef PI_CONTROLLER_FIXED_POINT
+typedef PIControllerT<Q16_16> PIController;
+#else
+typedef PIControllerT<float> PIController;
+#endif
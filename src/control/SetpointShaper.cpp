@@ -0,0 +1,90 @@
+// ============================================
+// File: SetpointShaper.cpp
+// Purpose: Rate/acceleration limited ramping of gate position targets
+// Part of: Control Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include "SetpointShaper.h"
+#include <Arduino.h>
+
+void SetpointShaper::setProfile(RampProfile newProfile) {
+    switch (newProfile) {
+        case RampProfile::Off:
+            maxRate = 0.0f;
+            maxAccel = 0.0f;
+            break;
+        case RampProfile::Fast:
+            maxRate = FAST_MAX_RATE;
+            maxAccel = FAST_MAX_ACCEL;
+            break;
+        case RampProfile::Gentle:
+            maxRate = GENTLE_MAX_RATE;
+            maxAccel = GENTLE_MAX_ACCEL;
+            break;
+        case RampProfile::Custom:
+            break; // keep current limits
+        default:
+            return;
+    }
+    profile = newProfile;
+}
+
+void SetpointShaper::setLimits(float newMaxRate, float newMaxAccel) {
+    maxRate = (newMaxRate > 0.0f) ? newMaxRate : 0.0f;
+    maxAccel = (newMaxAccel > 0.0f) ? newMaxAccel : 0.0f;
+    profile = RampProfile::Custom;
+}
+
+void SetpointShaper::reset(float value) {
+    output = value;
+    rate = 0.0f;
+}
+
+float SetpointShaper::update(float rawTarget, float dt) {
+    if (profile == RampProfile::Off || maxRate <= 0.0f || dt <= 0.0f) {
+        reset(rawTarget);
+        return output;
+    }
+
+    float remaining = rawTarget - output;
+    float desiredRate = remaining / dt;   // rate that would land on target this tick
+
+    if (maxAccel > 0.0f) {
+        // Braking curve: never move faster than we can stop within the remaining distance
+        float brakingRate = sqrtf(2.0f * maxAccel * fabsf(remaining));
+        desiredRate = constrain(desiredRate, -brakingRate, brakingRate);
+    }
+
+    desiredRate = constrain(desiredRate, -maxRate, maxRate);
+
+    if (maxAccel > 0.0f) {
+        float maxStep = maxAccel * dt;
+        rate += constrain(desiredRate - rate, -maxStep, maxStep);
+    } else {
+        rate = desiredRate;
+    }
+
+    float step = rate * dt;
+    // Land exactly on the target instead of dithering around it
+    if ((remaining >= 0.0f && step >= remaining) || (remaining <= 0.0f && step <= remaining)) {
+        output = rawTarget;
+        rate = 0.0f;
+    } else {
+        output += step;
+    }
+
+    return output;
+}
+
+const char* SetpointShaper::profileToString(RampProfile profile) {
+    switch (profile) {
+        case RampProfile::Off:    return "Off";
+        case RampProfile::Fast:   return "Fast";
+        case RampProfile::Gentle: return "Gentle";
+        case RampProfile::Custom: return "Custom";
+        default:                  return "Unknown";
+    }
+}
@@ -0,0 +1,58 @@
+// ============================================
+// File: SetpointShaper.h
+// Purpose: Rate/acceleration limited ramping of gate position targets
+// Part of: Control Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+
+class DispenserChannel; // Forward declaration
+
+enum class RampProfile : uint8_t {
+    Off = 0,    // step targets passed through unchanged
+    Fast,       // slew-limited only
+    Gentle,     // slew and acceleration limited (S-shaped ramps)
+    Custom      // user supplied limits
+};
+
+class SetpointShaper {
+    friend class DispenserChannel; // Allow DispenserChannel to access private members
+public:
+    // Profile presets, all in % of gate travel
+    static constexpr float FAST_MAX_RATE = 50.0f;     // %/s
+    static constexpr float FAST_MAX_ACCEL = 0.0f;     // %/s², 0 = unlimited
+    static constexpr float GENTLE_MAX_RATE = 15.0f;   // %/s
+    static constexpr float GENTLE_MAX_ACCEL = 20.0f;  // %/s²
+
+    SetpointShaper(const SetpointShaper&) = delete;
+    SetpointShaper& operator=(const SetpointShaper&) = delete;
+    SetpointShaper(SetpointShaper&&) = delete;
+    SetpointShaper& operator=(SetpointShaper&&) = delete;
+
+    void setProfile(RampProfile profile);
+    void setLimits(float maxRate, float maxAccel); // switches to RampProfile::Custom
+    RampProfile getProfile() const { return profile; }
+    float getMaxRate() const { return maxRate; }
+    float getMaxAccel() const { return maxAccel; }
+
+    void reset(float value);
+    float update(float rawTarget, float dt);
+    float getOutput() const { return output; }
+    float getRate() const { return rate; }
+
+    static const char* profileToString(RampProfile profile);
+
+private:
+    SetpointShaper() { setProfile(RampProfile::Fast); }
+
+    RampProfile profile = RampProfile::Fast;
+    float maxRate = FAST_MAX_RATE;
+    float maxAccel = FAST_MAX_ACCEL;
+    float output = 0.0f;
+    float rate = 0.0f;
+};
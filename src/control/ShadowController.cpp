@@ -0,0 +1,116 @@
+// ============================================
+// File: ShadowController.cpp
+// Purpose: Runs a candidate controller alongside the active one for A/B comparison
+// Part of: Control Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include "ShadowController.h"
+#include <Arduino.h>
+
+void ShadowController::setEnabled(bool enable, const PIGains& active) {
+    if (enable && !enabled) {
+        // Start from the active tuning; the candidate gains are set afterwards
+        requestGains(active);
+    }
+    enabled = enable;
+}
+
+void ShadowController::applyRequests() {
+    PIGains gains;
+    if (gainRequest.take(gains)) {
+        controller.setGains(gains);
+        resetStats();
+    }
+}
+
+void ShadowController::setActiveGains(const PIGains& gains) {
+    reference.setGains(gains);
+    resetStats();
+}
+
+void ShadowController::resync(float measured) {
+    simPosition = constrain(measured, 0.0f, 100.0f);
+    referencePosition = simPosition;
+    controller.reset(simPosition);
+    reference.reset(referencePosition);
+    activeSettle.tracking = false;
+    shadowSettle.tracking = false;
+    stepReference = -1.0f; // the first active target arms a fresh step reference
+}
+
+void ShadowController::resetStats() {
+    activeIae = 0.0f;
+    shadowIae = 0.0f;
+    activeTravel = 0.0f;
+    shadowTravel = 0.0f;
+    compareTicks = 0;
+    activeSettle.clear();
+    shadowSettle.clear();
+}
+
+bool ShadowController::isProvenBetter() const {
+    return getCompareSeconds() >= MIN_COMPARE_SEC && shadowIae < activeIae &&
+           shadowSettle.peakOvershoot <= activeSettle.peakOvershoot && shadowTravel <= activeTravel;
+}
+
+void ShadowController::update(float rawTarget, float target, const GatePlantModel& plant, bool accumulate) {
+    const float dt = 1.0f / CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
+
+    // Advance both models with the duty each loop commanded last tick
+    float simBefore = simPosition;
+    float referenceBefore = referencePosition;
+    simPosition = plant.step(simPosition, controller.getControlSignal(), dt);
+    referencePosition = plant.step(referencePosition, reference.getControlSignal(), dt);
+    controller.compute(target, simPosition);
+    reference.compute(target, referencePosition);
+
+    if (!accumulate) {
+        return;
+    }
+
+    if (stepReference < 0.0f || fabsf(rawTarget - stepReference) >= STEP_THRESHOLD) {
+        if (stepReference >= 0.0f) {
+            float direction = rawTarget > stepReference ? 1.0f : -1.0f;
+            activeSettle.start(direction);
+            shadowSettle.start(direction);
+        }
+        stepReference = rawTarget;
+    }
+
+    activeSettle.update(rawTarget - referencePosition);
+    shadowSettle.update(rawTarget - simPosition);
+
+    activeIae += fabsf(target - referencePosition) * dt;
+    shadowIae += fabsf(target - simPosition) * dt;
+    activeTravel += fabsf(referencePosition - referenceBefore);
+    shadowTravel += fabsf(simPosition - simBefore);
+    compareTicks++;
+}
+
+void ShadowController::SettlingTracker::update(float error) {
+    if (!tracking) {
+        return;
+    }
+
+    ticks++;
+    inBand = (fabsf(error) <= SETTLE_BAND) ? inBand + 1 : 0;
+
+    // error is target - position, so past the target it has the opposite sign of the step
+    float overshoot = -direction * error;
+    if (overshoot > peakOvershoot) {
+        peakOvershoot = overshoot;
+    }
+
+    if (inBand >= SETTLE_HOLD_TICKS) {
+        sumSec += static_cast<float>(ticks - inBand) / CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
+        count++;
+        tracking = false;
+    } else if (ticks >= SETTLE_TIMEOUT_TICKS) {
+        sumSec += static_cast<float>(ticks) / CONTROL_LOOP_UPDATE_FREQUENCY_HZ; // never settled: count the full window
+        count++;
+        tracking = false;
+    }
+}
@@ -0,0 +1,116 @@
+// ============================================
+// File: ShadowController.h
+// Purpose: Runs a candidate controller alongside the active one for A/B comparison
+// Part of: Control Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+#include "PIController.h"
+#include "GatePlantModel.h"
+
+/*
+  The shadow controller sees the same shaped target every tick but its
+  output never reaches the motor. Because it cannot move the real gate, it
+  drives the channel's GatePlantModel instead, whose gain is learned from
+  the active loop. So that the comparison is fair, the active gains are
+  scored on the same model too: a reference copy of the active PI drives
+  a second simulated gate. IAE and settling time after each target step
+  are therefore model against model. Scoring the real gate would hand the
+  candidate an advantage for free, since the model has no noise, lag or
+  stiction. Both simulated gates are resynced to the measured position
+  whenever the task state changes.
+
+  The reference is a PI loop, so the comparison only means something while
+  the channel runs PI: it is not updated under MPC, and the BLE side
+  refuses shadow mode and promotion there. A promotion also needs the
+  candidate's peak overshoot and gate travel to be no worse; a lower IAE
+  bought with overshoot or a chattering actuator is not an improvement.
+*/
+class ShadowController {
+    friend class DispenserChannel; // Allow DispenserChannel to access private members
+public:
+    static constexpr float STEP_THRESHOLD = 2.0f;        // % target change that starts a settling measurement
+    static constexpr float SETTLE_BAND = 2.0f;           // % error band counted as settled
+    static constexpr uint16_t SETTLE_HOLD_TICKS = CONTROL_LOOP_UPDATE_FREQUENCY_HZ; // must stay in band for 1 s
+    static constexpr uint16_t SETTLE_TIMEOUT_TICKS = 30 * CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
+    static constexpr float MIN_COMPARE_SEC = 60.0f;      // active time before a promotion is allowed
+
+    ShadowController(const ShadowController&) = delete;
+    ShadowController& operator=(const ShadowController&) = delete;
+    ShadowController(ShadowController&&) = delete;
+    ShadowController& operator=(ShadowController&&) = delete;
+
+    bool isEnabled() const { return enabled; }
+    void setEnabled(bool enable, const PIGains& active); // any task; starts from the active gains
+
+    // Any task: candidate gains are staged and applied by applyRequests(), which also restarts the scores
+    inline void requestGains(const PIGains& gains) { gainRequest.write(gains); }
+    inline PIGains getRequestedGains() const { return gainRequest.read(); }
+    const PIController& getController() const { return controller; }
+
+    // Control task, before update()
+    void applyRequests();
+    void setActiveGains(const PIGains& gains); // the reference copy follows the active loop
+
+    // Control task: one tick of both simulated loops; accumulate scores only while the task is active.
+    // Settling is judged against the raw (unshaped) target, IAE against the shaped one.
+    void update(float rawTarget, float target, const GatePlantModel& plant, bool accumulate);
+    void resync(float measured);
+    void resetStats();
+
+    bool isProvenBetter() const;
+    float getCompareSeconds() const { return compareTicks / static_cast<float>(CONTROL_LOOP_UPDATE_FREQUENCY_HZ); }
+    float getActiveIAE() const { return activeIae; }
+    float getShadowIAE() const { return shadowIae; }
+    float getActiveSettleSec() const { return activeSettle.getMeanSeconds(); }
+    float getShadowSettleSec() const { return shadowSettle.getMeanSeconds(); }
+    float getActiveOvershoot() const { return activeSettle.peakOvershoot; }
+    float getShadowOvershoot() const { return shadowSettle.peakOvershoot; }
+    float getActiveTravel() const { return activeTravel; }
+    float getShadowTravel() const { return shadowTravel; }
+    float getSimulatedPosition() const { return simPosition; }
+    float getReferencePosition() const { return referencePosition; }
+    int getShadowSignal() const { return controller.getControlSignal(); }
+
+private:
+    // Ticks from a target step until the error stays inside SETTLE_BAND for SETTLE_HOLD_TICKS,
+    // and the largest excursion past the target in the step's direction
+    struct SettlingTracker {
+        bool tracking = false;
+        uint16_t ticks = 0;
+        uint16_t inBand = 0;
+        uint32_t count = 0;
+        float sumSec = 0.0f;
+        float direction = 0.0f;      // +1 for a step up, -1 for a step down
+        float peakOvershoot = 0.0f;  // %, over the comparison
+
+        void start(float stepDirection) { tracking = true; ticks = 0; inBand = 0; direction = stepDirection; }
+        void update(float error);
+        void clear() { tracking = false; count = 0; sumSec = 0.0f; peakOvershoot = 0.0f; }
+        float getMeanSeconds() const { return count ? sumSec / count : 0.0f; }
+    };
+
+    ShadowController() = default;
+
+    PIController controller;   // candidate gains
+    PIController reference;    // active gains, same model
+    PIGainRequest gainRequest;
+    volatile bool enabled = false;
+
+    float simPosition = 0.0f;        // gate driven by the candidate, %
+    float referencePosition = 0.0f;  // gate driven by the reference, %
+
+    float stepReference = -1.0f; // raw target at the last step, negative until armed
+    SettlingTracker activeSettle;
+    SettlingTracker shadowSettle;
+    float activeIae = 0.0f;  // %·s, reference loop on the model
+    float shadowIae = 0.0f;  // %·s, candidate loop on the model
+    float activeTravel = 0.0f;  // %, summed gate movement of the reference loop
+    float shadowTravel = 0.0f;  // %, summed gate movement of the candidate loop
+    uint32_t compareTicks = 0;
+};
@@ -0,0 +1,150 @@
+// ============================================
+// File: StepResponseCapture.cpp
+// Purpose: Records closed-loop response at control rate for PI tuning
+// Part of: Control Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include "StepResponseCapture.h"
+#include <string.h>
+#include <math.h>
+
+bool StepResponseCapture::arm(uint8_t newChannel, uint16_t seconds) {
+    if (seconds == 0 || seconds > MAX_CAPTURE_SECONDS) {
+        return false;
+    }
+
+    CaptureRequest armed = { newChannel, seconds };
+    request.write(armed);
+    return true;
+}
+
+void StepResponseCapture::trigger() {
+    if (state == CaptureState::Armed) {
+        manualTrigger = true;
+    }
+}
+
+void StepResponseCapture::cancel() {
+    CaptureRequest cancelled = { 0, 0 };
+    request.write(cancelled);
+}
+
+void StepResponseCapture::applyRequest() {
+    uint32_t sequence = request.getSequence();
+    if (sequence == takenSequence || (sequence & 1u)) {
+        return; // nothing new, or a write still in progress: take it next tick
+    }
+    CaptureRequest staged = request.read();
+    if (request.getSequence() != sequence) {
+        return; // overwritten while reading: take the newer one next tick, once
+    }
+    takenSequence = sequence;
+
+    if (staged.seconds == 0) {
+        state = CaptureState::Idle;
+        return;
+    }
+
+    channel = staged.channel;
+    head = 0;
+    count = 0;
+    postSamples = static_cast<size_t>(staged.seconds) * CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
+    postRemaining = postSamples;
+    manualTrigger = false;
+    hasLast = false;
+    state = CaptureState::Armed;
+}
+
+void StepResponseCapture::record(const CaptureSample& sample, float rawTarget, uint8_t taskState) {
+    if (state == CaptureState::Armed) {
+        bool stepped = hasLast && fabsf(rawTarget - lastRawTarget) >= STEP_TRIGGER_THRESHOLD;
+        bool stateChanged = hasLast && taskState != lastTaskState;
+
+        lastRawTarget = rawTarget;
+        lastTaskState = taskState;
+        hasLast = true;
+
+        // Keep only the pre-trigger window while waiting
+        if (count >= PRE_TRIGGER_SAMPLES) {
+            count = PRE_TRIGGER_SAMPLES - 1;
+        }
+        push(sample);
+
+        if (stepped || stateChanged || manualTrigger) {
+            state = CaptureState::Triggered;
+        }
+        return;
+    }
+
+    if (state == CaptureState::Triggered) {
+        push(sample);
+        if (--postRemaining == 0) {
+            state = CaptureState::Complete;
+        }
+    }
+}
+
+void StepResponseCapture::push(const CaptureSample& sample) {
+    samples[head] = sample;
+    head = (head + 1) % CAPACITY;
+    if (count < CAPACITY) count++;
+}
+
+size_t StepResponseCapture::getChunkCount(size_t chunkPayload) const {
+    size_t perChunk = (chunkPayload - CHUNK_HEADER_SIZE) / sizeof(CaptureSample);
+    size_t total = getSampleCount();
+    return (total + perChunk - 1) / perChunk;
+}
+
+/*
+  Chunk header (little endian):
+    [0] magic 'C'  [1] channel  [2..3] chunk index  [4..5] chunk count
+    [6] samples in this chunk  [7] reserved
+  Samples are emitted oldest first.
+*/
+size_t StepResponseCapture::readChunk(size_t index, uint8_t* out, size_t outSize) const {
+    if (state != CaptureState::Complete || outSize <= CHUNK_HEADER_SIZE) {
+        return 0;
+    }
+
+    size_t perChunk = (outSize - CHUNK_HEADER_SIZE) / sizeof(CaptureSample);
+    size_t chunks = getChunkCount(outSize);
+    if (perChunk == 0 || index >= chunks) {
+        return 0;
+    }
+
+    size_t first = index * perChunk;
+    size_t n = count - first;
+    if (n > perChunk) n = perChunk;
+
+    out[0] = CHUNK_MAGIC;
+    out[1] = channel;
+    out[2] = index & 0xFF;
+    out[3] = (index >> 8) & 0xFF;
+    out[4] = chunks & 0xFF;
+    out[5] = (chunks >> 8) & 0xFF;
+    out[6] = static_cast<uint8_t>(n);
+    out[7] = 0;
+
+    size_t oldest = (head + CAPACITY - count) % CAPACITY;
+    uint8_t* dst = out + CHUNK_HEADER_SIZE;
+    for (size_t i = 0; i < n; ++i) {
+        memcpy(dst, &samples[(oldest + first + i) % CAPACITY], sizeof(CaptureSample));
+        dst += sizeof(CaptureSample);
+    }
+
+    return CHUNK_HEADER_SIZE + n * sizeof(CaptureSample);
+}
+
+const char* StepResponseCapture::stateToString(CaptureState state) {
+    switch (state) {
+        case CaptureState::Idle:      return "Idle";
+        case CaptureState::Armed:     return "Armed";
+        case CaptureState::Triggered: return "Triggered";
+        case CaptureState::Complete:  return "Complete";
+        default:                      return "Unknown";
+    }
+}
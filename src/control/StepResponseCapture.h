@@ -0,0 +1,98 @@
+// ============================================
+// File: StepResponseCapture.h
+// Purpose: Records closed-loop response at control rate for PI tuning
+// Part of: Control Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "PIController.h"
+#include "core/SeqLock.h"
+
+class SystemContext; // Forward declaration
+
+enum class CaptureState : uint8_t {
+    Idle = 0,
+    Armed,      // pre-trigger ring running, waiting for a step or state change
+    Triggered,  // recording post-trigger samples
+    Complete    // frozen, ready for download
+};
+
+// One control tick, fixed point to keep the buffer small
+struct __attribute__((packed)) CaptureSample {
+    int16_t target;     // shaped target, % × 100
+    int16_t measured;   // gate position, % × 100
+    int16_t error;      // PI error, % × 100
+    int16_t integral;   // PI integral state × 100
+    int8_t control;     // motor duty, -100..100
+    uint8_t taskState;  // UserTaskState
+    uint16_t current;   // motor current, mA
+};
+
+class StepResponseCapture {
+    friend class SystemContext; // Allow SystemContext to access private members
+public:
+    static constexpr size_t MAX_CAPTURE_SECONDS = 20;
+    static constexpr size_t PRE_TRIGGER_SAMPLES = CONTROL_LOOP_UPDATE_FREQUENCY_HZ; // 1 s before the trigger
+    static constexpr size_t CAPACITY = PRE_TRIGGER_SAMPLES + MAX_CAPTURE_SECONDS * CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
+    static constexpr float STEP_TRIGGER_THRESHOLD = 2.0f; // % raw target change within one tick
+
+    // Binary chunk layout: header followed by packed CaptureSample records
+    static constexpr uint8_t CHUNK_MAGIC = 'C';
+    static constexpr size_t CHUNK_HEADER_SIZE = 8;
+
+    StepResponseCapture(const StepResponseCapture&) = delete;
+    StepResponseCapture& operator=(const StepResponseCapture&) = delete;
+    StepResponseCapture(StepResponseCapture&&) = delete;
+    StepResponseCapture& operator=(StepResponseCapture&&) = delete;
+
+    // BLE task: arm and cancel are staged and take effect at the next control tick
+    bool arm(uint8_t channel, uint16_t seconds);
+    void trigger();
+    void cancel();
+
+    // Control tick side: no allocation, a few stores per tick
+    void applyRequest(); // every tick, before isRecording()
+    inline bool isRecording() const { return state == CaptureState::Armed || state == CaptureState::Triggered; }
+    inline uint8_t getChannel() const { return channel; }
+    void record(const CaptureSample& sample, float rawTarget, uint8_t taskState);
+
+    CaptureState getState() const { return state; }
+    size_t getSampleCount() const { return state == CaptureState::Complete ? count : 0; }
+    size_t getChunkCount(size_t chunkPayload) const;
+    size_t readChunk(size_t index, uint8_t* out, size_t outSize) const;
+
+    static const char* stateToString(CaptureState state);
+
+private:
+    StepResponseCapture() = default;
+
+    // Latest arm/cancel from the BLE task; the ring itself is only touched by the control task
+    struct CaptureRequest {
+        uint8_t channel;
+        uint16_t seconds; // 0 cancels
+    };
+
+    void push(const CaptureSample& sample);
+
+    SeqLock<CaptureRequest> request;
+    uint32_t takenSequence = 0;
+
+    CaptureSample samples[CAPACITY];
+    volatile CaptureState state = CaptureState::Idle;
+    uint8_t channel = 0;
+    size_t head = 0;          // next write position
+    size_t count = 0;         // valid samples in the ring
+    size_t postRemaining = 0; // samples still to record after the trigger
+    size_t postSamples = 0;
+    volatile bool manualTrigger = false;
+
+    float lastRawTarget = 0.0f;
+    uint8_t lastTaskState = 0;
+    bool hasLast = false;
+};
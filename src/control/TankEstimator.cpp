@@ -0,0 +1,67 @@
+// ============================================
+// File: TankEstimator.cpp
+// Purpose: Predicts time and area to an empty tank from the smoothed consumption rate
+// Part of: Control Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include "TankEstimator.h"
+#include "core/Constants.h"
+
+void TankEstimator::update(float level, double areaM2, bool dispensing, uint32_t nowMs) {
+    levelKg = level;
+
+    if (restartRequested) {
+        restartRequested = false;
+        hasPrev = false;
+    }
+
+    if (hasPrev && dispensing) {
+        uint32_t elapsedMs = nowMs - prevMs;
+        float usedKg = prevLevelKg - level;
+        double coveredM2 = areaM2 - prevAreaM2;
+
+        if (elapsedMs > 0 && elapsedMs <= MAX_SAMPLE_GAP_MS && usedKg >= 0.0f && coveredM2 >= 0.0) {
+            float dt = elapsedMs / 1000.0f;
+            float kgRate = usedKg / dt;
+            float m2Rate = static_cast<float>(coveredM2 / dt);
+
+            if (!hasRate) {
+                kgPerSec = kgRate;
+                m2PerSec = m2Rate;
+                hasRate = true;
+            } else {
+                float alpha = dt / (RATE_TIME_CONSTANT_SEC + dt);
+                kgPerSec += alpha * (kgRate - kgPerSec);
+                m2PerSec += alpha * (m2Rate - m2PerSec);
+            }
+        }
+    }
+
+    prevLevelKg = level;
+    prevAreaM2 = areaM2;
+    prevMs = nowMs;
+    hasPrev = true;
+
+    if (level <= 0.0f) {
+        minutesToEmpty = 0.0f;
+        hectaresToEmpty = 0.0f;
+    } else if (hasRate && kgPerSec >= MIN_RATE_KG_PER_SEC) {
+        float secondsToEmpty = level / kgPerSec;
+        minutesToEmpty = secondsToEmpty / Units::MINUTE_TO_SECOND;
+        hectaresToEmpty = secondsToEmpty * m2PerSec / Units::SQUARE_METERS_PER_HECTARE;
+    } else {
+        minutesToEmpty = -1.0f;
+        hectaresToEmpty = -1.0f;
+    }
+
+    if (warningMinutes <= 0.0f || minutesToEmpty < 0.0f) {
+        lowWarning = false;
+    } else if (minutesToEmpty < warningMinutes) {
+        lowWarning = true;
+    } else if (minutesToEmpty > warningMinutes * WARNING_HYSTERESIS) {
+        lowWarning = false;
+    }
+}
@@ -0,0 +1,74 @@
+// ============================================
+// File: TankEstimator.h
+// Purpose: Predicts time and area to an empty tank from the smoothed consumption rate
+// Part of: Control Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+
+/*
+  Updated once per second from the 1 Hz task loop. The tank level and the
+  summed area of all sections are differenced against the previous call,
+  and both rates are smoothed with an exponentially weighted average over
+  RATE_TIME_CONSTANT_SEC. Rates only move while a section is dispensing,
+  so headland turns and pauses keep the last prediction instead of
+  stretching it to infinity. A level increase (refill) or an area reset
+  (new job) just skips that sample.
+
+  The low-tank warning fires when the predicted time to empty drops below
+  the configured minutes and clears with some hysteresis or on refill.
+*/
+class TankEstimator {
+    friend class SystemContext; // Allow SystemContext to access private members
+public:
+    static constexpr float RATE_TIME_CONSTANT_SEC = 60.0f;
+    static constexpr float MIN_RATE_KG_PER_SEC = 0.0005f;   // below this there is no prediction
+    static constexpr float WARNING_HYSTERESIS = 1.2f;       // clear at 120 % of the warning time
+    static constexpr uint32_t MAX_SAMPLE_GAP_MS = 5000;     // longer gaps restart the differencing
+
+    TankEstimator(const TankEstimator&) = delete;
+    TankEstimator& operator=(const TankEstimator&) = delete;
+    TankEstimator(TankEstimator&&) = delete;
+    TankEstimator& operator=(TankEstimator&&) = delete;
+
+    void update(float levelKg, double areaM2, bool dispensing, uint32_t nowMs);
+    // Any task: level set by hand; the next difference is not consumption. Taken by the next update().
+    void requestRestart() { restartRequested = true; }
+
+    void setWarningMinutes(float minutes) { warningMinutes = minutes > 0.0f ? minutes : 0.0f; }
+    float getWarningMinutes() const { return warningMinutes; }
+
+    float getLevelKg() const { return levelKg; }
+    float getConsumptionKgPerMin() const { return kgPerSec * 60.0f; }
+    float getMinutesToEmpty() const { return minutesToEmpty; }     // -1 while unknown
+    float getHectaresToEmpty() const { return hectaresToEmpty; }   // -1 while unknown
+    bool isLowWarning() const { return lowWarning; }
+
+private:
+    TankEstimator() = default;
+
+    float warningMinutes = 0.0f;  // 0 disables the warning
+
+    // Smoothed rates
+    float kgPerSec = 0.0f;
+    float m2PerSec = 0.0f;
+    bool hasRate = false;
+
+    // Previous sample
+    float prevLevelKg = 0.0f;
+    double prevAreaM2 = 0.0;
+    uint32_t prevMs = 0;
+    bool hasPrev = false;
+    volatile bool restartRequested = false;
+
+    // Published results
+    volatile float levelKg = 0.0f;
+    volatile float minutesToEmpty = -1.0f;
+    volatile float hectaresToEmpty = -1.0f;
+    volatile bool lowWarning = false;
+};
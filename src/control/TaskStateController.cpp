@@ -1,59 +1,148 @@
 #include "TaskStateController.h"
 #include "core/LogUtils.h"  // If logging is used
-#include "core/SystemPreferences.h"
+
+constexpr uint8_t TaskStateController::TRANSITIONS[TASK_STATE_COUNT];
+
+static_assert(TaskStateController::isValidTransition(UserTaskState::Stopped, UserTaskState::Started), "transition table");
+static_assert(!TaskStateController::isValidTransition(UserTaskState::Stopped, UserTaskState::Paused), "transition table");
+static_assert(TaskStateController::isValidTransition(UserTaskState::Resuming, UserTaskState::Started), "transition table");
+static_assert(!TaskStateController::isValidTransition(UserTaskState::Testing, UserTaskState::Started), "transition table");
+
+// Fresh job: clean errors, counters and the tank level cached from NVS at boot / setTankLevel
+static void onStartFromStopped(TaskStateController& controller, UserTaskState from, UserTaskState to) {
+    if (from != UserTaskState::Stopped) return;
+
+    controller.getErrorManager().clearAllErrors();
+    controller.getMetrics().reset();
+    ApplicationMetrics::setTankLevel(ApplicationMetrics::getInitialTankLevel());
+}
+
+// Leaving a passive state drops transient faults that may have cleared meanwhile
+static void onLeavePassive(TaskStateController& controller, UserTaskState from, UserTaskState to) {
+    const uint32_t ERRORS_TO_CLEAR =
+        INSUFFICIENT_FLOW |
+        FLOW_NOT_SETTLED |
+        NO_SATELLITE_CONNECTED |
+        INVALID_SATELLITE_INFO |
+        INVALID_GPS_LOCATION |
+        INVALID_GPS_SPEED |
+        INVALID_PARAM_COUNT |
+        MESSAGE_PARSE_ERROR |
+        HARDWARE_ERROR;
+
+    controller.getErrorManager().clearError(ERRORS_TO_CLEAR);
+}
+
+TaskStateController::TaskStateController() {
+    addEntryHook(UserTaskState::Started, onStartFromStopped);
+    addExitHook(UserTaskState::Stopped, onLeavePassive);
+    addExitHook(UserTaskState::Paused, onLeavePassive);
+}
 
 bool TaskStateController::setTaskState(UserTaskState newState) {
-    bool validOp = false;
-
-    switch (taskState) {
-        case UserTaskState::Stopped:
-            validOp = (newState == UserTaskState::Started || newState == UserTaskState::Testing);
-            break;
-        case UserTaskState::Started:
-            validOp = (newState == UserTaskState::Paused || newState == UserTaskState::Stopped);
-            break;
-        case UserTaskState::Paused:
-            validOp = (newState == UserTaskState::Resuming || newState == UserTaskState::Stopped);
-            break;
-        case UserTaskState::Resuming:
-            validOp = (newState == UserTaskState::Started || newState == UserTaskState::Paused || newState == UserTaskState::Stopped);
-            break;
-        case UserTaskState::Testing:
-            validOp = (newState == UserTaskState::Stopped);
-            break;
+    if (static_cast<size_t>(newState) >= TASK_STATE_COUNT) {
+        return false;
     }
 
-    if (validOp) {
-        if (taskState == UserTaskState::Stopped && newState == UserTaskState::Started) {
-            errorManager.clearAllErrors();
-            metrics.reset();
-            float ftemp = SystemPreferences::getFloat(PrefKey::KEY_TANK_LEVEL, DEFAULT_TANK_INITIAL_LEVEL);
-            ApplicationMetrics::setTankLevel(ftemp);
-        }
+    bool queued = false;
+    portENTER_CRITICAL(&queueMux);
+    if (queueCount < EVENT_QUEUE_SIZE) {
+        eventQueue[(queueHead + queueCount) % EVENT_QUEUE_SIZE] = newState;
+        queueCount++;
+        queued = true;
+    } else {
+        droppedCount = droppedCount + 1;
+    }
+    portEXIT_CRITICAL(&queueMux);
+
+    return queued;
+}
 
-        if (taskState == UserTaskState::Stopped || taskState == UserTaskState::Paused) {
-            const uint32_t ERRORS_TO_CLEAR =
-                INSUFFICIENT_FLOW |
-                FLOW_NOT_SETTLED |
-                NO_SATELLITE_CONNECTED |
-                INVALID_SATELLITE_INFO |
-                INVALID_GPS_LOCATION |
-                INVALID_GPS_SPEED |
-                INVALID_PARAM_COUNT |
-                MESSAGE_PARSE_ERROR |
-                HARDWARE_ERROR;
-
-            errorManager.clearError(ERRORS_TO_CLEAR);
-
-            LogUtils::info("[STATE] Cleared relevant error flags due to task state transition to %s\n", getTaskStateName());
-            LogUtils::warn("[MOTOR] Aligning Motor To End\n");
+void TaskStateController::processEvents() {
+    for (;;) {
+        UserTaskState next;
+
+        portENTER_CRITICAL(&queueMux);
+        bool hasEvent = queueCount > 0;
+        if (hasEvent) {
+            next = eventQueue[queueHead];
+            queueHead = (queueHead + 1) % EVENT_QUEUE_SIZE;
+            queueCount--;
         }
-        taskState = newState;
+        portEXIT_CRITICAL(&queueMux);
+
+        if (!hasEvent) break;
+        applyTransition(next);
+    }
+}
+
+void TaskStateController::applyTransition(UserTaskState newState) {
+    const UserTaskState from = taskState;
+
+    if (!isValidTransition(from, newState)) {
+        lastRejectedFrom = from;
+        lastRejectedTo = newState;
+        rejectedCount = rejectedCount + 1;
+        return;
+    }
 
-        return true;
+    for (size_t i = 0; i < MAX_HOOKS_PER_STATE; ++i) {
+        TaskStateHook hook = exitHooks[static_cast<size_t>(from)][i];
+        if (hook) hook(*this, from, newState);
     }
 
-    LogUtils::warn("[STATE] Invalid state transition: %s → %s\n", getTaskStateName(), taskStateToString(newState));
+    taskState = newState;
+
+    for (size_t i = 0; i < MAX_HOOKS_PER_STATE; ++i) {
+        TaskStateHook hook = entryHooks[static_cast<size_t>(newState)][i];
+        if (hook) hook(*this, from, newState);
+    }
+
+    lastFrom = from;
+    lastTo = newState;
+    appliedCount = appliedCount + 1;
+}
+
+bool TaskStateController::reportTransitions(const char* channelName) {
+    bool rejected = false;
+
+    if (appliedCount != reportedApplied) {
+        reportedApplied = appliedCount;
+        LogUtils::info("[STATE] %s: %s -> %s\n", channelName, taskStateToString(lastFrom), taskStateToString(lastTo));
+    }
+
+    if (rejectedCount != reportedRejected) {
+        reportedRejected = rejectedCount;
+        LogUtils::warn("[STATE] %s: Invalid state transition: %s -> %s\n", channelName,
+                       taskStateToString(lastRejectedFrom), taskStateToString(lastRejectedTo));
+        rejected = true;
+    }
+
+    if (droppedCount != reportedDropped) {
+        reportedDropped = droppedCount;
+        LogUtils::warn("[STATE] %s: state event queue full, request dropped\n", channelName);
+    }
+
+    return rejected;
+}
+
+bool TaskStateController::addEntryHook(UserTaskState state, TaskStateHook hook) {
+    for (size_t i = 0; i < MAX_HOOKS_PER_STATE; ++i) {
+        if (!entryHooks[static_cast<size_t>(state)][i]) {
+            entryHooks[static_cast<size_t>(state)][i] = hook;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TaskStateController::addExitHook(UserTaskState state, TaskStateHook hook) {
+    for (size_t i = 0; i < MAX_HOOKS_PER_STATE; ++i) {
+        if (!exitHooks[static_cast<size_t>(state)][i]) {
+            exitHooks[static_cast<size_t>(state)][i] = hook;
+            return true;
+        }
+    }
     return false;
 }
 
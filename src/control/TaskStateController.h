@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <Arduino.h>
 #include "control/ErrorManager.h"
 #include "control/ApplicationMetrics.h"
 
@@ -12,13 +13,24 @@ enum class UserTaskState {
     Testing
 };
 
-class TaskStateController {
-private:
-    UserTaskState taskState = UserTaskState::Stopped;
-    ErrorManager errorManager;
-    ApplicationMetrics metrics;
+constexpr size_t TASK_STATE_COUNT = 5;
+
+class TaskStateController;
+typedef void (*TaskStateHook)(TaskStateController& controller, UserTaskState from, UserTaskState to);
 
+/*
+  State changes are requested from any task (BLE, 1 Hz timer, loop(), the
+  control tick) and queued; the control task applies them in order at the
+  start of each tick via processEvents(). Entry/exit hooks run there, so they
+  must stay cheap and never touch NVS, I2C or Serial.
+*/
+class TaskStateController {
 public:
+    static constexpr size_t EVENT_QUEUE_SIZE = 4;
+    static constexpr size_t MAX_HOOKS_PER_STATE = 2;
+
+    TaskStateController();
+
     // Query helpers
     bool isTaskStarted() const { return taskState == UserTaskState::Started; }
     bool isTaskPaused() const { return taskState == UserTaskState::Paused; }
@@ -34,9 +46,28 @@ public:
     // Getter
     UserTaskState getTaskState() const { return taskState; }
 
-    // Transition validation + mutation
+    // Queue a transition; validated against the table when applied
     bool setTaskState(UserTaskState newState);
 
+    // Control task only: apply queued transitions and run hooks
+    void processEvents();
+
+    // Deferred logging of applied/rejected/dropped transitions, called outside the control task.
+    // Returns true when a transition was rejected since the last call.
+    bool reportTransitions(const char* channelName);
+    UserTaskState getLastRejectedFrom() const { return lastRejectedFrom; }
+    UserTaskState getLastRejectedTo() const { return lastRejectedTo; }
+
+    bool addEntryHook(UserTaskState state, TaskStateHook hook);
+    bool addExitHook(UserTaskState state, TaskStateHook hook);
+
+    static constexpr uint8_t stateBit(UserTaskState state) {
+        return static_cast<uint8_t>(1u << static_cast<uint8_t>(state));
+    }
+    static constexpr bool isValidTransition(UserTaskState from, UserTaskState to) {
+        return (TRANSITIONS[static_cast<size_t>(from)] & stateBit(to)) != 0;
+    }
+
     // State names
     const char* getTaskStateName() const { return taskStateToString(taskState); }
     static const char* taskStateToString(UserTaskState state);
@@ -46,4 +77,40 @@ public:
     ApplicationMetrics& getMetrics() { return metrics; }
     const ApplicationMetrics& getMetrics() const { return metrics; }
 
+private:
+    // Allowed target states per current state, indexed by UserTaskState
+    static constexpr uint8_t TRANSITIONS[TASK_STATE_COUNT] = {
+        /* Stopped  */ (1u << 1) | (1u << 4),             // Started, Testing
+        /* Started  */ (1u << 2) | (1u << 0),             // Paused, Stopped
+        /* Paused   */ (1u << 3) | (1u << 0),             // Resuming, Stopped
+        /* Resuming */ (1u << 1) | (1u << 2) | (1u << 0), // Started, Paused, Stopped
+        /* Testing  */ (1u << 0)                          // Stopped
+    };
+
+    void applyTransition(UserTaskState newState);
+
+    volatile UserTaskState taskState = UserTaskState::Stopped;
+    ErrorManager errorManager;
+    ApplicationMetrics metrics;
+
+    // Event queue, guarded by queueMux
+    UserTaskState eventQueue[EVENT_QUEUE_SIZE];
+    size_t queueHead = 0;
+    size_t queueCount = 0;
+    portMUX_TYPE queueMux = portMUX_INITIALIZER_UNLOCKED;
+
+    TaskStateHook entryHooks[TASK_STATE_COUNT][MAX_HOOKS_PER_STATE] = {};
+    TaskStateHook exitHooks[TASK_STATE_COUNT][MAX_HOOKS_PER_STATE] = {};
+
+    // Written by processEvents(), consumed by reportTransitions()
+    volatile uint32_t appliedCount = 0;
+    volatile uint32_t rejectedCount = 0;
+    volatile uint32_t droppedCount = 0;
+    UserTaskState lastFrom = UserTaskState::Stopped;
+    UserTaskState lastTo = UserTaskState::Stopped;
+    UserTaskState lastRejectedFrom = UserTaskState::Stopped;
+    UserTaskState lastRejectedTo = UserTaskState::Stopped;
+    uint32_t reportedApplied = 0;
+    uint32_t reportedRejected = 0;
+    uint32_t reportedDropped = 0;
 };
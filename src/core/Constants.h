@@ -6,4 +6,5 @@ namespace Units {
     static constexpr float KMH_TO_MPS = 1000.0f / 3600.0f;
     static constexpr float SPRAY_RATE_DENOMINATOR = 6.0f; // legacy formula
     static constexpr float MINUTE_TO_SECOND = 60.0f;
+    static constexpr float SQUARE_METERS_PER_HECTARE = 10000.0f;
 }
@@ -10,6 +10,7 @@
 #include "DebugInfoPrinter.h"
 #include "version.h"
 #include <cstdio>
+#include <TinyGPSPlus.h>
 #include "core/SystemContext.h"
 #include "core/LogUtils.h"
 
@@ -25,8 +26,8 @@ void DebugInfoPrinter::printAll(SystemContext& context) {
     // Real-time data (flow, PI controller, errors, GPS)
     printRealTimeData(context);
 
-    // Detailed GPS LogUtils::info (TinyGPSPlus object)
-    printGPSInfo(context.getGPSModule());
+    // Detailed GPS LogUtils::info (receiver snapshot and counters)
+    printGPSInfo(context.getGPSReceiver().getFix(), context.getGPSReceiver().getStats());
 
     LogUtils::info("=======================================\n\n");
 }
@@ -48,86 +49,124 @@ String DebugInfoPrinter::formatErrorFlags(uint32_t errorFlags) {
     if (errorFlags & INVALID_PARAM_COUNT)        result += "[PC]";
     if (errorFlags & MESSAGE_PARSE_ERROR)        result += "[MP]";
     if (errorFlags & HARDWARE_ERROR)             result += "[HW]";
+    if (errorFlags & TANK_LOW_WARNING)           result += "[TW]";
 
     return result;
 }
 
 void DebugInfoPrinter::printRealTimeData(SystemContext& context) {
-    const DispenserChannel& left = context.getLeftChannel();
-    const DispenserChannel& right = context.getRightChannel();
-    const ApplicationMetrics& leftMetrics = left.getTaskController().getMetrics();
-    const ApplicationMetrics& rightMetrics = right.getTaskController().getMetrics();
+    SensorFrame frame = context.getSensorFrame();
 
     // Main PI control debug line
     LogUtils::info("[LOG] Time: %lu\n", millis());
 
-    LogUtils::info(" LEFT  | TargetFlow: %.2f | RealFlow: %.2f | Error: %.2f | CtrlSig: %d | Distance: %d | AreaPerSec: %.2f | Liquid: %.2f\n",
-           left.getTargetFlowRatePerMin(),
-           left.getRealFlowRatePerMin(),
-           left.getPIController().getError(),
-           left.getPIController().getControlSignal(),
-           leftMetrics.getDistance(),
-           left.getProcessedAreaPerSec(),
-           leftMetrics.getConsumption()
-    );
-
-    LogUtils::info(" RIGHT | TargetFlow: %.2f | RealFlow: %.2f | Error: %.2f | CtrlSig: %d | Distance: %d | AreaPerSec: %.2f | Liquid: %.2f\n",
-           right.getTargetFlowRatePerMin(),
-           right.getRealFlowRatePerMin(),
-           right.getPIController().getError(),
-           right.getPIController().getControlSignal(),
-           rightMetrics.getDistance(),
-           right.getProcessedAreaPerSec(),
-           rightMetrics.getConsumption()
-    );
+    for (size_t i = 0; i < context.getChannelCount(); ++i) {
+        const DispenserChannel& channel = context.getChannel(i);
+        const ApplicationMetrics& metrics = channel.getTaskController().getMetrics();
+
+        bool perMinute = (channel.getFlowMode() == FlowControlMode::PerMinute);
+        LogUtils::info(" %-5s | Mode: %s | TargetFlow: %.2f | RealFlow: %.2f | Error: %.2f | CtrlSig: %d | Distance: %d | AreaPerSec: %.2f | Liquid: %.2f\n",
+               channel.getName().c_str(),
+               DispenserChannel::flowModeToString(channel.getFlowMode()),
+               perMinute ? channel.getTargetFlowRatePerMin() : channel.getTargetFlowRatePerDaa(),
+               perMinute ? channel.getRealFlowRatePerMin() : channel.getRealFlowRatePerDaa(),
+               channel.getControlError(),
+               channel.getControlSignal(),
+               metrics.getDistance(),
+               channel.getProcessedAreaPerSec(frame),
+               metrics.getConsumption()
+        );
+
+        LogUtils::info(" %-5s | FlowEst: %.2f kg/min, %.2f kg/daa | RateError: %.2f (%.1f%%)\n",
+               channel.getName().c_str(),
+               channel.getFlowEstimator().getKgPerMin(),
+               channel.getFlowEstimator().getKgPerDaa(),
+               channel.getFlowRateError(),
+               channel.getFlowRateErrorPercent()
+        );
+
+        const SetpointShaper& shaper = channel.getSetpointShaper();
+        LogUtils::info(" %-5s | RawTarget: %.2f%% | ShapedTarget: %.2f%% | Ramp: %s (%.1f %%/s, %.1f %%/s2)\n",
+               channel.getName().c_str(),
+               channel.getRawTargetPosition(),
+               channel.getShapedTargetPosition(),
+               SetpointShaper::profileToString(shaper.getProfile()),
+               shaper.getMaxRate(),
+               shaper.getMaxAccel()
+        );
+
+        const ActuatorLatencyEstimator& latency = channel.getLatencyEstimator();
+        LogUtils::info(" %-5s | LookAhead: %.2f s | Configured: %.2f s | Learned: %.2f s (%u samples%s)\n",
+               channel.getName().c_str(),
+               channel.getLookAheadSec(),
+               channel.getActuatorLatency(),
+               latency.getEstimate(),
+               latency.getSampleCount(),
+               channel.isLatencyLearning() ? ", active" : ""
+        );
+        LogUtils::info(" %-5s | LatOffset: %.2f m%s | TurnFactor: %.3f (yaw %.2f deg/s)\n",
+               channel.getName().c_str(),
+               channel.getLateralOffset(),
+               channel.isLateralOffsetAuto() ? " (auto)" : "",
+               frame.getSectionSpeedFactor(channel.getLateralOffset()),
+               frame.yawRateDps
+        );
+    }
 
     // Task state and metrics
-    LogUtils::info(" LEFT  [TASK] State: %s | Duration: %d s | Distance: %d m | AreaDone: %.2f daa | LiquidUsed: %.2f L\n",
-           left.getTaskController().getTaskStateName(),
-           leftMetrics.getDuration(),
-           leftMetrics.getDistance(),
-           leftMetrics.getArea(),
-           leftMetrics.getConsumption()
-    );
-
-    LogUtils::info(" RIGHT [TASK] State: %s | Duration: %d s | Distance: %d m | AreaDone: %.2f daa | LiquidUsed: %.2f L\n",
-           right.getTaskController().getTaskStateName(),
-           rightMetrics.getDuration(),
-           rightMetrics.getDistance(),
-           rightMetrics.getArea(),
-           rightMetrics.getConsumption()
-    );
-
-    const ErrorManager& leftErrorManager = left.getTaskController().getErrorManager();
-    const ErrorManager& rightErrorManager = right.getTaskController().getErrorManager();
+    for (size_t i = 0; i < context.getChannelCount(); ++i) {
+        const DispenserChannel& channel = context.getChannel(i);
+        const ApplicationMetrics& metrics = channel.getTaskController().getMetrics();
+
+        LogUtils::info(" %-5s [TASK] State: %s | Duration: %d s | Distance: %d m | AreaDone: %.2f daa | LiquidUsed: %.2f L\n",
+               channel.getName().c_str(),
+               channel.getTaskController().getTaskStateName(),
+               metrics.getDuration(),
+               metrics.getDistance(),
+               metrics.getArea(),
+               metrics.getConsumption()
+        );
+    }
 
     // Error flags
-    String leftErrorStr = formatErrorFlags(leftErrorManager.getErrorFlags());
-    String rightErrorStr = formatErrorFlags(rightErrorManager.getErrorFlags());
+    for (size_t i = 0; i < context.getChannelCount(); ++i) {
+        const DispenserChannel& channel = context.getChannel(i);
+        const ErrorManager& errorManager = channel.getTaskController().getErrorManager();
+        String errorStr = formatErrorFlags(errorManager.getErrorFlags());
 
-    LogUtils::info(" LEFT  [ERROR] Flags: %08X %s\n", leftErrorManager.getErrorFlags(), leftErrorStr.c_str());
-    LogUtils::info(" RIGHT [ERROR] Flags: %08X %s\n", rightErrorManager.getErrorFlags(), rightErrorStr.c_str());
+        LogUtils::info(" %-5s [ERROR] Flags: %08X %s\n", channel.getName().c_str(), errorManager.getErrorFlags(), errorStr.c_str());
+    }
 }
 
 void DebugInfoPrinter::printErrorSummary(SystemContext& context) {
-    const DispenserChannel& left = context.getLeftChannel();
-    const DispenserChannel& right = context.getRightChannel();
+    String summary = "";
+
+    for (size_t i = 0; i < context.getChannelCount(); ++i) {
+        const DispenserChannel& channel = context.getChannel(i);
+        if (i > 0) summary += " | ";
+        summary += channel.getName() + ": " + formatErrorFlags(channel.getTaskController().getErrorManager().getErrorFlags());
+    }
 
-    LogUtils::info("[ERROR SUMMARY] LEFT: %s | RIGHT: %s\n",
-           formatErrorFlags(left.getTaskController().getErrorManager().getErrorFlags()).c_str(),
-           formatErrorFlags(right.getTaskController().getErrorManager().getErrorFlags()).c_str());
+    LogUtils::info("[ERROR SUMMARY] %s\n", summary.c_str());
 }
 
 void DebugInfoPrinter::printSystemInfo(SystemContext& context) {
-    const SystemParams& params = context.getParams();
+    SystemParams params = context.getParams();
 
-    LogUtils::info("[SYSTEM info] TankLevel: %.2f | ClientInWorkZone: %s | MinWorkingSpeed: %.2f km/h | SimSpeed: %.2f km/h | BoomWidth Left: %.2f m | BoomWidth Right: %.2f m\n",
+    const TankEstimator& tank = context.getTankEstimator();
+
+    LogUtils::info("[SYSTEM info] TankLevel: %.2f | ToEmpty: %.1f min, %.2f ha | ClientInWorkZone: %s | MinWorkingSpeed: %.2f km/h | SimSpeed: %.2f km/h\n",
            ApplicationMetrics::getTankLevel(),
+           tank.getMinutesToEmpty(), tank.getHectaresToEmpty(),
            DispenserChannel::isClientInWorkZone() ? "YES" : "NO",
            params.minWorkingSpeed,
-           params.simSpeed,
-           context.getLeftChannel().getBoomWidth(),
-           context.getRightChannel().getBoomWidth());
+           params.simSpeed);
+
+    for (size_t i = 0; i < context.getChannelCount(); ++i) {
+        const DispenserChannel& channel = context.getChannel(i);
+        LogUtils::info("[SYSTEM info] %s | BoomWidth: %.2f m | FlowCoeff: %.2f\n",
+               channel.getName().c_str(), channel.getBoomWidth(), channel.getFlowCoeff());
+    }
 }
 
 // Portable helper to add a formatted field to buffer with " | " separator
@@ -147,56 +186,59 @@ static int addFieldToBuffer(char* buffer, int& n, bool& first, const char* fmt,
     return n;
 }
 
-void DebugInfoPrinter::printGPSInfo(TinyGPSPlus& gpsModule) {
-    char buffer[256];
+void DebugInfoPrinter::printGPSInfo(const GPSFix& fix, const GPSStats& stats) {
+    char buffer[400];
     int n = 0;
     bool first = true;
+    const uint32_t now = millis();
 
     // --- GPS FIX indicator ---
-    bool gpsFix = gpsModule.location.isValid() &&
-                  gpsModule.satellites.isValid() &&
-                  gpsModule.satellites.value() >= 4;
+    bool gpsFix = fix.locationValid &&
+                  fix.satellitesValid &&
+                  fix.satellites >= 4;
 
     n += sprintf(buffer + n, "[%s] ", gpsFix ? "FIX OK" : "NO FIX");
 
-    if (gpsModule.satellites.isValid()) {
-        addFieldToBuffer(buffer, n, first, "Sats: %d", gpsModule.satellites.value());
+    if (fix.satellitesValid) {
+        addFieldToBuffer(buffer, n, first, "Sats: %d", fix.satellites);
     }
 
-    if (gpsModule.hdop.isValid()) {
-        addFieldToBuffer(buffer, n, first, "HDOP: %.2f, Age: %lu", gpsModule.hdop.hdop(), gpsModule.hdop.age());
+    if (fix.hdopValid) {
+        addFieldToBuffer(buffer, n, first, "HDOP: %.2f, Age: %lu", fix.hdop, (unsigned long)(now - fix.hdopMs));
     }
 
-    if (gpsModule.location.isValid()) {
+    if (fix.locationValid) {
         addFieldToBuffer(buffer, n, first, "Lat: %.6f, Lng: %.6f, Age: %lu",
-                         gpsModule.location.lat(), gpsModule.location.lng(), gpsModule.location.age());
+                         fix.lat, fix.lng, (unsigned long)(now - fix.locationMs));
     }
 
-    if (gpsModule.altitude.isValid()) {
-        addFieldToBuffer(buffer, n, first, "Alt: %.2f m", gpsModule.altitude.meters());
+    if (fix.altitudeValid) {
+        addFieldToBuffer(buffer, n, first, "Alt: %.2f m", fix.altitudeM);
     }
 
-    if (gpsModule.course.isValid()) {
+    if (fix.courseValid) {
         addFieldToBuffer(buffer, n, first, "Course: %.2f deg, Card: %s",
-                         gpsModule.course.deg(), TinyGPSPlus::cardinal(gpsModule.course.deg()));
+                         fix.courseDeg, TinyGPSPlus::cardinal(fix.courseDeg));
     }
 
-    if (gpsModule.speed.isValid()) {
-        addFieldToBuffer(buffer, n, first, "Speed: %.2f kmph, Age: %lu", gpsModule.speed.kmph(), gpsModule.speed.age());
+    if (fix.speedValid) {
+        addFieldToBuffer(buffer, n, first, "Speed: %.2f kmph, Age: %lu", fix.speedMps * 3.6f, (unsigned long)(now - fix.speedMs));
     }
 
-    TinyGPSDate &d = gpsModule.date;
-    if (d.isValid()) {
+    if (fix.dateValid) {
         addFieldToBuffer(buffer, n, first, "Date: %02d.%02d.%02d Age: %lu",
-                         d.month(), d.day(), d.year(), d.age());
+                         fix.month, fix.day, fix.year, (unsigned long)(now - fix.dateMs));
     }
 
-    TinyGPSTime &t = gpsModule.time;
-    if (t.isValid()) {
+    if (fix.timeValid) {
         addFieldToBuffer(buffer, n, first, "Time: %02d:%02d:%02d Age: %lu",
-                         t.hour(), t.minute(), t.second(), t.age());
+                         fix.hour, fix.minute, fix.second, (unsigned long)(now - fix.timeMs));
     }
 
+    addFieldToBuffer(buffer, n, first, "Rx: %lu B, %lu ok, %lu bad csum, %lu ovf, %lu frame err",
+                     (unsigned long)stats.bytes, (unsigned long)stats.sentences, (unsigned long)stats.checksumFailures,
+                     (unsigned long)stats.overflows, (unsigned long)stats.frameErrors);
+
     if (n > 0) {
         LogUtils::info("[GPS] %s\n", buffer);
     }
@@ -227,9 +269,8 @@ void DebugInfoPrinter::printResetReason(const char* cpuLabel, int reason) {
     LogUtils::info("[RESET] %s: %s\n", cpuLabel, reasonStr);
 }
 
-void DebugInfoPrinter::printMotorDiagnostics(float pos1, float pos2, float current1, float current2) {
-    LogUtils::info("[MOTORS] Pos1: %.2f%% | Pos2: %.2f%% | Curr1: %.2fA | Curr2: %.2fA\n",
-           pos1, pos2, current1, current2);
+void DebugInfoPrinter::printMotorDiagnostics(const char* channelName, float position, float current) {
+    LogUtils::info("[MOTORS] %-5s | Pos: %.2f%% | Curr: %.2fA\n", channelName, position, current);
 }
 
 void DebugInfoPrinter::printTempSensorStatus(DS18B20Sensor& sensor) {
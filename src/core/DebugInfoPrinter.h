@@ -9,7 +9,7 @@
 // ============================================
 #pragma once
 
-#include <TinyGPSPlus.h>
+#include "gps/GPSFix.h"
 #include "io/DS18B20Sensor.h"
 
 class SystemContext;  // Forward declaration for SystemContext
@@ -26,10 +26,10 @@ public:
     static void printErrorSummary(SystemContext& context);
     static void printSystemInfo(SystemContext& context);
 
-    static void printGPSInfo(TinyGPSPlus& gpsModule);
+    static void printGPSInfo(const GPSFix& fix, const GPSStats& stats);
     static void printResetReason(const char* cpuLabel, int reason);
 
-    static void printMotorDiagnostics(float pos1, float pos2, float current1, float current2);
+    static void printMotorDiagnostics(const char* channelName, float position, float current);
 
     static void printTempSensorStatus(DS18B20Sensor& sensor);
 
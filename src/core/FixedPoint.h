@@ -0,0 +1,76 @@
+// ============================================
+// File: FixedPoint.h
+// Purpose: Saturating signed Q-format fixed-point arithmetic
+// Part of: Core system utilities
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+  Signed 32-bit value with FRAC_BITS fractional bits. Products and quotients
+  go through 64-bit intermediates and saturate instead of wrapping, so a
+  large gain or a tiny Ki degrades into clamping rather than sign flips.
+  Only fromFloat()/toFloat() touch the FPU; everything else is integer.
+*/
+template <int FRAC_BITS>
+struct Fixed {
+    static_assert(FRAC_BITS > 0 && FRAC_BITS < 31, "FRAC_BITS out of range");
+
+    static constexpr int32_t ONE = static_cast<int32_t>(1) << FRAC_BITS;
+
+    int32_t raw;
+
+    constexpr Fixed() : raw(0) {}
+
+    static constexpr Fixed fromRaw(int32_t value) { return Fixed(value, RawTag()); }
+    static constexpr Fixed fromInt(int32_t value) { return fromRaw(saturate(static_cast<int64_t>(value) * ONE)); }
+    static Fixed fromFloat(float value) {
+        float scaled = value * ONE;
+        if (scaled >= 2147483647.0f) return fromRaw(INT32_MAX);
+        if (scaled <= -2147483648.0f) return fromRaw(INT32_MIN);
+        return fromRaw(static_cast<int32_t>(scaled >= 0.0f ? scaled + 0.5f : scaled - 0.5f));
+    }
+
+    float toFloat() const { return static_cast<float>(raw) / ONE; }
+    int32_t toInt() const { return raw / ONE; } // truncates toward zero, like a float -> int cast
+
+    Fixed operator+(Fixed other) const { return fromRaw(saturate(static_cast<int64_t>(raw) + other.raw)); }
+    Fixed operator-(Fixed other) const { return fromRaw(saturate(static_cast<int64_t>(raw) - other.raw)); }
+    Fixed operator-() const { return fromRaw(raw == INT32_MIN ? INT32_MAX : -raw); }
+
+    Fixed operator*(Fixed other) const {
+        int64_t product = static_cast<int64_t>(raw) * other.raw;
+        product += (product >= 0) ? (ONE / 2) : -(ONE / 2); // round to nearest
+        return fromRaw(saturate(product / ONE));
+    }
+
+    Fixed operator/(Fixed other) const {
+        if (other.raw == 0) return fromRaw(raw >= 0 ? INT32_MAX : INT32_MIN);
+        return fromRaw(saturate((static_cast<int64_t>(raw) * ONE) / other.raw));
+    }
+
+    Fixed& operator+=(Fixed other) { return *this = *this + other; }
+    Fixed& operator-=(Fixed other) { return *this = *this - other; }
+
+    bool operator<(Fixed other) const { return raw < other.raw; }
+    bool operator>(Fixed other) const { return raw > other.raw; }
+    bool operator<=(Fixed other) const { return raw <= other.raw; }
+    bool operator>=(Fixed other) const { return raw >= other.raw; }
+    bool operator==(Fixed other) const { return raw == other.raw; }
+    bool operator!=(Fixed other) const { return raw != other.raw; }
+
+private:
+    struct RawTag {};
+    constexpr Fixed(int32_t value, RawTag) : raw(value) {}
+
+    static constexpr int32_t saturate(int64_t value) {
+        return value > INT32_MAX ? INT32_MAX : (value < INT32_MIN ? INT32_MIN : static_cast<int32_t>(value));
+    }
+};
+
+typedef Fixed<16> Q16_16;
@@ -0,0 +1,192 @@
+// ============================================
+// File: JobRecorder.cpp
+// Purpose: Builds one job history record per job and hands it to the JobLog
+// Part of: Core system utilities
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+
+#include "JobRecorder.h"
+#include <math.h>
+#include "core/SystemContext.h"
+#include "core/LogUtils.h"
+
+bool JobRecorder::open = false;
+uint32_t JobRecorder::lastSampleMs = 0;
+uint32_t JobRecorder::startMs = 0;
+JobRecord JobRecorder::record;
+bool JobRecorder::running[DISPENSER_CHANNEL_COUNT];
+double JobRecorder::rateErrorSum[DISPENSER_CHANNEL_COUNT];
+uint32_t JobRecorder::rateErrorSamples[DISPENSER_CHANNEL_COUNT];
+
+const TaskStateController* JobRecorder::controllers[DISPENSER_CHANNEL_COUNT];
+JobRecorder::JobEvent JobRecorder::eventQueue[EVENT_QUEUE_SIZE];
+size_t JobRecorder::queueHead = 0;
+size_t JobRecorder::queueCount = 0;
+volatile uint32_t JobRecorder::droppedEvents = 0;
+uint32_t JobRecorder::reportedDropped = 0;
+portMUX_TYPE JobRecorder::queueMux = portMUX_INITIALIZER_UNLOCKED;
+
+void JobRecorder::init(SystemContext& context) {
+    for (size_t i = 0; i < context.getChannelCount(); ++i) {
+        TaskStateController& controller = context.getChannel(i).getTaskController();
+        controllers[i] = &controller;
+        if (!controller.addEntryHook(UserTaskState::Started, onStarted) ||
+            !controller.addEntryHook(UserTaskState::Stopped, onStopped)) {
+            LogUtils::error("[JOBLOG] No free state hook on channel %u, jobs are not recorded.\n", static_cast<unsigned>(i));
+        }
+    }
+}
+
+// Resuming -> Started continues the job; only a start from Stopped opens one
+void JobRecorder::onStarted(TaskStateController& controller, UserTaskState from, UserTaskState to) {
+    if (from == UserTaskState::Stopped) {
+        pushEvent(controller, true);
+    }
+}
+
+// A test sweep is not a job
+void JobRecorder::onStopped(TaskStateController& controller, UserTaskState from, UserTaskState to) {
+    if (from != UserTaskState::Testing) {
+        pushEvent(controller, false);
+    }
+}
+
+void JobRecorder::pushEvent(const TaskStateController& controller, bool started) {
+    JobEvent event;
+    event.channel = 0;
+    while (event.channel < DISPENSER_CHANNEL_COUNT && controllers[event.channel] != &controller) {
+        ++event.channel;
+    }
+    if (event.channel == DISPENSER_CHANNEL_COUNT) {
+        return;
+    }
+    event.started = started;
+    event.timeMs = millis();
+    event.totals = controller.getMetrics().getSnapshot(); // before a restart can zero them
+
+    portENTER_CRITICAL(&queueMux);
+    if (queueCount < EVENT_QUEUE_SIZE) {
+        eventQueue[(queueHead + queueCount) % EVENT_QUEUE_SIZE] = event;
+        queueCount++;
+    } else {
+        droppedEvents = droppedEvents + 1;
+    }
+    portEXIT_CRITICAL(&queueMux);
+}
+
+bool JobRecorder::popEvent(JobEvent& event) {
+    bool hasEvent = false;
+    portENTER_CRITICAL(&queueMux);
+    if (queueCount > 0) {
+        event = eventQueue[queueHead];
+        queueHead = (queueHead + 1) % EVENT_QUEUE_SIZE;
+        queueCount--;
+        hasEvent = true;
+    }
+    portEXIT_CRITICAL(&queueMux);
+    return hasEvent;
+}
+
+void JobRecorder::service(SystemContext& context, uint32_t nowMs) {
+    JobEvent event;
+    while (popEvent(event)) {
+        handleEvent(context, event);
+    }
+
+    if (droppedEvents != reportedDropped) {
+        reportedDropped = droppedEvents;
+        LogUtils::warn("[JOBLOG] Job event queue full, a start or stop was not recorded.\n");
+    }
+
+    if (!open || nowMs - lastSampleMs < SAMPLE_PERIOD_MS) {
+        return;
+    }
+    lastSampleMs = nowMs;
+    sample(context);
+}
+
+void JobRecorder::handleEvent(SystemContext& context, const JobEvent& event) {
+    if (event.started) {
+        if (!open) {
+            openJob(context, event.timeMs);
+        }
+        running[event.channel] = true;
+        return;
+    }
+
+    if (!open || !running[event.channel]) {
+        return;
+    }
+    running[event.channel] = false;
+
+    // A channel stopped and started again within the job adds up its segments
+    JobChannelSummary& summary = record.channels[event.channel];
+    summary.areaM2 += static_cast<float>(event.totals.areaM2);
+    summary.consumptionKg += static_cast<float>(event.totals.consumptionKg);
+    summary.distanceM += static_cast<float>(event.totals.distanceM);
+    summary.durationSec += static_cast<uint32_t>(event.totals.durationMs / 1000);
+
+    for (size_t i = 0; i < context.getChannelCount(); ++i) {
+        if (running[i]) {
+            return;
+        }
+    }
+    closeJob(context, event.timeMs);
+}
+
+void JobRecorder::openJob(SystemContext& context, uint32_t nowMs) {
+    memset(&record, 0, sizeof(record));
+    memset(running, 0, sizeof(running));
+    memset(rateErrorSum, 0, sizeof(rateErrorSum));
+    memset(rateErrorSamples, 0, sizeof(rateErrorSamples));
+    record.startTime = context.getGPSProvider().getUnixTime();
+    startMs = nowMs;
+    lastSampleMs = nowMs;
+    open = true;
+}
+
+void JobRecorder::sample(SystemContext& context) {
+    for (size_t i = 0; i < context.getChannelCount(); ++i) {
+        const DispenserChannel& channel = context.getChannel(i);
+        const TaskStateController& controller = channel.getTaskController();
+        JobChannelSummary& summary = record.channels[i];
+
+        uint32_t flags = controller.getErrorManager().getErrorFlags();
+        for (size_t bit = 0; bit < ERROR_FLAG_COUNT; ++bit) {
+            if ((flags & (1UL << bit)) && summary.errorSeconds[bit] < UINT16_MAX) {
+                ++summary.errorSeconds[bit];
+            }
+        }
+
+        if (controller.isTaskActive()) {
+            rateErrorSum[i] += fabsf(channel.getFlowRateErrorPercent());
+            ++rateErrorSamples[i];
+        }
+    }
+}
+
+void JobRecorder::closeJob(SystemContext& context, uint32_t nowMs) {
+    open = false;
+
+    // The record may have started before the clock was known
+    if (record.startTime == 0) {
+        uint32_t now = context.getGPSProvider().getUnixTime();
+        if (now != 0) {
+            record.startTime = now - (nowMs - startMs) / 1000;
+        }
+    }
+    record.endTime = context.getGPSProvider().getUnixTime();
+    record.wallSeconds = (nowMs - startMs) / 1000;
+
+    // Totals were added up from each channel's stop events
+    for (size_t i = 0; i < context.getChannelCount(); ++i) {
+        JobChannelSummary& summary = record.channels[i];
+        summary.avgRateErrorPct = rateErrorSamples[i] ? static_cast<float>(rateErrorSum[i] / rateErrorSamples[i]) : 0.0f;
+    }
+
+    if (!context.getJobLog().append(record)) {
+        LogUtils::warn("[JOBLOG] Job could not be saved to history.\n");
+    }
+}
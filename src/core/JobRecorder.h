@@ -0,0 +1,78 @@
+// ============================================
+// File: JobRecorder.h
+// Purpose: Builds one job history record per job and hands it to the JobLog
+// Part of: Core system utilities
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+
+#pragma once
+
+#include <Arduino.h>
+#include "storage/JobLog.h"
+#include "control/TaskStateController.h"
+
+class SystemContext; // Forward declaration
+
+/*
+  A job opens when a channel is started from Stopped and closes when every
+  channel that took part has stopped again. Both edges come from
+  TaskStateController entry hooks rather than from polling the states: the
+  Stopped hook copies the channel's totals into a small queue before a
+  restart can zero them, so a stop and restart between two polls still
+  closes one record and opens the next. loop() drains the queue and writes
+  the record; it also samples once per second while a job is open to build
+  the error-flag histogram and the mean rate error. A job resumed after a
+  reset is recorded from the resume point on, with the restored totals.
+*/
+class JobRecorder {
+public:
+    static constexpr uint32_t SAMPLE_PERIOD_MS = 1000;
+    static constexpr size_t EVENT_QUEUE_SIZE = 2 * DISPENSER_CHANNEL_COUNT;
+
+    // Boot, before the control task runs: registers the state hooks
+    static void init(SystemContext& context);
+
+    // loop()
+    static void service(SystemContext& context, uint32_t nowMs);
+
+    static bool isRecording() { return open; }
+
+private:
+    // A channel started from Stopped, or stopped with its totals as of that tick
+    struct JobEvent {
+        uint8_t channel;
+        bool started;
+        uint32_t timeMs;
+        MetricsSnapshot totals;
+    };
+
+    // Control task, from processEvents()
+    static void onStarted(TaskStateController& controller, UserTaskState from, UserTaskState to);
+    static void onStopped(TaskStateController& controller, UserTaskState from, UserTaskState to);
+    static void pushEvent(const TaskStateController& controller, bool started);
+    static bool popEvent(JobEvent& event);
+
+    static void handleEvent(SystemContext& context, const JobEvent& event);
+    static void openJob(SystemContext& context, uint32_t nowMs);
+    static void sample(SystemContext& context);
+    static void closeJob(SystemContext& context, uint32_t nowMs);
+
+    static bool open;
+    static uint32_t lastSampleMs;
+    static uint32_t startMs;
+    static JobRecord record;
+    static bool running[DISPENSER_CHANNEL_COUNT];
+    static double rateErrorSum[DISPENSER_CHANNEL_COUNT];
+    static uint32_t rateErrorSamples[DISPENSER_CHANNEL_COUNT];
+
+    // Event queue, guarded by queueMux
+    static const TaskStateController* controllers[DISPENSER_CHANNEL_COUNT];
+    static JobEvent eventQueue[EVENT_QUEUE_SIZE];
+    static size_t queueHead;
+    static size_t queueCount;
+    static volatile uint32_t droppedEvents;
+    static uint32_t reportedDropped;
+    static portMUX_TYPE queueMux;
+};
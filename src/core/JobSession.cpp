@@ -0,0 +1,204 @@
+// ============================================
+// File: JobSession.cpp
+// Purpose: Power-loss-safe checkpointing of the running job (RTC memory + NVS)
+// Part of: Core system utilities
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+
+#include "JobSession.h"
+#include <esp_attr.h>
+#include <esp_crc.h>
+#include <stddef.h>
+#include "core/SystemContext.h"
+#include "core/SystemPreferences.h"
+#include "core/LogUtils.h"
+
+// Not touched by the startup code, so it still holds the last tick's checkpoint after a reset
+RTC_NOINIT_ATTR static uint32_t rtcCheckpoint[(sizeof(JobCheckpoint) + 3) / 4];
+
+JobCheckpoint JobSession::pending;
+volatile bool JobSession::pendingValid = false;
+volatile JobSession::ResumePhase JobSession::resumePhase = JobSession::ResumePhase::Idle;
+uint32_t JobSession::sequence = 0;
+SeqLock<JobCheckpoint> JobSession::latest;
+JobCheckpoint JobSession::lastSaved;
+uint32_t JobSession::lastSavedMs = 0;
+bool JobSession::hasSaved = false;
+
+// Set by the control task, logged from loop()
+static volatile bool discardedByStart = false;
+static volatile bool resumed = false;
+
+uint32_t JobSession::computeCrc(const JobCheckpoint& cp) {
+    return esp_crc32_le(0, reinterpret_cast<const uint8_t*>(&cp), offsetof(JobCheckpoint, crc));
+}
+
+bool JobSession::isValid(const JobCheckpoint& cp) {
+    return cp.magic == MAGIC && cp.version == VERSION &&
+           cp.channelCount == DISPENSER_CHANNEL_COUNT && cp.crc == computeCrc(cp);
+}
+
+void JobSession::init() {
+    JobCheckpoint fromRtc;
+    JobCheckpoint fromNvs;
+    memcpy(&fromRtc, rtcCheckpoint, sizeof(fromRtc));
+
+    bool rtcOk = isValid(fromRtc);
+    bool nvsOk = SystemPreferences::getBytes(PrefKey::KEY_JOB_CHECKPOINT, &fromNvs, sizeof(fromNvs)) && isValid(fromNvs);
+
+    if (nvsOk) {
+        memcpy(&lastSaved, &fromNvs, sizeof(lastSaved));
+        hasSaved = true;
+    }
+
+    const JobCheckpoint* best = nullptr;
+    if (rtcOk && (!nvsOk || fromRtc.sequence >= fromNvs.sequence)) {
+        best = &fromRtc;
+    } else if (nvsOk) {
+        best = &fromNvs;
+    }
+
+    if (best == nullptr) {
+        LogUtils::info("[JOB] No saved job session.\n");
+        return;
+    }
+
+    sequence = best->sequence;
+    if (!best->open) {
+        LogUtils::info("[JOB] Last job closed normally (%s copy).\n", best == &fromRtc ? "RTC" : "NVS");
+        return;
+    }
+
+    memcpy(&pending, best, sizeof(pending));
+    pendingValid = true;
+
+    double consumption = 0.0;
+    for (size_t i = 0; i < DISPENSER_CHANNEL_COUNT; ++i) {
+        consumption += pending.totals[i].consumptionKg;
+    }
+    LogUtils::warn("[JOB] Interrupted job found (%s copy, seq %u): %.2f kg dispensed. Send resumeJob=1 to continue, 0 to discard.\n",
+                   best == &fromRtc ? "RTC" : "NVS", static_cast<unsigned>(pending.sequence), consumption);
+}
+
+bool JobSession::requestResume() {
+    if (!pendingValid || resumePhase != ResumePhase::Idle) {
+        return false;
+    }
+    resumePhase = ResumePhase::Requested;
+    return true;
+}
+
+void JobSession::discard() {
+    if (resumePhase == ResumePhase::Idle) {
+        pendingValid = false;
+    }
+}
+
+/*
+  Resuming takes two ticks: the first queues Started (then Paused where the
+  job was paused); on the next, after processEvents() has run the Started
+  entry hook that zeroes the metrics, the saved totals are put back.
+*/
+void JobSession::processResume(SystemContext& context) {
+    if (resumePhase == ResumePhase::Requested) {
+        for (size_t i = 0; i < context.getChannelCount(); ++i) {
+            UserTaskState state = static_cast<UserTaskState>(pending.taskState[i]);
+            TaskStateController& controller = context.getChannel(i).getTaskController();
+
+            if (state == UserTaskState::Started || state == UserTaskState::Resuming || state == UserTaskState::Paused) {
+                controller.setTaskState(UserTaskState::Started);
+                if (state == UserTaskState::Paused) {
+                    controller.setTaskState(UserTaskState::Paused);
+                }
+            }
+        }
+        resumePhase = ResumePhase::Started;
+    } else if (resumePhase == ResumePhase::Started) {
+        for (size_t i = 0; i < context.getChannelCount(); ++i) {
+            context.getChannel(i).getTaskController().getMetrics().restore(pending.totals[i]);
+        }
+        ApplicationMetrics::restoreTankLevel(pending.tankLevelKg);
+        pendingValid = false;
+        resumePhase = ResumePhase::Idle;
+        resumed = true;
+    }
+}
+
+void JobSession::checkpoint(SystemContext& context) {
+    if (pendingValid) {
+        if (resumePhase != ResumePhase::Idle) {
+            return;
+        }
+
+        // Starting a fresh job instead of resuming gives up the interrupted one
+        bool freshStart = false;
+        for (size_t i = 0; i < context.getChannelCount(); ++i) {
+            freshStart |= context.getChannel(i).getTaskController().isTaskActive();
+        }
+        if (!freshStart) {
+            return; // keep the interrupted job intact until the app decides
+        }
+        pendingValid = false;
+        discardedByStart = true;
+    }
+
+    JobCheckpoint cp;
+    memset(&cp, 0, sizeof(cp)); // padding is covered by the CRC
+    cp.magic = MAGIC;
+    cp.version = VERSION;
+    cp.channelCount = DISPENSER_CHANNEL_COUNT;
+    cp.sequence = ++sequence;
+    cp.tankLevelKg = ApplicationMetrics::getTankLevelKg();
+
+    for (size_t i = 0; i < DISPENSER_CHANNEL_COUNT; ++i) {
+        const TaskStateController& controller = context.getChannel(i).getTaskController();
+        cp.totals[i] = controller.getMetrics().getTotals();
+        cp.taskState[i] = static_cast<uint8_t>(controller.getTaskState());
+        if (controller.isTaskActive() || controller.isTaskPaused()) {
+            cp.open = 1;
+        }
+    }
+    cp.crc = computeCrc(cp);
+
+    memcpy(rtcCheckpoint, &cp, sizeof(cp));
+    latest.write(cp);
+}
+
+void JobSession::service(uint32_t nowMs) {
+    if (discardedByStart) {
+        discardedByStart = false;
+        LogUtils::warn("[JOB] New job started, interrupted job discarded.\n");
+    }
+    if (resumed) {
+        resumed = false;
+        LogUtils::info("[JOB] Interrupted job resumed.\n");
+    }
+
+    if (pendingValid) {
+        return;
+    }
+
+    JobCheckpoint cp = latest.read();
+    if (cp.magic != MAGIC || (!hasSaved && !cp.open)) {
+        return; // nothing checkpointed yet, or no job has ever run
+    }
+
+    bool stateChanged = !hasSaved || cp.open != lastSaved.open ||
+                        memcmp(cp.taskState, lastSaved.taskState, sizeof(cp.taskState)) != 0;
+    bool progressed = memcmp(cp.totals, lastSaved.totals, sizeof(cp.totals)) != 0 ||
+                      cp.tankLevelKg != lastSaved.tankLevelKg;
+    uint32_t elapsed = nowMs - lastSavedMs;
+
+    bool due = (stateChanged && elapsed >= NVS_MIN_SPACING_MS) ||
+               (cp.open && progressed && elapsed >= NVS_INTERVAL_MS);
+    if (!due) {
+        return;
+    }
+
+    SystemPreferences::saveBytes(PrefKey::KEY_JOB_CHECKPOINT, &cp, sizeof(cp));
+    memcpy(&lastSaved, &cp, sizeof(lastSaved));
+    lastSavedMs = nowMs;
+    hasSaved = true;
+}
@@ -0,0 +1,81 @@
+// ============================================
+// File: JobSession.h
+// Purpose: Power-loss-safe checkpointing of the running job (RTC memory + NVS)
+// Part of: Core system utilities
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+
+#pragma once
+
+#include <Arduino.h>
+#include "io/IOConfig.h"
+#include "control/ApplicationMetrics.h"
+#include "core/SeqLock.h"
+
+class SystemContext; // Forward declaration
+
+struct JobCheckpoint {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t channelCount;
+    uint8_t open;              // a channel was Started, Resuming or Paused
+    uint32_t sequence;         // increases every tick, across reboots
+    double tankLevelKg;
+    MetricsSnapshot totals[DISPENSER_CHANNEL_COUNT];
+    uint8_t taskState[DISPENSER_CHANNEL_COUNT];
+    uint32_t crc;              // over everything above
+};
+
+/*
+  The control task writes a checkpoint every tick into RTC slow memory,
+  which keeps its contents across brownout, watchdog and software resets
+  but not a full power cut. loop() copies the latest checkpoint to NVS on
+  a coarse schedule: every NVS_INTERVAL_MS while the job changes, sooner
+  on a task state change, and once when the job closes, so an 8 h job
+  costs a few hundred flash writes.
+
+  On boot the newer valid copy (CRC checked, highest sequence) is taken;
+  if its job was still open it is held as pending and reported until the
+  app resumes or discards it. While pending, nothing is overwritten, and
+  starting a fresh job discards it.
+*/
+class JobSession {
+public:
+    static constexpr uint32_t MAGIC = 0x4A4F4253; // "JOBS"
+    static constexpr uint16_t VERSION = 1;
+    static constexpr uint32_t NVS_INTERVAL_MS = 60000;
+    static constexpr uint32_t NVS_MIN_SPACING_MS = 5000;  // for state-change writes
+
+    static void init();
+
+    // Control task, pass 0 after task events and once per tick after metrics
+    static void processResume(SystemContext& context);
+    static void checkpoint(SystemContext& context);
+
+    // loop(): wear-aware NVS copy
+    static void service(uint32_t nowMs);
+
+    // Command side
+    static bool hasPending() { return pendingValid; }
+    static const JobCheckpoint& getPending() { return pending; }
+    static bool requestResume();
+    static void discard();
+
+private:
+    enum class ResumePhase : uint8_t { Idle = 0, Requested, Started };
+
+    static uint32_t computeCrc(const JobCheckpoint& cp);
+    static bool isValid(const JobCheckpoint& cp);
+
+    static JobCheckpoint pending;
+    static volatile bool pendingValid;
+    static volatile ResumePhase resumePhase;
+    static uint32_t sequence;
+
+    static SeqLock<JobCheckpoint> latest;   // written by the control task, read by loop()
+    static JobCheckpoint lastSaved;         // loop() only
+    static uint32_t lastSavedMs;
+    static bool hasSaved;
+};
@@ -0,0 +1,103 @@
+// ============================================
+// File: LatencyProfiler.cpp
+// Purpose: Control-loop stage timing (wake -> sample -> compute -> actuate)
+// Part of: Core system utilities
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+
+#include "LatencyProfiler.h"
+#include <string.h>
+
+volatile bool LatencyProfiler::enabled = false;
+volatile bool LatencyProfiler::resetRequested = false;
+uint32_t LatencyProfiler::cpuMHz = 240;
+uint32_t LatencyProfiler::fireCycles = 0;
+uint32_t LatencyProfiler::lastStageCycles = 0;
+uint32_t LatencyProfiler::lastFireCycles = 0;
+bool LatencyProfiler::hasLastFire = false;
+LatencySnapshot LatencyProfiler::working;
+SeqLock<LatencySnapshot> LatencyProfiler::published;
+
+void LatencyProfiler::setEnabled(bool enable) {
+    if (enable && !enabled) {
+        uint32_t mhz = getCpuFrequencyMhz();
+        cpuMHz = mhz ? mhz : 240;
+        hasLastFire = false;
+        resetRequested = true; // cleared by the control tick, never concurrently
+    }
+    enabled = enable;
+}
+
+// Stage stamps use the CPU cycle counter; all of them are taken by the
+// pinned control task, so they come from the same core. Wake latency crosses
+// cores and is measured with esp_timer instead.
+void LatencyProfiler::onFire() {
+    uint32_t now = ESP.getCycleCount();
+
+    if (resetRequested) {
+        clear();
+        hasLastFire = false;
+        resetRequested = false;
+    }
+
+    if (hasLastFire) {
+        record(LatencyStage::Period, cyclesToUs(now - lastFireCycles));
+    }
+    lastFireCycles = now;
+    hasLastFire = true;
+
+    fireCycles = now;
+    lastStageCycles = now;
+}
+
+void LatencyProfiler::onStage(LatencyStage stage) {
+    uint32_t now = ESP.getCycleCount();
+    record(stage, cyclesToUs(now - lastStageCycles));
+    lastStageCycles = now;
+}
+
+void LatencyProfiler::onActuated() {
+    uint32_t now = ESP.getCycleCount();
+    record(LatencyStage::Actuate, cyclesToUs(now - lastStageCycles));
+    record(LatencyStage::Total, cyclesToUs(now - fireCycles));
+    lastStageCycles = now;
+
+    // Last stamp of the tick: readers see every stage from the same tick, never a half-updated one
+    published.write(working);
+}
+
+void LatencyProfiler::record(LatencyStage stage, uint32_t us) {
+    LatencyStats& s = working.stages[static_cast<size_t>(stage)];
+
+    if (s.count == 0 || us < s.minUs) s.minUs = us;
+    if (us > s.maxUs) s.maxUs = us;
+    s.sumUs += us;
+    s.count++;
+
+    // log2 buckets starting at 16 µs
+    size_t bin = 0;
+    if (us >= 16) {
+        bin = (31 - __builtin_clz(us)) - 3;
+        if (bin >= LatencyStats::HIST_BINS) bin = LatencyStats::HIST_BINS - 1;
+    }
+    s.hist[bin]++;
+}
+
+void LatencyProfiler::clear() {
+    memset(&working, 0, sizeof(working));
+}
+
+const char* LatencyProfiler::stageToString(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::Wake:      return "Wake";
+        case LatencyStage::Sample:    return "Sample";
+        case LatencyStage::Compute:   return "Compute";
+        case LatencyStage::Actuate:   return "Actuate";
+        case LatencyStage::Total:     return "Total";
+        case LatencyStage::SampleAge: return "SampleAge";
+        case LatencyStage::Period:    return "Period";
+        default:                      return "Unknown";
+    }
+}
@@ -0,0 +1,80 @@
+// ============================================
+// File: LatencyProfiler.h
+// Purpose: Control-loop stage timing (wake -> sample -> compute -> actuate)
+// Part of: Core system utilities
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+
+#pragma once
+
+#include <Arduino.h>
+#include "SeqLock.h"
+
+enum class LatencyStage : uint8_t {
+    Wake = 0,    // timer callback -> control task running
+    Sample,      // task wake -> ADC sweep done and gate positions read
+    Compute,     // sampled -> targets and PI outputs ready
+    Actuate,     // computed -> last ledc duty update
+    Total,       // task wake -> last ledc duty update
+    SampleAge,   // age of the ADC buffer when the control tick read it
+    Period,      // interval between consecutive task wakes
+    Count
+};
+
+struct LatencyStats {
+    static constexpr size_t HIST_BINS = 12;  // bin k covers [16·2^(k-1), 16·2^k) µs, bin 0 is < 16 µs
+
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint64_t sumUs;
+    uint32_t count;
+    uint32_t hist[HIST_BINS];
+
+    uint32_t getAvgUs() const { return count ? static_cast<uint32_t>(sumUs / count) : 0; }
+};
+
+// All stages as of the same control tick
+struct LatencySnapshot {
+    LatencyStats stages[static_cast<size_t>(LatencyStage::Count)];
+
+    const LatencyStats& get(LatencyStage stage) const { return stages[static_cast<size_t>(stage)]; }
+};
+
+class LatencyProfiler {
+public:
+    static void setEnabled(bool enabled);
+    static bool isEnabled() { return enabled; }
+    static void requestReset() { resetRequested = true; }
+
+    // Control tick side: a single branch when disabled
+    static inline void markFire() { if (enabled) onFire(); }
+    static inline void markSampled() { if (enabled) onStage(LatencyStage::Sample); }
+    static inline void markComputed() { if (enabled) onStage(LatencyStage::Compute); }
+    static inline void markActuated() { if (enabled) onActuated(); }
+    static inline void recordSampleAge(uint32_t ageUs) { if (enabled) record(LatencyStage::SampleAge, ageUs); }
+    static inline void recordWake(uint32_t latencyUs) { if (enabled) record(LatencyStage::Wake, latencyUs); }
+
+    // Any task: copy of the stats published at the end of the last profiled tick
+    static LatencySnapshot getSnapshot() { return published.read(); }
+    static const char* stageToString(LatencyStage stage);
+
+private:
+    static void onFire();
+    static void onStage(LatencyStage stage);
+    static void onActuated();
+    static void record(LatencyStage stage, uint32_t us);
+    static void clear();
+    static uint32_t cyclesToUs(uint32_t cycles) { return cycles / cpuMHz; }
+
+    static volatile bool enabled;
+    static volatile bool resetRequested;
+    static uint32_t cpuMHz;
+    static uint32_t fireCycles;
+    static uint32_t lastStageCycles;
+    static uint32_t lastFireCycles;
+    static bool hasLastFire;
+    static LatencySnapshot working;          // control task only
+    static SeqLock<LatencySnapshot> published;
+};
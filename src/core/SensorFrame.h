@@ -0,0 +1,56 @@
+// ============================================
+// File: SensorFrame.h
+// Purpose: Immutable per-tick view of all sensor inputs
+// Part of: Core system utilities
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+
+#pragma once
+
+#include <stdint.h>
+#include "io/IOConfig.h"
+#include "gps/GPSProvider.h"
+#include "SystemParams.h"
+
+/*
+  Built once per control tick by SystemContext::captureSensorFrame() and
+  published through a SeqLock. Control code receives it by reference and the
+  1 Hz metrics path reads the latest published copy, so every consumer in a
+  tick sees the same speed, validity and gate positions.
+*/
+struct SensorFrame {
+    uint32_t timestampMs;   // millis() when the frame was built
+    int64_t adcSampleUs;    // esp_timer time of the ADC sweep behind the positions
+
+    SystemParams params;
+
+    // GPS
+    bool gpsValid;
+    int satellites;
+    float gpsSpeedMps;      // raw GPS speed, 0 when invalid
+    float accelMps2;
+    float courseDeg;
+    float yawRateDps;
+    Location_t location;    // last fix extrapolated to the frame time, (0, 0) when invalid
+
+    // Ground speed from the active source (GPS or simulated)
+    float speedMps;
+
+    // Per-channel inputs
+    float positionPercent[DISPENSER_CHANNEL_COUNT];
+    float motorCurrent[DISPENSER_CHANNEL_COUNT];   // A, filtered
+
+    inline float getSpeedKmph() const { return speedMps * 3.6f; }
+
+    inline float getPredictedSpeedMps(float horizonSec) const {
+        if (params.speedSource != SpeedSource::GPS) return speedMps;
+        return gpsValid ? GPSProvider::predictSpeed(gpsSpeedMps, accelMps2, horizonSec) : 0.0f;
+    }
+
+    inline float getSectionSpeedFactor(float lateralOffsetM) const {
+        if (params.speedSource != SpeedSource::GPS || !gpsValid) return 1.0f;
+        return GPSProvider::sectionSpeedFactor(yawRateDps, gpsSpeedMps, lateralOffsetM);
+    }
+};
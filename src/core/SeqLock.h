@@ -0,0 +1,61 @@
+// ============================================
+// File: SeqLock.h
+// Purpose: Sequence lock for publishing small POD snapshots across tasks
+// Part of: Core system utilities
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+
+#pragma once
+
+#include <Arduino.h>
+#include <type_traits>
+
+/*
+  Readers never block and never take a lock: they copy the payload and retry
+  if a write was in progress or happened meanwhile (odd or changed sequence).
+  Writers are serialized by a spinlock critical section, which also keeps a
+  reader on the same core from preempting a half-finished write.
+  Only use for small trivially copyable types; a read is a plain memcpy.
+*/
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock payload must be trivially copyable");
+public:
+    SeqLock() : sequence(0), data() {}
+    explicit SeqLock(const T& initial) : sequence(0), data(initial) {}
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    T read() const {
+        T copy;
+        uint32_t before, after;
+        do {
+            before = sequence;
+            __sync_synchronize();
+            memcpy(&copy, const_cast<const T*>(&data), sizeof(T));
+            __sync_synchronize();
+            after = sequence;
+        } while ((before & 1u) || before != after);
+        return copy;
+    }
+
+    void write(const T& value) {
+        portENTER_CRITICAL(&writeMux);
+        sequence = sequence + 1;  // odd: write in progress
+        __sync_synchronize();
+        memcpy(const_cast<T*>(&data), &value, sizeof(T));
+        __sync_synchronize();
+        sequence = sequence + 1;  // even: stable
+        portEXIT_CRITICAL(&writeMux);
+    }
+
+    uint32_t getSequence() const { return sequence; }
+
+private:
+    volatile uint32_t sequence;
+    volatile T data;
+    portMUX_TYPE writeMux = portMUX_INITIALIZER_UNLOCKED;
+};
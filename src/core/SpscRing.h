@@ -0,0 +1,48 @@
+// ============================================
+// File: SpscRing.h
+// Purpose: Fixed-size single producer / single consumer queue between tasks
+// Part of: Core system utilities
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+
+#pragma once
+
+#include <stddef.h>
+
+/*
+  The producer only writes head, the consumer only writes tail, and each
+  publishes its index after the item copy, so no lock is needed between the
+  control task and loop(). One slot stays empty to tell full from empty.
+*/
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2, "SpscRing needs at least two slots");
+public:
+    // Producer; false when full (the item is dropped)
+    bool push(const T& item) {
+        size_t head = headIndex;
+        size_t next = (head + 1) % N;
+        if (next == tailIndex) {
+            return false;
+        }
+        items[head] = item;
+        __sync_synchronize();
+        headIndex = next;
+        return true;
+    }
+
+    // Consumer
+    inline bool isEmpty() const { return tailIndex == headIndex; }
+    inline const T& front() const { return items[tailIndex]; }
+    inline void pop() {
+        __sync_synchronize();
+        tailIndex = (tailIndex + 1) % N;
+    }
+
+private:
+    T items[N];
+    volatile size_t headIndex = 0;
+    volatile size_t tailIndex = 0;
+};
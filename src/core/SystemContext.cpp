@@ -8,9 +8,10 @@
 // Date: 13 June 2025
 // ============================================
 #include "SystemContext.h"
-#include <TinyGPSPlus.h>
 #include "core/DebugInfoPrinter.h"
 #include "core/LogUtils.h"
+#include "core/JobSession.h"
+#include "core/JobRecorder.h"
 
 // BLE Callback Implementations
 static void onWriteCallback(const char* message, size_t len);
@@ -19,8 +20,7 @@ static void onConnectCallback();
 static void onDisconnectCallback();
 
 constexpr ADS1115Pins SystemContext::adsPins;
-constexpr VNH7070ASPins SystemContext::leftChannelPins;
-constexpr VNH7070ASPins SystemContext::rightChannelPins;
+constexpr DispenserChannelPins SystemContext::channelPins[DISPENSER_CHANNEL_COUNT];
 
 SystemContext& SystemContext::instance() {
     static SystemContext ctx;
@@ -39,21 +39,35 @@ void SystemContext::init() {
     }
 
     ads1115.setGain(ADS1115::Gain::FSR_4_096V); // Optional: Set gain
+    ads1115.setDataRate(ADS1115::DataRate::SPS_475); // ~2 ms per conversion, whole sweep fits early in the tick
+
+    for (size_t i = 0; i < getChannelCount(); ++i) {
+        channels[i].init(i, this, channelPins[i]);
+    }
 
     SystemPreferences::init(*this);
-    leftChannel.init("Left", this, leftChannelPins);
-    rightChannel.init("Right", this, rightChannelPins);
 
-    // Force both channels to STOPPED
-    getLeftChannel().getTaskController().setTaskState(UserTaskState::Stopped);
-    getRightChannel().getTaskController().setTaskState(UserTaskState::Stopped);
+    // Task controllers are constructed in STOPPED; transitions only happen via the event queue.
+    // An interrupted job is only reported here and resumed on request.
+    LogUtils::warn("[TASK INIT] All channels start in STOPPED on boot.\n");
+    JobSession::init();
 
-    LogUtils::warn("[TASK INIT] Forced task state to STOPPED on boot.\n");
+    if (jobLogRegion.open(JOB_LOG_PARTITION)) {
+        jobLog.begin(&jobLogRegion);
+    }
+    JobRecorder::init(*this); // state hooks, before the control task applies any transition
+    if (timeSeriesRegion.open(TIME_SERIES_PARTITION)) {
+        timeSeriesLog.begin(&timeSeriesRegion);
+    }
+    if (asAppliedRegion.open(AS_APPLIED_PARTITION)) {
+        asAppliedLog.begin(&asAppliedRegion);
+    }
 
     commandHandler.setContext(this);
     commandHandler.registerHandlers();
 
-    gpsProvider.setModule(&gpsModule);
+    gpsReceiver.begin(GPS_UART_RX_PIN, GPS_UART_TX_PIN, GPS_UART_BAUD);
+    gpsProvider.setReceiver(&gpsReceiver);
 
     bleTextServer.onWrite(onWriteCallback);
     bleTextServer.onRead(onReadCallback);
@@ -81,12 +95,35 @@ String SystemContext::readDS18B20ID() {
     return tempSensor.isReady() ? tempSensor.getSensorID() : "DS18B20 Not Found";
 }
 
-float SystemContext::getGroundSpeed(bool useSim) const {
-    if (params.speedSource == "GPS") {
-        return gpsProvider.getSpeed();
+// One read of every GPS field, ADC channel and parameter for this tick
+void SystemContext::captureSensorFrame(SensorFrame& frame) const {
+    frame.timestampMs = millis();
+    frame.adcSampleUs = ads1115.getLastPushMicros();
+    frame.params = params.read();
+
+    frame.gpsValid = gpsProvider.isValid();
+    frame.satellites = gpsProvider.getSatelliteCount();
+    frame.gpsSpeedMps = gpsProvider.getSpeed(true);
+    frame.accelMps2 = gpsProvider.getAcceleration();
+    frame.courseDeg = gpsProvider.getCourse();
+    frame.yawRateDps = gpsProvider.getYawRate();
+    frame.location = gpsProvider.getCurrentLocation();
+
+    frame.speedMps = (frame.params.speedSource == SpeedSource::GPS) ? frame.gpsSpeedMps : frame.params.simSpeed / 3.6f;
+
+    for (size_t i = 0; i < getChannelCount(); ++i) {
+        frame.positionPercent[i] = channels[i].getCurrentPositionPercent();
+        frame.motorCurrent[i] = channels[i].getMotorCurrent();
+    }
+}
+
+float SystemContext::getGroundSpeed(bool mps) const {
+    SystemParams p = params.read();
+    if (p.speedSource == SpeedSource::GPS) {
+        return gpsProvider.getSpeed(mps);
     }
 
-    return params.simSpeed;
+    return mps ? p.simSpeed / 3.6f : p.simSpeed;
 }
 
 void SystemContext::writeRGBLEDs(uint8_t chR, uint8_t chG, uint8_t chB) {
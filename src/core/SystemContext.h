@@ -9,32 +9,35 @@
 // ============================================
 #pragma once
 #include <Preferences.h>
-#include <TinyGPSPlus.h>
 
 #include "SystemPreferences.h"
+#include "SeqLock.h"
+#include "SystemParams.h"
+#include "SensorFrame.h"
 #include "ble/BLETextServer.h"
 #include "ble/BLECommandParser.h"
 #include "ble/CommandHandler.h"
 #include "gps/GPSProvider.h"
+#include "gps/GPSReceiver.h"
 #include "control/DispenserChannel.h"
+#include "control/StepResponseCapture.h"
+#include "control/TankEstimator.h"
+#include "control/CoverageMap.h"
+#include "storage/FlashRegion.h"
+#include "storage/JobLog.h"
+#include "storage/TimeSeriesLog.h"
+#include "storage/AsAppliedLog.h"
 
 #include "io/IOConfig.h"
 #include "io/RGBLedPins.h"
 #include "io/VNH7070ASPins.h"
 #include "io/ADS1115Pins.h"
 #include "io/DS18B20Pins.h"
+#include "io/DispenserChannelPins.h"
 #include "io/VNH7070AS.h"
 #include "io/ADS1115.h"
 #include "io/DS18B20Sensor.h"
 
-struct SystemParams {
-    String speedSource;
-    float simSpeed;
-    float minWorkingSpeed;
-    int autoRefreshPeriod;
-    int heartBeatPeriod;
-};
-
 class SystemContext {
 public:
     static SystemContext& instance();  // Singleton accessor
@@ -42,33 +45,52 @@ public:
     void init();  // Initialize all services
 
     // Non-Const Accessors for services
-    inline SystemParams& getParams() { return params; }
     inline BLETextServer& getBLETextServer() { return bleTextServer; }
     inline BLECommandParser& getBLECommandParser() { return bleCommandParser; }
     inline CommandHandler& getCommandHandler() { return commandHandler; }
-    inline TinyGPSPlus& getGPSModule() { return gpsModule; }
+    inline GPSReceiver& getGPSReceiver() { return gpsReceiver; }
     inline GPSProvider& getGPSProvider() { return gpsProvider; }
     inline ADS1115& getADS1115() { return ads1115; }
     inline DS18B20Sensor& getTempSensor() { return tempSensor; }
-    inline DispenserChannel& getLeftChannel() { return leftChannel; }
-    inline DispenserChannel& getRightChannel() { return rightChannel; }
+    inline DispenserChannel& getChannel(size_t index) { return channels[index]; }
+    inline StepResponseCapture& getStepCapture() { return stepCapture; }
+    inline TankEstimator& getTankEstimator() { return tankEstimator; }
+    inline CoverageMap& getCoverageMap() { return coverageMap; }
+    inline JobLog& getJobLog() { return jobLog; }
+    inline TimeSeriesLog& getTimeSeriesLog() { return timeSeriesLog; }
+    inline AsAppliedLog& getAsAppliedLog() { return asAppliedLog; }
     
     // Const accessors for services
-    const SystemParams& getParams() const { return params; }
+    // Lock-free consistent snapshot; modify a copy and publish it with setParams()
+    inline SystemParams getParams() const { return params.read(); }
     inline const BLETextServer& getBLETextServer() const { return bleTextServer; }
     inline const BLECommandParser& getBLECommandParser() const { return bleCommandParser; }
     inline const CommandHandler& getCommandHandler() const { return commandHandler; }
-    inline const TinyGPSPlus& getGPSModule() const { return gpsModule; }
+    inline const GPSReceiver& getGPSReceiver() const { return gpsReceiver; }
     inline const GPSProvider& getGPSProvider() const { return gpsProvider; }
     inline const ADS1115& getADS1115() const { return ads1115; }
     inline const DS18B20Sensor& getTempSensor() const { return tempSensor; }
-    inline const DispenserChannel& getLeftChannel() const { return leftChannel; }
-    inline const DispenserChannel& getRightChannel() const { return rightChannel; }
+    inline const DispenserChannel& getChannel(size_t index) const { return channels[index]; }
+    inline const StepResponseCapture& getStepCapture() const { return stepCapture; }
+    inline const TankEstimator& getTankEstimator() const { return tankEstimator; }
+    inline const CoverageMap& getCoverageMap() const { return coverageMap; }
+    inline const JobLog& getJobLog() const { return jobLog; }
+    inline const TimeSeriesLog& getTimeSeriesLog() const { return timeSeriesLog; }
+    inline const AsAppliedLog& getAsAppliedLog() const { return asAppliedLog; }
+
+    // Dispenser sections
+    static constexpr size_t getChannelCount() { return DISPENSER_CHANNEL_COUNT; }
+    static const DispenserChannelPins& getChannelPins(size_t index) { return channelPins[index]; }
+
+    inline void setParams(const SystemParams& p) { params.write(p); }
 
-    void setParams(const SystemParams& p) { params = p; }
+    // Per-tick sensor snapshot: built by the control task, read by everyone else
+    void captureSensorFrame(SensorFrame& frame) const;
+    inline void publishSensorFrame(const SensorFrame& frame) { sensorFrame.write(frame); }
+    inline SensorFrame getSensorFrame() const { return sensorFrame.read(); }
 
     void writeRGBLEDs(uint8_t chR, uint8_t chG, uint8_t chB);
-    float getGroundSpeed(bool useSim = false) const;
+    float getGroundSpeed(bool mps = false) const;
 
     // Identity
     inline void setBoardID(const String& id) { boardID = id; }
@@ -81,24 +103,38 @@ public:
 
 private:
     // Pin Definitions
-    static constexpr VNH7070ASPins leftChannelPins = { VNH7070AS_INA1Pin, VNH7070AS_INB1Pin, VNH7070AS_PWM1Pin, VNH7070AS_SEL1Pin };
-    static constexpr VNH7070ASPins rightChannelPins = { VNH7070AS_INA2Pin, VNH7070AS_INB2Pin, VNH7070AS_PWM2Pin, VNH7070AS_SEL2Pin };
+    static constexpr DispenserChannelPins channelPins[DISPENSER_CHANNEL_COUNT] = {
+        { { VNH7070AS_INA1Pin, VNH7070AS_INB1Pin, VNH7070AS_PWM1Pin, VNH7070AS_SEL1Pin }, ADS1115Channels::CH0, ADS1115Channels::CH2 },
+        { { VNH7070AS_INA2Pin, VNH7070AS_INB2Pin, VNH7070AS_PWM2Pin, VNH7070AS_SEL2Pin }, ADS1115Channels::CH1, ADS1115Channels::CH3 },
+    };
     static constexpr RGBLedPins rgbLEDPins = { RGB_LEDRPin, RGB_LEDGPin, RGB_LEDBPin };
     static constexpr ADS1115Pins adsPins = { I2C_SDAPin, I2C_SCLPin };
     static constexpr DS18B20Pins tempPins = { DS18B20_DataPin };
     static constexpr uint8_t ADS1115_I2C_ADDRESS = 0x48;
+    static constexpr const char* JOB_LOG_PARTITION = "joblog";  // see partitions.csv
+    static constexpr const char* TIME_SERIES_PARTITION = "tslog";
+    static constexpr const char* AS_APPLIED_PARTITION = "asapplied";
 
     // Services
-    SystemParams params;
+    SeqLock<SystemParams> params;
+    SeqLock<SensorFrame> sensorFrame;
     BLETextServer bleTextServer;
     BLECommandParser bleCommandParser;
     CommandHandler commandHandler;
-    TinyGPSPlus gpsModule;
+    GPSReceiver gpsReceiver;
     GPSProvider gpsProvider;
     ADS1115 ads1115;
     DS18B20Sensor tempSensor;
-    DispenserChannel leftChannel;
-    DispenserChannel rightChannel;
+    DispenserChannel channels[DISPENSER_CHANNEL_COUNT];
+    StepResponseCapture stepCapture;
+    TankEstimator tankEstimator;
+    CoverageMap coverageMap;
+    PartitionFlashRegion jobLogRegion;
+    JobLog jobLog;
+    PartitionFlashRegion timeSeriesRegion;
+    TimeSeriesLog timeSeriesLog;
+    PartitionFlashRegion asAppliedRegion;
+    AsAppliedLog asAppliedLog;
 
     // board specific identification
     String boardID;
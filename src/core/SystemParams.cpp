@@ -0,0 +1,20 @@
+// ============================================
+// File: SystemParams.cpp
+// Purpose: User-adjustable system parameters shared across tasks
+// Part of: Core system utilities
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+
+#include "SystemParams.h"
+#include <string.h>
+
+const char* SystemParams::speedSourceToString(SpeedSource source) {
+    return (source == SpeedSource::GPS) ? "GPS" : "SIM";
+}
+
+// Anything but "GPS" selects the simulated speed, as before
+SpeedSource SystemParams::speedSourceFromString(const char* str) {
+    return (str && strcmp(str, "GPS") == 0) ? SpeedSource::GPS : SpeedSource::Simulation;
+}
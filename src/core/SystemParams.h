@@ -0,0 +1,29 @@
+// ============================================
+// File: SystemParams.h
+// Purpose: User-adjustable system parameters shared across tasks
+// Part of: Core system utilities
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+
+#pragma once
+
+#include <stdint.h>
+
+enum class SpeedSource : uint8_t {
+    GPS = 0,
+    Simulation
+};
+
+// Plain data so it can be published through a SeqLock and copied per tick
+struct SystemParams {
+    SpeedSource speedSource;
+    float simSpeed;         // km/h
+    float minWorkingSpeed;  // km/h
+    int autoRefreshPeriod;
+    int heartBeatPeriod;
+
+    static const char* speedSourceToString(SpeedSource source);
+    static SpeedSource speedSourceFromString(const char* str);
+};
@@ -21,26 +21,45 @@ const char* SystemPreferences::keyNames[KEY_COUNT] = {
     "refresh",
     "heartbeat",
     "tankLevel",
-
-    "left_rateDaa",
-    "left_rateMin",
-    "left_flowCoeff",
-    "left_boomWidth",
-
-    "right_rateDaa",
-    "right_rateMin",
-    "right_flowCoeff",
-    "right_boomWidth",
-
+    "tankWarn",
     "piKp",
     "piKi",
+    "piKd",
     "logLevel",
+    "jobCkpt",
+    "tsDecim",
+    "tsRetain",
+    "ovlShutoff",
+    "gpsBackend",
+
+    "rateDaa",
+    "rateMin",
+    "flowCoeff",
+    "boomWidth",
+    "ramp",
+    "rampRate",
+    "rampAccel",
+    "latency",
+    "latLearn",
+    "flowMode",
+    "latOffset",
+    "ctrlAlgo",
+};
+
+// Channels 0 and 1 keep the historical "left_"/"right_" keys so stored settings survive
+const char* SystemPreferences::channelPrefixes[MAX_DISPENSER_CHANNELS] = {
+    "left", "right", "sec3", "sec4", "sec5", "sec6", "sec7", "sec8"
 };
 
 const char* SystemPreferences::getKeyName(PrefKey key) {
     return keyNames[static_cast<int>(key)];
 }
 
+const char* SystemPreferences::makeChannelKeyName(PrefKey key, uint8_t channel, char* buffer) {
+    snprintf(buffer, MAX_KEY_LENGTH, "%s_%s", channelPrefixes[channel], getKeyName(key));
+    return buffer;
+}
+
 void SystemPreferences::init(SystemContext& ctx) {
     Preferences prefs;
     prefs.begin(storageNamespace, true);
@@ -51,31 +70,54 @@ void SystemPreferences::init(SystemContext& ctx) {
     }
     LogUtils::setLogLevel(static_cast<LogLevel>(logLevel));
 
-    SystemParams& params = ctx.getParams();
+    SystemParams params;
 
-    params.speedSource = prefs.getString(keyNames[KEY_SPEED_SRC], DEFAULT_SPEED_SOURCE);
+    params.speedSource = SystemParams::speedSourceFromString(prefs.getString(keyNames[KEY_SPEED_SRC], DEFAULT_SPEED_SOURCE).c_str());
     params.simSpeed = prefs.getFloat(keyNames[KEY_SIM_SPEED], DEFAULT_SIM_SPEED);
     params.minWorkingSpeed = prefs.getFloat(keyNames[KEY_MIN_SPEED], DEFAULT_MIN_WORKING_SPEED);
     params.autoRefreshPeriod = prefs.getInt(keyNames[KEY_REFRESH], DEFAULT_AUTO_REFRESH_PERIOD);
     params.heartBeatPeriod = prefs.getInt(keyNames[KEY_HEARTBEAT], DEFAULT_HEARTBEAT_PERIOD);
-    ApplicationMetrics::setTankLevel(prefs.getFloat(keyNames[KEY_TANK_LEVEL], DEFAULT_TANK_INITIAL_LEVEL));
-
-    auto& left = ctx.getLeftChannel();
-    left.setTargetFlowRatePerDaa(prefs.getFloat(keyNames[KEY_LEFT_RATE_DAA], DEFAULT_TARGET_RATE_KG_DAA));
-    left.setTargetFlowRatePerMin(prefs.getFloat(keyNames[KEY_LEFT_RATE_MIN], DEFAULT_TARGET_FLOW_PER_MIN));
-    left.setFlowCoeff(prefs.getFloat(keyNames[KEY_LEFT_FLOW_COEFF], DEFAULT_FLOW_COEFF));
-    left.setBoomWidth(prefs.getFloat(keyNames[KEY_LEFT_BOOM_WIDTH], DEFAULT_LEFT_BOOM_WIDTH));
+    ctx.setParams(params);
+    ApplicationMetrics::setInitialTankLevel(prefs.getFloat(keyNames[KEY_TANK_LEVEL], DEFAULT_TANK_INITIAL_LEVEL));
+    ApplicationMetrics::setTankLevel(ApplicationMetrics::getInitialTankLevel());
+    ctx.getTankEstimator().setWarningMinutes(prefs.getFloat(keyNames[KEY_TANK_WARNING], DEFAULT_TANK_WARNING_MINUTES));
 
-    auto& right = ctx.getRightChannel();
-    right.setTargetFlowRatePerDaa(prefs.getFloat(keyNames[KEY_RIGHT_RATE_DAA], DEFAULT_TARGET_RATE_KG_DAA));
-    right.setTargetFlowRatePerMin(prefs.getFloat(keyNames[KEY_RIGHT_RATE_MIN], DEFAULT_TARGET_FLOW_PER_MIN));
-    right.setFlowCoeff(prefs.getFloat(keyNames[KEY_RIGHT_FLOW_COEFF], DEFAULT_FLOW_COEFF));
-    right.setBoomWidth(prefs.getFloat(keyNames[KEY_RIGHT_BOOM_WIDTH], DEFAULT_RIGHT_BOOM_WIDTH));
+    ctx.getTimeSeriesLog().setDecimation(prefs.getInt(keyNames[KEY_TS_DECIMATION], DEFAULT_TS_DECIMATION));
+    ctx.getTimeSeriesLog().setRetentionMinutes(prefs.getInt(keyNames[KEY_TS_RETENTION], DEFAULT_TS_RETENTION_MIN));
+    ctx.getCoverageMap().setShutoffEnabled(prefs.getInt(keyNames[KEY_OVERLAP_SHUTOFF], DEFAULT_OVERLAP_SHUTOFF) != 0);
+    // The receiver task starts after the preferences, so the backend is set before the first byte
+    ctx.getGPSReceiver().setBackend(static_cast<GPSParserBackend>(prefs.getInt(keyNames[KEY_GPS_BACKEND], DEFAULT_GPS_BACKEND)));
 
+    // Staged like a BLE change and applied on the first control tick
     float kp = prefs.getFloat(keyNames[KEY_PI_KP], DEFAULT_KP_VALUE);
     float ki = prefs.getFloat(keyNames[KEY_PI_KI], DEFAULT_KI_VALUE);
-    ctx.getLeftChannel().getPIController().setPIParams(kp, ki);
-    ctx.getRightChannel().getPIController().setPIParams(kp, ki);
+    float kd = prefs.getFloat(keyNames[KEY_PI_KD], DEFAULT_KD_VALUE);
+    char name[MAX_KEY_LENGTH];
+
+    for (size_t i = 0; i < ctx.getChannelCount(); ++i) {
+        DispenserChannel& channel = ctx.getChannel(i);
+        channel.setTargetFlowRatePerDaa(prefs.getFloat(makeChannelKeyName(KEY_CH_RATE_DAA, i, name), DEFAULT_TARGET_RATE_KG_DAA));
+        channel.setTargetFlowRatePerMin(prefs.getFloat(makeChannelKeyName(KEY_CH_RATE_MIN, i, name), DEFAULT_TARGET_FLOW_PER_MIN));
+        channel.setFlowCoeff(prefs.getFloat(makeChannelKeyName(KEY_CH_FLOW_COEFF, i, name), DEFAULT_FLOW_COEFF));
+        channel.setFlowMode(static_cast<FlowControlMode>(prefs.getInt(makeChannelKeyName(KEY_CH_FLOW_MODE, i, name), DEFAULT_FLOW_MODE)));
+        channel.setControlAlgorithm(static_cast<GateControlAlgorithm>(prefs.getInt(makeChannelKeyName(KEY_CH_CONTROL_ALGORITHM, i, name), DEFAULT_CONTROL_ALGORITHM)));
+        channel.setBoomWidth(prefs.getFloat(makeChannelKeyName(KEY_CH_BOOM_WIDTH, i, name), DEFAULT_BOOM_WIDTH));
+        PIGains gains = { kp, ki, kd };
+        channel.requestPIGains(gains);
+
+        SetpointShaper& shaper = channel.getSetpointShaper();
+        RampProfile profile = static_cast<RampProfile>(prefs.getInt(makeChannelKeyName(KEY_CH_RAMP_PROFILE, i, name), DEFAULT_RAMP_PROFILE));
+        if (profile == RampProfile::Custom) {
+            shaper.setLimits(prefs.getFloat(makeChannelKeyName(KEY_CH_RAMP_RATE, i, name), SetpointShaper::GENTLE_MAX_RATE),
+                             prefs.getFloat(makeChannelKeyName(KEY_CH_RAMP_ACCEL, i, name), SetpointShaper::GENTLE_MAX_ACCEL));
+        } else {
+            shaper.setProfile(profile);
+        }
+
+        channel.setActuatorLatency(prefs.getFloat(makeChannelKeyName(KEY_CH_LATENCY, i, name), DEFAULT_ACTUATOR_LATENCY));
+        channel.setLatencyLearning(prefs.getInt(makeChannelKeyName(KEY_CH_LATENCY_LEARN, i, name), DEFAULT_LATENCY_LEARNING) != 0);
+        channel.setLateralOffset(prefs.getFloat(makeChannelKeyName(KEY_CH_LATERAL_OFFSET, i, name), DEFAULT_LATERAL_OFFSET));
+    }
 
     prefs.end();
 }
@@ -94,22 +136,40 @@ bool SystemPreferences::getBool(PrefKey key, bool defaultValue) {
 }
 
 int SystemPreferences::getInt(PrefKey key, int defaultValue) {
+    return getIntByName(getKeyName(key), defaultValue);
+}
+
+int SystemPreferences::getInt(PrefKey key, uint8_t channel, int defaultValue) {
+    char name[MAX_KEY_LENGTH];
+    return getIntByName(makeChannelKeyName(key, channel, name), defaultValue);
+}
+
+int SystemPreferences::getIntByName(const char* name, int defaultValue) {
     Preferences prefs;
     prefs.begin(storageNamespace, true);
-    int val = prefs.getInt(getKeyName(key), defaultValue);
+    int val = prefs.getInt(name, defaultValue);
     prefs.end();
 
-    LogUtils::verbose("[PREF] %s = %d (default %d)\n", getKeyName(key), val, defaultValue);
+    LogUtils::verbose("[PREF] %s = %d (default %d)\n", name, val, defaultValue);
     return val;
 }
 
 float SystemPreferences::getFloat(PrefKey key, float defaultValue) {
+    return getFloatByName(getKeyName(key), defaultValue);
+}
+
+float SystemPreferences::getFloat(PrefKey key, uint8_t channel, float defaultValue) {
+    char name[MAX_KEY_LENGTH];
+    return getFloatByName(makeChannelKeyName(key, channel, name), defaultValue);
+}
+
+float SystemPreferences::getFloatByName(const char* name, float defaultValue) {
     Preferences prefs;
     prefs.begin(storageNamespace, true);
-    float val = prefs.getFloat(getKeyName(key), defaultValue);
+    float val = prefs.getFloat(name, defaultValue);
     prefs.end();
 
-    LogUtils::verbose("[PREF] %s = %.2f (default %.2f)\n", getKeyName(key), val, defaultValue);
+    LogUtils::verbose("[PREF] %s = %.2f (default %.2f)\n", name, val, defaultValue);
     return val;
 }
 
@@ -139,10 +199,41 @@ void SystemPreferences::save(PrefKey key, const String& value) {
     prefs.end();
 }
 
-void SystemPreferences::save(PrefKey key, const int value) {
+bool SystemPreferences::getBytes(PrefKey key, void* data, size_t length) {
+    Preferences prefs;
+    prefs.begin(storageNamespace, true);
+    const char* name = getKeyName(key);
+    bool ok = prefs.isKey(name) && prefs.getBytesLength(name) == length &&
+              prefs.getBytes(name, data, length) == length;
+    prefs.end();
+
+    LogUtils::verbose("[PREF] %s: %u byte record %s\n", name, static_cast<unsigned>(length), ok ? "loaded" : "missing");
+    return ok;
+}
+
+// Callers rate-limit these writes; every call costs one NVS entry rewrite
+void SystemPreferences::saveBytes(PrefKey key, const void* data, size_t length) {
     Preferences prefs;
     prefs.begin(storageNamespace);
     const char* name = getKeyName(key);
+    prefs.putBytes(name, data, length);
+    prefs.end();
+
+    LogUtils::verbose("[PREF] %s <- %u bytes\n", name, static_cast<unsigned>(length));
+}
+
+void SystemPreferences::save(PrefKey key, const int value) {
+    saveByName(getKeyName(key), value);
+}
+
+void SystemPreferences::save(PrefKey key, uint8_t channel, const int value) {
+    char name[MAX_KEY_LENGTH];
+    saveByName(makeChannelKeyName(key, channel, name), value);
+}
+
+void SystemPreferences::saveByName(const char* name, const int value) {
+    Preferences prefs;
+    prefs.begin(storageNamespace);
     int oldValue = prefs.getInt(name);
     bool valueExists = prefs.isKey(name);
     bool valueChanged = (oldValue != value);
@@ -158,9 +249,17 @@ void SystemPreferences::save(PrefKey key, const int value) {
 }
 
 void SystemPreferences::save(PrefKey key, const float value) {
+    saveByName(getKeyName(key), value);
+}
+
+void SystemPreferences::save(PrefKey key, uint8_t channel, const float value) {
+    char name[MAX_KEY_LENGTH];
+    saveByName(makeChannelKeyName(key, channel, name), value);
+}
+
+void SystemPreferences::saveByName(const char* name, const float value) {
     Preferences prefs;
     prefs.begin(storageNamespace);
-    const char* name = getKeyName(key);
     float oldValue = prefs.getFloat(name, 0.0f);
     bool valueExists = prefs.isKey(name);
     bool valueChanged = (oldValue != value);
@@ -9,6 +9,7 @@
 // ============================================
 #pragma once
 #include <Preferences.h>
+#include <stdint.h>
 
 class SystemContext; // Forward declaration
 
@@ -17,16 +18,27 @@ namespace {
     constexpr float DEFAULT_TARGET_RATE_KG_DAA    = 20.0f;
     constexpr float DEFAULT_TARGET_FLOW_PER_MIN   = 15.0f;
     constexpr float DEFAULT_FLOW_COEFF            = 1.0f;
-    constexpr float DEFAULT_LEFT_BOOM_WIDTH       = 0.0f;
-    constexpr float DEFAULT_RIGHT_BOOM_WIDTH      = 0.0f;
+    constexpr float DEFAULT_BOOM_WIDTH            = 0.0f;
     constexpr float DEFAULT_MIN_WORKING_SPEED     = 1.0f;
     constexpr int   DEFAULT_AUTO_REFRESH_PERIOD   = 4;
     constexpr int   DEFAULT_HEARTBEAT_PERIOD      = 25;
     constexpr char  DEFAULT_SPEED_SOURCE[]        = "GPS";
     constexpr float DEFAULT_TANK_INITIAL_LEVEL    = 1000.0f;
+    constexpr float DEFAULT_TANK_WARNING_MINUTES  = 15.0f;  // 0 disables the low-tank warning
     constexpr float DEFAULT_SIM_SPEED             = 1.0f;
     constexpr float DEFAULT_KP_VALUE              = 25.0f;
     constexpr float DEFAULT_KI_VALUE              = 4.0f;
+    constexpr float DEFAULT_KD_VALUE              = 0.0f;  // derivative off unless tuned
+    constexpr int   DEFAULT_RAMP_PROFILE          = 1;     // RampProfile::Fast
+    constexpr float DEFAULT_ACTUATOR_LATENCY      = 0.0f;  // seconds, no look-ahead
+    constexpr bool  DEFAULT_LATENCY_LEARNING      = false;
+    constexpr int   DEFAULT_FLOW_MODE             = 0;     // FlowControlMode::PerArea
+    constexpr float DEFAULT_LATERAL_OFFSET        = NAN;   // derived from the boom layout
+    constexpr int   DEFAULT_CONTROL_ALGORITHM     = 0;     // GateControlAlgorithm::PILoop
+    constexpr int   DEFAULT_TS_DECIMATION         = 1;     // every control tick
+    constexpr int   DEFAULT_TS_RETENTION_MIN      = 0;     // whole partition
+    constexpr bool  DEFAULT_OVERLAP_SHUTOFF       = true;
+    constexpr int   DEFAULT_GPS_BACKEND           = 0;     // GPSParserBackend::TinyGPSPlus
 }
 
 enum PrefKey {
@@ -36,17 +48,30 @@ enum PrefKey {
     KEY_REFRESH,
     KEY_HEARTBEAT,
     KEY_TANK_LEVEL,
-    KEY_LEFT_RATE_DAA,
-    KEY_LEFT_RATE_MIN,
-    KEY_LEFT_FLOW_COEFF,
-    KEY_LEFT_BOOM_WIDTH,
-    KEY_RIGHT_RATE_DAA,
-    KEY_RIGHT_RATE_MIN,
-    KEY_RIGHT_FLOW_COEFF,
-    KEY_RIGHT_BOOM_WIDTH,
+    KEY_TANK_WARNING,
     KEY_PI_KP,
     KEY_PI_KI,
+    KEY_PI_KD,
     KEY_LOG_LEVEL,
+    KEY_JOB_CHECKPOINT,
+    KEY_TS_DECIMATION,
+    KEY_TS_RETENTION,
+    KEY_OVERLAP_SHUTOFF,
+    KEY_GPS_BACKEND,
+
+    // Per-channel keys, stored as "<channel prefix>_<key name>"
+    KEY_CH_RATE_DAA,
+    KEY_CH_RATE_MIN,
+    KEY_CH_FLOW_COEFF,
+    KEY_CH_BOOM_WIDTH,
+    KEY_CH_RAMP_PROFILE,
+    KEY_CH_RAMP_RATE,
+    KEY_CH_RAMP_ACCEL,
+    KEY_CH_LATENCY,
+    KEY_CH_LATENCY_LEARN,
+    KEY_CH_FLOW_MODE,
+    KEY_CH_LATERAL_OFFSET,
+    KEY_CH_CONTROL_ALGORITHM,
     KEY_COUNT
 };
 
@@ -62,9 +87,27 @@ public:
     static void save(PrefKey key, const int value);
     static void save(PrefKey key, const float value);
 
+    // Fixed-size binary records; a stored blob of a different size reads as missing
+    static bool getBytes(PrefKey key, void* data, size_t length);
+    static void saveBytes(PrefKey key, const void* data, size_t length);
+
+    // Per-channel accessors
+    static int getInt(PrefKey key, uint8_t channel, int defaultValue);
+    static float getFloat(PrefKey key, uint8_t channel, float defaultValue);
+    static void save(PrefKey key, uint8_t channel, const int value);
+    static void save(PrefKey key, uint8_t channel, const float value);
+
     static const char* getKeyName(PrefKey key);
 private:
     SystemPreferences() = default;
     static constexpr const char* storageNamespace = "UIData";
+    static constexpr size_t MAX_KEY_LENGTH = 16; // NVS limit incl. terminator
     static const char* keyNames[KEY_COUNT];
+    static const char* channelPrefixes[];
+
+    static const char* makeChannelKeyName(PrefKey key, uint8_t channel, char* buffer);
+    static int getIntByName(const char* name, int defaultValue);
+    static float getFloatByName(const char* name, float defaultValue);
+    static void saveByName(const char* name, const int value);
+    static void saveByName(const char* name, const float value);
 };
@@ -0,0 +1,71 @@
+// ============================================
+// File: GPSFix.h
+// Purpose: Compact GPS state published by the GPS receiver task
+// Part of: GPS Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+
+/*
+  Plain copyable snapshot, rebuilt after every sentence that passed its
+  checksum. Each *Ms stamp is millis() when that field was last updated, so
+  readers compute ages themselves and detect new values by a changed stamp.
+  A field keeps its last value (and stamp) when later sentences omit it.
+*/
+struct GPSFix {
+    uint32_t sentences;         // sentences committed so far, changes with every publish
+
+    bool locationValid;
+    bool speedValid;
+    bool courseValid;
+    bool altitudeValid;
+    bool satellitesValid;
+    bool hdopValid;
+    bool dateValid;
+    bool timeValid;
+
+    double lat;                 // degrees
+    double lng;
+    float speedMps;
+    float courseDeg;            // 0 = north
+    float altitudeM;
+    float hdop;
+    uint8_t satellites;
+
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint8_t centisecond;
+
+    uint32_t locationMs;
+    uint32_t speedMs;
+    uint32_t courseMs;
+    uint32_t altitudeMs;
+    uint32_t hdopMs;
+    uint32_t satellitesMs;
+    uint32_t dateMs;
+    uint32_t timeMs;
+};
+
+// Receiver health, counted by the GPS task since boot
+struct GPSStats {
+    uint32_t bytes;             // read from the UART driver
+    uint32_t sentences;         // passed checksum
+    uint32_t checksumFailures;
+    uint32_t overflows;         // hardware FIFO or driver ring buffer overruns (bytes lost)
+    uint32_t frameErrors;       // UART framing or parity errors
+};
+
+// Sentence decoder used by the GPS task, stored as an int preference
+enum class GPSParserBackend : uint8_t {
+    TinyGPSPlus = 0,
+    Nmea = 1            // in-place RMC/GGA/VTG parser
+};
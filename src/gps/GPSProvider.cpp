@@ -8,23 +8,175 @@
 // Date: 13 June 2025
 // ============================================
 #include "GPSProvider.h"
+#include <Arduino.h>
+#include "gps/GPSReceiver.h"
+
+GPSFix GPSProvider::getFix() const {
+    return receiver ? receiver->getFix() : GPSFix();
+}
+
+void GPSProvider::setParserBackend(GPSParserBackend backend) {
+    if (receiver) {
+        receiver->setBackend(backend);
+    }
+}
+
+GPSParserBackend GPSProvider::getParserBackend() const {
+    return receiver ? receiver->getBackend() : GPSParserBackend::TinyGPSPlus;
+}
+
+bool GPSProvider::isValid(const GPSFix& fix) {
+    return fix.locationValid &&
+           fix.speedValid &&
+           fix.satellitesValid && fix.satellites >= MIN_SATELLITES_NEEDED &&
+           fix.hdopValid && fix.hdop <= MAX_HDOP_TOLERATED;
+}
 
 bool GPSProvider::isValid() const {
-    
-    return gpsModule->location.isValid() &&
-           gpsModule->speed.isValid() &&
-           gpsModule->satellites.isValid() && gpsModule->satellites.value() >= MIN_SATELLITES_NEEDED &&
-           gpsModule->hdop.isValid() && gpsModule->hdop.hdop() <= MAX_HDOP_TOLERATED;
+    return isValid(getFix());
 }
 
 Location_t GPSProvider::getLocation() const {
-    return isValid() ? Location_t(gpsModule->location.lat(), gpsModule->location.lng()) : Location_t();
+    GPSFix fix = getFix();
+    return isValid(fix) ? Location_t(fix.lat, fix.lng) : Location_t();
 }
 
 float GPSProvider::getSpeed(bool mps) const {
-    return isValid() ? (mps ? gpsModule->speed.mps() : gpsModule->speed.kmph()) : 0.0f;
+    GPSFix fix = getFix();
+    if (!isValid(fix)) return 0.0f;
+    return mps ? fix.speedMps : fix.speedMps * 3.6f;
 }
 
 int GPSProvider::getSatelliteCount() const {
-    return gpsModule->satellites.isValid() ? gpsModule->satellites.value() : 0;
+    GPSFix fix = getFix();
+    return fix.satellitesValid ? fix.satellites : 0;
+}
+
+uint32_t GPSProvider::getUnixTime() const {
+    GPSFix fix = getFix();
+    uint32_t ageMs = millis() - fix.timeMs;
+    if (!fix.dateValid || !fix.timeValid || ageMs > MAX_TIME_AGE_MS || fix.year < 2020) {
+        return 0;
+    }
+
+    // Days since 1970-01-01 for a proleptic Gregorian date (civil-from-days inverse)
+    int y = fix.year;
+    unsigned m = fix.month;
+    unsigned d = fix.day;
+    y -= (m <= 2) ? 1 : 0;
+    int era = y / 400;
+    unsigned yoe = static_cast<unsigned>(y - era * 400);
+    unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    uint32_t days = static_cast<uint32_t>(era * 146097 + static_cast<int>(doe) - 719468);
+
+    return days * 86400UL + fix.hour * 3600UL + fix.minute * 60UL + fix.second + ageMs / 1000;
+}
+
+// Rates use the receive stamps of the values, not the control tick that happens to see them
+void GPSProvider::update() {
+    GPSFix fix = getFix();
+    if (!isValid(fix)) {
+        accelMps2 = 0.0f;
+        lastSpeedMs = 0;
+        yawRateDps = 0.0f;
+        lastCourseMs = 0;
+        return;
+    }
+
+    if (fix.courseValid && fix.courseMs != seenCourseMs) {
+        seenCourseMs = fix.courseMs;
+        float newCourse = fix.courseDeg;
+
+        // Course is meaningless when nearly stationary
+        if (fix.speedMps < MIN_SPEED_MPS) {
+            yawRateDps = 0.0f;
+        } else if (lastCourseMs != 0) {
+            // Unwrap across north so 359° -> 1° is +2°, not -358°
+            float delta = newCourse - courseDeg;
+            if (delta > 180.0f) delta -= 360.0f;
+            else if (delta < -180.0f) delta += 360.0f;
+
+            float dt = (fix.courseMs - lastCourseMs) / 1000.0f;
+            float rate = constrain(delta / dt, -MAX_YAW_RATE_DPS, MAX_YAW_RATE_DPS);
+            yawRateDps += YAW_FILTER_ALPHA * (rate - yawRateDps);
+        }
+
+        lastCourseMs = (fix.speedMps >= MIN_SPEED_MPS) ? fix.courseMs : 0;
+        courseDeg = newCourse;
+    }
+
+    if (fix.speedMs == lastSpeedMs) {
+        return;
+    }
+
+    float speedMps = fix.speedMps;
+    if (lastSpeedMs != 0) {
+        float dt = (fix.speedMs - lastSpeedMs) / 1000.0f;
+        float accel = constrain((speedMps - lastSpeedMps) / dt, -MAX_ACCEL_MPS2, MAX_ACCEL_MPS2);
+        accelMps2 += ACCEL_FILTER_ALPHA * (accel - accelMps2);
+    }
+
+    lastSpeedMps = speedMps;
+    lastSpeedMs = fix.speedMs;
+}
+
+float GPSProvider::getPredictedSpeed(float horizonSec, bool mps) const {
+    GPSFix fix = getFix();
+    if (!isValid(fix)) return 0.0f;
+
+    float speedMps = predictSpeed(fix.speedMps, accelMps2, horizonSec);
+    return mps ? speedMps : speedMps * 3.6f;
+}
+
+float GPSProvider::predictSpeed(float speedMps, float accelMps2, float horizonSec) {
+    horizonSec = constrain(horizonSec, 0.0f, MAX_PREDICTION_HORIZON_SEC);
+
+    // At a steady speed the filtered acceleration is speed noise; extrapolating it only adds error
+    if (fabsf(accelMps2) > ACCEL_DEADBAND_MPS2) {
+        speedMps += accelMps2 * horizonSec;
+    }
+    return speedMps > 0.0f ? speedMps : 0.0f;
+}
+
+Location_t GPSProvider::predictLocation(const GPSFix& fix, float horizonSec) const {
+    constexpr double EARTH_RADIUS_M = 6371000.0;
+    horizonSec = constrain(horizonSec, 0.0f, MAX_PREDICTION_HORIZON_SEC);
+
+    // Constant-acceleration distance along the current course
+    double v = fix.speedMps;
+    double distance = v * horizonSec + 0.5 * accelMps2 * horizonSec * horizonSec;
+    if (distance < 0.0) distance = 0.0;
+
+    double course = radians(courseDeg);
+    double lat = fix.lat;
+    double lng = fix.lng;
+    double dLat = distance * cos(course) / EARTH_RADIUS_M;
+    double dLng = distance * sin(course) / (EARTH_RADIUS_M * cos(radians(lat)));
+
+    return Location_t(lat + degrees(dLat), lng + degrees(dLng));
+}
+
+Location_t GPSProvider::getCurrentLocation() const {
+    GPSFix fix = getFix();
+    return isValid(fix) ? predictLocation(fix, (millis() - fix.locationMs) / 1000.0f) : Location_t();
+}
+
+/*
+  Ground speed of a point offset sideways from the GPS track, relative to the
+  centre-line speed: v_i / v = 1 - omega * y_i / v.
+  lateralOffsetM is positive to the right of the centre line, so in a right
+  turn (positive yaw rate) right-hand sections slow down and left-hand ones speed up.
+*/
+float GPSProvider::getSectionSpeedFactor(float lateralOffsetM) const {
+    GPSFix fix = getFix();
+    if (!isValid(fix)) return 1.0f;
+    return sectionSpeedFactor(yawRateDps, fix.speedMps, lateralOffsetM);
+}
+
+float GPSProvider::sectionSpeedFactor(float yawRateDps, float speedMps, float lateralOffsetM) {
+    if (fabsf(yawRateDps) < YAW_RATE_DEADBAND_DPS || speedMps < MIN_SPEED_MPS) return 1.0f;
+
+    float factor = 1.0f - radians(yawRateDps) * lateralOffsetM / speedMps;
+    return constrain(factor, 0.0f, 2.0f); // inner end stops rather than reversing
 }
@@ -9,9 +9,10 @@
 // ============================================
 #pragma once
 
-#include <TinyGPSPlus.h>
+#include "gps/GPSFix.h"
 
 class SystemContext; // Forward declaration
+class GPSReceiver;
 
 struct Location_t {
     double lat;
@@ -21,24 +22,62 @@ struct Location_t {
 
 class GPSProvider {
     friend class SystemContext;
+    friend class GpsReplay; // Host replay tests (test/host/GpsReplay.h)
 public:
     static constexpr float MIN_SPEED_MPS = 0.1f; // Minimum speed to consider GPS valid
     static constexpr float MIN_SPEED_KMPH = 0.36f; // Minimum speed in km/h
     static constexpr float MAX_HDOP_TOLERATED = 20.0f; // Maximum HDOP to consider GPS valid
     static constexpr float MIN_SATELLITES_NEEDED = 4; // Minimum satellites needed for valid GPS data
+    static constexpr float MAX_PREDICTION_HORIZON_SEC = 3.0f; // Limit of speed/position extrapolation
+    static constexpr float MAX_ACCEL_MPS2 = 3.0f; // Plausibility limit for a tractor
+    static constexpr float ACCEL_DEADBAND_MPS2 = 0.2f; // Filtered speed noise at a steady speed
+    static constexpr float MAX_YAW_RATE_DPS = 45.0f; // Plausibility limit for a towed boom
+    static constexpr float YAW_RATE_DEADBAND_DPS = 1.0f; // Course jitter on straight passes stays below this
+    static constexpr uint32_t MAX_TIME_AGE_MS = 10000; // Older date/time is not trusted as a clock
 
     GPSProvider(const GPSProvider&) = delete;
     GPSProvider& operator=(const GPSProvider&) = delete;
     GPSProvider(GPSProvider&&) = delete;
     GPSProvider& operator=(GPSProvider&&) = delete;
 
-    inline void setModule(TinyGPSPlus* module) { gpsModule = module; }
+    inline void setReceiver(GPSReceiver* source) { receiver = source; }
+    GPSFix getFix() const; // latest snapshot from the GPS task
+    void setParserBackend(GPSParserBackend backend);
+    GPSParserBackend getParserBackend() const;
 
     bool isValid() const;
     Location_t getLocation() const;
     float getSpeed(bool mps = false) const;
     int getSatelliteCount() const;
+    uint32_t getUnixTime() const; // UTC seconds from the last fix, 0 without a valid date/time
+
+    // Motion tracking from each new speed/course value, control task only
+    void update();
+    float getAcceleration() const { return accelMps2; } // m/s²
+    float getCourse() const { return courseDeg; }       // degrees, 0 = north
+    float getYawRate() const { return yawRateDps; }     // deg/s, positive = turning right
+    float getSectionSpeedFactor(float lateralOffsetM) const;
+    float getPredictedSpeed(float horizonSec, bool mps = false) const;
+
+    // Pure motion models, shared with SensorFrame so a tick can reuse one GPS read
+    static float predictSpeed(float speedMps, float accelMps2, float horizonSec);
+    static float sectionSpeedFactor(float yawRateDps, float speedMps, float lateralOffsetM);
+    Location_t getCurrentLocation() const; // last fix carried forward by its age
 private:
     GPSProvider() = default;
-    TinyGPSPlus* gpsModule = nullptr;
+    GPSReceiver* receiver = nullptr;
+
+    static bool isValid(const GPSFix& fix);
+    Location_t predictLocation(const GPSFix& fix, float horizonSec) const;
+
+    static constexpr float ACCEL_FILTER_ALPHA = 0.3f;
+    static constexpr float YAW_FILTER_ALPHA = 0.2f;
+
+    uint32_t lastSpeedMs = 0;       // fix stamps of the last values used
+    float lastSpeedMps = 0.0f;
+    float accelMps2 = 0.0f;
+    float courseDeg = 0.0f;
+    uint32_t lastCourseMs = 0;      // 0 while standing, so the first course after moving sets no rate
+    uint32_t seenCourseMs = 0;
+    float yawRateDps = 0.0f;
 };
@@ -0,0 +1,120 @@
+// ============================================
+// File: GPSReceiver.cpp
+// Purpose: UART-event driven GPS ingest task publishing a fix snapshot
+// Part of: GPS Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include "GPSReceiver.h"
+#include <freertos/queue.h>
+#include "core/LogUtils.h"
+
+bool GPSReceiver::begin(int rxPin, int txPin, uint32_t baudRate) {
+    uart_config_t config = {};
+    config.baud_rate = static_cast<int>(baudRate);
+    config.data_bits = UART_DATA_8_BITS;
+    config.parity = UART_PARITY_DISABLE;
+    config.stop_bits = UART_STOP_BITS_1;
+    config.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+
+    if (uart_driver_install(UART_PORT, RX_BUFFER_SIZE, 0, EVENT_QUEUE_LENGTH, &eventQueue, 0) != ESP_OK ||
+        uart_param_config(UART_PORT, &config) != ESP_OK ||
+        uart_set_pin(UART_PORT, txPin, rxPin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) != ESP_OK) {
+        LogUtils::error("[GPS] UART setup failed, no GPS input.\n");
+        return false;
+    }
+
+    if (xTaskCreatePinnedToCore(taskEntry, "gpsTask", TASK_STACK_SIZE, this, TASK_PRIORITY, &taskHandle, TASK_CORE) != pdPASS) {
+        taskHandle = nullptr;
+        LogUtils::error("[GPS] Task creation failed, no GPS input.\n");
+        return false;
+    }
+    return true;
+}
+
+GPSStats GPSReceiver::getStats() const {
+    GPSStats stats;
+    stats.bytes = bytes;
+    stats.sentences = sentences;
+    stats.checksumFailures = checksumFailures;
+    stats.overflows = overflows;
+    stats.frameErrors = frameErrors;
+    return stats;
+}
+
+void GPSReceiver::taskEntry(void* arg) {
+    static_cast<GPSReceiver*>(arg)->run();
+}
+
+void GPSReceiver::run() {
+    uart_event_t event;
+    uint8_t chunk[READ_CHUNK_SIZE];
+
+    for (;;) {
+        if (xQueueReceive(eventQueue, &event, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        switch (event.type) {
+        case UART_DATA: {
+            size_t pending = event.size;
+            while (pending > 0) {
+                int n = uart_read_bytes(UART_PORT, chunk, pending < sizeof(chunk) ? pending : sizeof(chunk), 0);
+                if (n <= 0) {
+                    break;
+                }
+                consume(chunk, static_cast<size_t>(n));
+                pending -= static_cast<size_t>(n);
+            }
+            break;
+        }
+
+        case UART_FIFO_OVF:
+        case UART_BUFFER_FULL:
+            // Bytes are already lost; the sentence in progress fails its checksum and is dropped
+            overflows = overflows + 1;
+            uart_flush_input(UART_PORT);
+            xQueueReset(eventQueue);
+            break;
+
+        case UART_FRAME_ERR:
+        case UART_PARITY_ERR:
+            frameErrors = frameErrors + 1;
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+void GPSReceiver::consume(const uint8_t* data, size_t length) {
+    const uint32_t now = millis();
+    bytes = bytes + length;
+
+    if (backend == GPSParserBackend::Nmea) {
+        for (size_t i = 0; i < length; ++i) {
+            if (nmeaParser.encode(static_cast<char>(data[i]), now)) {
+                publish(nmeaParser.getFix());
+            }
+        }
+    } else {
+        for (size_t i = 0; i < length; ++i) {
+            if (tinyGps.encode(static_cast<char>(data[i]), now)) {
+                publish(tinyGps.getFix());
+            }
+        }
+    }
+    sentences = tinyGps.passedChecksum() + nmeaParser.passedChecksum();
+    checksumFailures = tinyGps.failedChecksum() + nmeaParser.failedChecksum();
+}
+
+// Each parser keeps its own GPSFix with stamps; only the publish counter is ours
+void GPSReceiver::publish(const GPSFix& parsed) {
+    uint32_t published = working.sentences;
+    working = parsed;
+    working.sentences = published + 1;
+    fix.write(working);
+}
@@ -0,0 +1,87 @@
+// ============================================
+// File: GPSReceiver.h
+// Purpose: UART-event driven GPS ingest task publishing a fix snapshot
+// Part of: GPS Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <Arduino.h>
+#include <driver/uart.h>
+#include "core/SeqLock.h"
+#include "gps/GPSFix.h"
+#include "gps/NmeaParser.h"
+#include "gps/TinyGpsParser.h"
+
+/*
+  The UART driver's ISR moves received bytes into a large RX ring buffer
+  and posts an event; a dedicated task on the other core from loop() and
+  the control task blocks on the event queue, feeds the bytes to the NMEA
+  parser and republishes the fix after every completed sentence. A slow
+  loop() (ADS1115 delays, DS18B20 conversions) therefore no longer drops
+  NMEA data, and readers get a consistent copy through a SeqLock instead
+  of touching the parser from several tasks.
+
+  Either TinyGPSPlus (through TinyGpsParser) or the in-place NmeaParser
+  decodes the stream into its own GPSFix; both commit the same fields under
+  the same rules, so the switch only changes the cost per byte. Only the
+  active parser is fed.
+*/
+class GPSReceiver {
+    friend class SystemContext; // Allow SystemContext to access private members
+    friend class GpsReplay;     // Host replay tests (test/host/GpsReplay.h)
+public:
+    static constexpr uart_port_t UART_PORT = UART_NUM_1;
+    static constexpr int RX_BUFFER_SIZE = 4096;         // > 4 s of NMEA at 9600 baud
+    static constexpr int EVENT_QUEUE_LENGTH = 32;
+    static constexpr size_t READ_CHUNK_SIZE = 128;      // UART hardware FIFO size
+    static constexpr uint32_t TASK_STACK_SIZE = 4096;
+    static constexpr UBaseType_t TASK_PRIORITY = 5;     // above loop(), below the BLE host
+    static constexpr BaseType_t TASK_CORE = 0;          // loop() and the control task run on core 1
+
+    GPSReceiver(const GPSReceiver&) = delete;
+    GPSReceiver& operator=(const GPSReceiver&) = delete;
+    GPSReceiver(GPSReceiver&&) = delete;
+    GPSReceiver& operator=(GPSReceiver&&) = delete;
+
+    bool begin(int rxPin, int txPin, uint32_t baudRate);
+    inline bool isRunning() const { return taskHandle != nullptr; }
+
+    // Any task
+    inline GPSFix getFix() const { return fix.read(); }
+    GPSStats getStats() const;
+
+    // Takes effect with the next received chunk; the other parser's partial sentence is dropped
+    inline void setBackend(GPSParserBackend value) { backend = value; }
+    inline GPSParserBackend getBackend() const { return backend; }
+
+private:
+    GPSReceiver() = default;
+
+    static void taskEntry(void* arg);
+    void run();
+    void consume(const uint8_t* data, size_t length);
+    void publish(const GPSFix& parsed);
+
+    QueueHandle_t eventQueue = nullptr;
+    TaskHandle_t taskHandle = nullptr;
+
+    volatile GPSParserBackend backend = GPSParserBackend::TinyGPSPlus;
+
+    // GPS task only
+    TinyGpsParser tinyGps;
+    NmeaParser nmeaParser;
+    GPSFix working = {};
+
+    SeqLock<GPSFix> fix;
+
+    // Written by the GPS task only
+    volatile uint32_t bytes = 0;
+    volatile uint32_t sentences = 0;
+    volatile uint32_t checksumFailures = 0;
+    volatile uint32_t overflows = 0;
+    volatile uint32_t frameErrors = 0;
+};
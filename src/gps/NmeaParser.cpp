@@ -0,0 +1,291 @@
+// ============================================
+// File: NmeaParser.cpp
+// Purpose: In-place NMEA 0183 parser for RMC, GGA and VTG sentences
+// Part of: GPS Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include "NmeaParser.h"
+
+static constexpr double MPS_PER_KNOT = 0.51444444;   // same constant as TinyGPSPlus
+static constexpr double MPS_PER_KMPH = 1.0 / 3.6;
+
+static inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static inline uint32_t parseUnsigned(const char* text) {
+    uint32_t value = 0;
+    while (isDigit(*text)) {
+        value = value * 10 + static_cast<uint32_t>(*text++ - '0');
+    }
+    return value;
+}
+
+// Missing trailing fields read as empty
+static inline const char* fieldAt(char* const* field, size_t count, size_t index) {
+    return index < count ? field[index] : "";
+}
+
+bool NmeaParser::encode(char c, uint32_t nowMs) {
+    switch (c) {
+    case '$':
+        collecting = true;
+        inChecksum = false;
+        checksum = 0;
+        length = 0;
+        return false;
+
+    case '\r':
+    case '\n':
+        if (!collecting) {
+            return false;
+        }
+        collecting = false;
+        buffer[length] = '\0';
+        return processSentence(nowMs);
+
+    default:
+        if (!collecting) {
+            return false;
+        }
+        if (length >= MAX_SENTENCE_LENGTH) {
+            collecting = false; // overlong or garbage; wait for the next '$'
+            return false;
+        }
+        if (c == '*') {
+            inChecksum = true;
+        } else if (!inChecksum) {
+            checksum ^= static_cast<uint8_t>(c);
+        }
+        buffer[length++] = c;
+        return false;
+    }
+}
+
+int NmeaParser::hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+bool NmeaParser::processSentence(uint32_t nowMs) {
+    if (!inChecksum) {
+        return false; // no checksum, not trusted
+    }
+
+    // Checksum first: nothing below runs for a corrupted sentence
+    size_t star = length - 1;
+    while (buffer[star] != '*') {
+        --star;
+    }
+    int high = (length == star + 3) ? hexValue(buffer[star + 1]) : -1;
+    int low = (length == star + 3) ? hexValue(buffer[star + 2]) : -1;
+    if (high < 0 || low < 0 || ((high << 4) | low) != checksum) {
+        ++failed;
+        return false;
+    }
+    ++passed;
+    buffer[star] = '\0';
+
+    // "ttXXX,": two talker characters, then the sentence type
+    if (star < 6 || buffer[5] != ',') {
+        return false;
+    }
+    const char* type = buffer + 2;
+    bool rmc = type[0] == 'R' && type[1] == 'M' && type[2] == 'C';
+    bool gga = type[0] == 'G' && type[1] == 'G' && type[2] == 'A';
+    bool vtg = type[0] == 'V' && type[1] == 'T' && type[2] == 'G';
+    if (!rmc && !gga && !vtg) {
+        return false;
+    }
+
+    char* field[MAX_FIELDS];
+    size_t count = 0;
+    field[count++] = buffer;
+    for (char* p = buffer; *p; ++p) {
+        if (*p == ',') {
+            *p = '\0';
+            if (count < MAX_FIELDS) {
+                field[count++] = p + 1;
+            }
+        }
+    }
+
+    if (rmc) {
+        commitRMC(field, count, nowMs);
+    } else if (gga) {
+        commitGGA(field, count, nowMs);
+    } else {
+        commitVTG(field, count, nowMs);
+    }
+    return true;
+}
+
+// $--RMC,time,status,lat,N/S,lon,E/W,knots,course,ddmmyy,...
+void NmeaParser::commitRMC(char* const* field, size_t count, uint32_t nowMs) {
+    rmcSeen = true;
+    commitTime(fieldAt(field, count, 1), nowMs);
+    commitDate(fieldAt(field, count, 9), nowMs);
+    if (fieldAt(field, count, 2)[0] != 'A') {
+        return;
+    }
+
+    commitLocation(fieldAt(field, count, 3), fieldAt(field, count, 4),
+                   fieldAt(field, count, 5), fieldAt(field, count, 6), nowMs);
+
+    const char* knots = fieldAt(field, count, 7);
+    if (knots[0]) {
+        fix.speedMps = static_cast<float>(MPS_PER_KNOT * parseHundredths(knots) / 100.0);
+        fix.speedValid = true;
+        fix.speedMs = nowMs;
+    }
+    const char* course = fieldAt(field, count, 8);
+    if (course[0]) {
+        fix.courseDeg = static_cast<float>(parseHundredths(course) / 100.0);
+        fix.courseValid = true;
+        fix.courseMs = nowMs;
+    }
+}
+
+// $--GGA,time,lat,N/S,lon,E/W,quality,satellites,hdop,altitude,M,...
+void NmeaParser::commitGGA(char* const* field, size_t count, uint32_t nowMs) {
+    commitTime(fieldAt(field, count, 1), nowMs);
+
+    if (fieldAt(field, count, 6)[0] > '0') {
+        commitLocation(fieldAt(field, count, 2), fieldAt(field, count, 3),
+                       fieldAt(field, count, 4), fieldAt(field, count, 5), nowMs);
+
+        const char* altitude = fieldAt(field, count, 9);
+        if (altitude[0]) {
+            fix.altitudeM = static_cast<float>(parseHundredths(altitude) / 100.0);
+            fix.altitudeValid = true;
+            fix.altitudeMs = nowMs;
+        }
+    }
+
+    const char* satellites = fieldAt(field, count, 7);
+    if (satellites[0]) {
+        uint32_t value = parseUnsigned(satellites);
+        fix.satellites = static_cast<uint8_t>(value < UINT8_MAX ? value : UINT8_MAX);
+        fix.satellitesValid = true;
+        fix.satellitesMs = nowMs;
+    }
+    const char* hdop = fieldAt(field, count, 8);
+    if (hdop[0]) {
+        fix.hdop = static_cast<float>(parseHundredths(hdop) / 100.0);
+        fix.hdopValid = true;
+        fix.hdopMs = nowMs;
+    }
+}
+
+// $--VTG,courseTrue,T,courseMag,M,knots,N,kmph,K[,mode]; mode 'N' means no fix.
+// Only for receivers without RMC: both in one epoch would stamp the same speed twice,
+// ~100 ms apart, and GPSProvider would difference them into zero acceleration and yaw rate.
+void NmeaParser::commitVTG(char* const* field, size_t count, uint32_t nowMs) {
+    if (rmcSeen || fieldAt(field, count, 9)[0] == 'N') {
+        return;
+    }
+
+    const char* course = fieldAt(field, count, 1);
+    if (course[0]) {
+        fix.courseDeg = static_cast<float>(parseHundredths(course) / 100.0);
+        fix.courseValid = true;
+        fix.courseMs = nowMs;
+    }
+
+    const char* knots = fieldAt(field, count, 5);
+    const char* kmph = fieldAt(field, count, 7);
+    if (knots[0]) {
+        fix.speedMps = static_cast<float>(MPS_PER_KNOT * parseHundredths(knots) / 100.0);
+    } else if (kmph[0]) {
+        fix.speedMps = static_cast<float>(MPS_PER_KMPH * parseHundredths(kmph) / 100.0);
+    } else {
+        return;
+    }
+    fix.speedValid = true;
+    fix.speedMs = nowMs;
+}
+
+// hhmmss.ss
+void NmeaParser::commitTime(const char* text, uint32_t nowMs) {
+    if (!text[0]) {
+        return;
+    }
+    uint32_t value = static_cast<uint32_t>(parseHundredths(text));
+    fix.hour = static_cast<uint8_t>(value / 1000000);
+    fix.minute = static_cast<uint8_t>((value / 10000) % 100);
+    fix.second = static_cast<uint8_t>((value / 100) % 100);
+    fix.centisecond = static_cast<uint8_t>(value % 100);
+    fix.timeValid = true;
+    fix.timeMs = nowMs;
+}
+
+// ddmmyy
+void NmeaParser::commitDate(const char* text, uint32_t nowMs) {
+    if (!text[0]) {
+        return;
+    }
+    uint32_t value = parseUnsigned(text);
+    fix.day = static_cast<uint8_t>(value / 10000);
+    fix.month = static_cast<uint8_t>((value / 100) % 100);
+    fix.year = static_cast<uint16_t>(value % 100 + 2000);
+    fix.dateValid = true;
+    fix.dateMs = nowMs;
+}
+
+bool NmeaParser::commitLocation(const char* lat, const char* ns, const char* lng, const char* ew, uint32_t nowMs) {
+    double latDeg, lngDeg;
+    if (!parseDegrees(lat, latDeg) || !parseDegrees(lng, lngDeg)) {
+        return false;
+    }
+    fix.lat = (ns[0] == 'S') ? -latDeg : latDeg;
+    fix.lng = (ew[0] == 'W') ? -lngDeg : lngDeg;
+    fix.locationValid = true;
+    fix.locationMs = nowMs;
+    return true;
+}
+
+// Fixed point like TinyGPSPlus: two decimals, further digits truncated
+int32_t NmeaParser::parseHundredths(const char* text) {
+    bool negative = (*text == '-');
+    if (negative) {
+        ++text;
+    }
+    int32_t value = 100 * static_cast<int32_t>(parseUnsigned(text));
+    while (isDigit(*text)) {
+        ++text;
+    }
+    if (*text == '.' && isDigit(text[1])) {
+        value += 10 * (text[1] - '0');
+        if (isDigit(text[2])) {
+            value += text[2] - '0';
+        }
+    }
+    return negative ? -value : value;
+}
+
+// dddmm.mmmm, minutes kept as integer ten-millionths and converted to billionths of a degree
+bool NmeaParser::parseDegrees(const char* text, double& degrees) {
+    if (!isDigit(text[0])) {
+        return false;
+    }
+    uint32_t leftOfDecimal = parseUnsigned(text);
+    uint32_t multiplier = 10000000UL;
+    uint32_t tenMillionthsOfMinutes = (leftOfDecimal % 100) * multiplier;
+    while (isDigit(*text)) {
+        ++text;
+    }
+    if (*text == '.') {
+        while (isDigit(*++text) && multiplier > 1) {
+            multiplier /= 10;
+            tenMillionthsOfMinutes += static_cast<uint32_t>(*text - '0') * multiplier;
+        }
+    }
+    uint32_t billionths = (5 * tenMillionthsOfMinutes + 1) / 3;
+    degrees = (leftOfDecimal / 100) + billionths / 1000000000.0;
+    return true;
+}
@@ -0,0 +1,69 @@
+// ============================================
+// File: NmeaParser.h
+// Purpose: In-place NMEA 0183 parser for RMC, GGA and VTG sentences
+// Part of: GPS Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "gps/GPSFix.h"
+
+/*
+  Bytes are collected into one sentence buffer while the XOR checksum runs
+  alongside. At the line end the checksum is compared first; only a good
+  sentence is split into fields, in place (commas become terminators, the
+  fields are pointers into the buffer), and committed to the fix. Other
+  sentence types are checked and counted but not tokenized.
+
+  What is committed, and when, follows TinyGPSPlus so both backends publish
+  the same GPSFix: time and date always, position/speed/course only with an
+  RMC status of 'A', position/altitude only with a GGA quality above 0,
+  satellites and HDOP from every GGA, and values are kept in the same fixed
+  point (hundredths of knots, degrees, metres, HDOP; billionths of a degree).
+  Speed and course come from RMC, as with TinyGPSPlus; VTG is used only
+  by receivers that never send RMC, so one epoch never stamps the same
+  motion twice. Unlike TinyGPSPlus, which commits the previous value of
+  an empty field again as a fresh update, an empty field is skipped and
+  keeps its stamp, and any talker ID is accepted (GP, GN, GL, ...).
+*/
+class NmeaParser {
+public:
+    static constexpr size_t MAX_SENTENCE_LENGTH = 96;   // NMEA allows 82; some receivers run longer
+    static constexpr size_t MAX_FIELDS = 24;
+
+    // Feed one byte; true when an RMC, GGA or VTG sentence was committed
+    bool encode(char c, uint32_t nowMs);
+
+    inline const GPSFix& getFix() const { return fix; }
+    inline uint32_t passedChecksum() const { return passed; }
+    inline uint32_t failedChecksum() const { return failed; }
+
+private:
+    bool processSentence(uint32_t nowMs);
+    void commitRMC(char* const* field, size_t count, uint32_t nowMs);
+    void commitGGA(char* const* field, size_t count, uint32_t nowMs);
+    void commitVTG(char* const* field, size_t count, uint32_t nowMs);
+    void commitTime(const char* text, uint32_t nowMs);
+    void commitDate(const char* text, uint32_t nowMs);
+    bool commitLocation(const char* lat, const char* ns, const char* lng, const char* ew, uint32_t nowMs);
+
+    static int32_t parseHundredths(const char* text);
+    static bool parseDegrees(const char* text, double& degrees);
+    static int hexValue(char c);
+
+    char buffer[MAX_SENTENCE_LENGTH + 1];
+    size_t length = 0;
+    bool collecting = false;
+    bool inChecksum = false;    // past the '*'
+    uint8_t checksum = 0;       // XOR of the characters between '$' and '*'
+    bool rmcSeen = false;       // VTG is ignored from the first RMC on
+
+    GPSFix fix = {};
+    uint32_t passed = 0;
+    uint32_t failed = 0;
+};
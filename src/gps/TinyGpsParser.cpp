@@ -0,0 +1,72 @@
+// ============================================
+// File: TinyGpsParser.cpp
+// Purpose: TinyGPSPlus behind the NmeaParser interface, committing to a GPSFix
+// Part of: GPS Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include "TinyGpsParser.h"
+
+bool TinyGpsParser::encode(char c, uint32_t nowMs) {
+    if (!gps.encode(c)) {
+        return false;
+    }
+    commit(nowMs);
+    return true;
+}
+
+// Only fields the sentence just updated are read, which also clears TinyGPSPlus' updated flags
+void TinyGpsParser::commit(uint32_t nowMs) {
+    GPSFix& f = fix;
+
+    if (gps.location.isUpdated()) {
+        f.lat = gps.location.lat();
+        f.lng = gps.location.lng();
+        f.locationMs = nowMs;
+    }
+    if (gps.speed.isUpdated()) {
+        f.speedMps = static_cast<float>(gps.speed.mps());
+        f.speedMs = nowMs;
+    }
+    if (gps.course.isUpdated()) {
+        f.courseDeg = static_cast<float>(gps.course.deg());
+        f.courseMs = nowMs;
+    }
+    if (gps.altitude.isUpdated()) {
+        f.altitudeM = static_cast<float>(gps.altitude.meters());
+        f.altitudeMs = nowMs;
+    }
+    if (gps.hdop.isUpdated()) {
+        f.hdop = static_cast<float>(gps.hdop.hdop());
+        f.hdopMs = nowMs;
+    }
+    if (gps.satellites.isUpdated()) {
+        uint32_t count = gps.satellites.value();
+        f.satellites = static_cast<uint8_t>(count < UINT8_MAX ? count : UINT8_MAX);
+        f.satellitesMs = nowMs;
+    }
+    if (gps.date.isUpdated()) {
+        f.year = gps.date.year();
+        f.month = gps.date.month();
+        f.day = gps.date.day();
+        f.dateMs = nowMs;
+    }
+    if (gps.time.isUpdated()) {
+        f.hour = gps.time.hour();
+        f.minute = gps.time.minute();
+        f.second = gps.time.second();
+        f.centisecond = gps.time.centisecond();
+        f.timeMs = nowMs;
+    }
+
+    f.locationValid = gps.location.isValid();
+    f.speedValid = gps.speed.isValid();
+    f.courseValid = gps.course.isValid();
+    f.altitudeValid = gps.altitude.isValid();
+    f.hdopValid = gps.hdop.isValid();
+    f.satellitesValid = gps.satellites.isValid();
+    f.dateValid = gps.date.isValid();
+    f.timeValid = gps.time.isValid();
+}
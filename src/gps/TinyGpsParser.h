@@ -0,0 +1,34 @@
+// ============================================
+// File: TinyGpsParser.h
+// Purpose: TinyGPSPlus behind the NmeaParser interface, committing to a GPSFix
+// Part of: GPS Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <TinyGPSPlus.h>
+#include "gps/GPSFix.h"
+
+/*
+  Keeps its own GPSFix with millis() stamps, like NmeaParser, so the GPS
+  task publishes either backend the same way and the host test can feed
+  both the same bytes and compare the fixes field by field.
+*/
+class TinyGpsParser {
+public:
+    // Feed one byte; true when a sentence passed its checksum
+    bool encode(char c, uint32_t nowMs);
+
+    inline const GPSFix& getFix() const { return fix; }
+    inline uint32_t passedChecksum() const { return gps.passedChecksum(); }
+    inline uint32_t failedChecksum() const { return gps.failedChecksum(); }
+
+private:
+    void commit(uint32_t nowMs);
+
+    TinyGPSPlus gps;
+    GPSFix fix = {};
+};
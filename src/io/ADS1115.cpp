@@ -10,6 +10,7 @@
 // ============================================
 #include "ADS1115.h"
 #include "io/CircularBuffer.h"
+#include <esp_timer.h>
 
 // --- Allocate fixed-size buffers for each ADS1115 channel ---
 constexpr size_t ADS1115_BUF_SIZE = 8;
@@ -39,6 +40,10 @@ constexpr uint16_t ADS1115_PGA_TABLE[] = {
     0x0000, 0x0200, 0x0400, 0x0600, 0x0800, 0x0A00
 };
 
+constexpr uint16_t ADS1115_SPS_TABLE[] = {
+    8, 16, 32, 64, 128, 250, 475, 860
+};
+
 constexpr float ADS1115_FSR_TABLE[] = {
     6.144f, 4.096f, 2.048f, 1.024f, 0.512f, 0.256f
 };
@@ -66,10 +71,14 @@ void ADS1115::pushBuffer() {
     pushBuffer(ADS1115Channels::CH1); // Channel 1
     pushBuffer(ADS1115Channels::CH2); // Channel 2
     pushBuffer(ADS1115Channels::CH3); // Channel 3
+    _lastPushUs = esp_timer_get_time();
 }
 
 void ADS1115::pushBuffer(uint8_t channel) {
     int16_t raw = readSingleEnded(channel);
+    if (channel < 4) {
+        _latest[channel] = raw;
+    }
     if (channel == 0) {
         ch0.push(raw);
     } else if (channel == 1) {
@@ -89,6 +98,12 @@ float ADS1115::getFSR() const {
     return ADS1115_FSR_TABLE[static_cast<uint8_t>(_gain)];
 }
 
+// One conversion period plus 10% for the internal oscillator tolerance
+uint32_t ADS1115::getConversionTimeUs() const {
+    uint32_t sps = ADS1115_SPS_TABLE[static_cast<uint8_t>(_dataRate)];
+    return (1000000UL + sps - 1) / sps * 11 / 10;
+}
+
 bool ADS1115::_configure(uint16_t mux) {
     uint16_t config = _buildConfig(mux);
     _wire->beginTransmission(_i2cAddress);
@@ -122,7 +137,7 @@ int16_t ADS1115::_readConversionRegister() {
 int16_t ADS1115::readSingleEnded(uint8_t channel) {
     if (channel > 3) return INT16_MIN;
     if (!_configure(0x4000 | (channel << 12))) return INT16_MIN;
-    delay(10); // Simple conversion delay
+    delayMicroseconds(getConversionTimeUs()); // fixed wait keeps the sampling phase constant
     return _readConversionRegister();
 }
 
@@ -135,7 +150,7 @@ int16_t ADS1115::readDifferential(uint8_t channel1, uint8_t channel2) {
     else return INT16_MIN;
 
     if (!_configure(mux)) return INT16_MIN;
-    delay(10);
+    delayMicroseconds(getConversionTimeUs());
     return _readConversionRegister();
 }
 
@@ -146,6 +161,14 @@ int16_t ADS1115::readFiltered(uint8_t channel) {
            (channel == 3) ? ch3.average() : INT16_MIN;
 }
 
+int16_t ADS1115::readLatest(uint8_t channel) const {
+    return (channel < 4) ? _latest[channel] : INT16_MIN;
+}
+
+float ADS1115::readLatestVoltage(uint8_t channel) const {
+    return rawToVoltage(readLatest(channel));
+}
+
 float ADS1115::readFilteredVoltage(uint8_t channel) {
     return rawToVoltage(readFiltered(channel));
 }
@@ -59,6 +59,8 @@ public:
     int16_t readSingleEnded(uint8_t channel);
     int16_t readDifferential(uint8_t channel1, uint8_t channel2);
     int16_t readFiltered(uint8_t channel);
+    int16_t readLatest(uint8_t channel) const;
+    float readLatestVoltage(uint8_t channel) const;
     float readFilteredVoltage(uint8_t channel);
     float readFilteredCurrent(uint8_t channel);
 
@@ -71,6 +73,10 @@ public:
 
     Gain getGain() const;
     float getFSR() const;
+    uint32_t getConversionTimeUs() const;
+
+    // esp_timer time (µs) of the last completed pushBuffer() sweep
+    int64_t getLastPushMicros() const { return _lastPushUs; }
 
 private:
     ADS1115(TwoWire& wire = Wire) : _wire(&wire) {}
@@ -83,4 +89,6 @@ private:
     uint8_t _i2cAddress;
     Gain _gain = Gain::FSR_2_048V;
     DataRate _dataRate = DataRate::SPS_128;
+    volatile int64_t _lastPushUs = 0;
+    int16_t _latest[4] = {0, 0, 0, 0};
 };
@@ -0,0 +1,19 @@
+// ============================================
+// File: DispenserChannelPins.h
+// Purpose: Define hardware wiring of one dispenser section
+// Part of: Hardware Abstraction Layer (HAL)
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+#include "VNH7070ASPins.h"
+
+struct DispenserChannelPins {
+    VNH7070ASPins motor;
+    uint8_t positionAdcChannel;  // ADS1115 input of the gate potentiometer
+    uint8_t currentAdcChannel;   // ADS1115 input of the motor current sense
+};
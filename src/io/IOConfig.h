@@ -9,6 +9,17 @@
 // ============================================
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+
+// Dispenser sections: each one owns a motor driver, a gate potentiometer and a
+// current sense input. The ADS1115 provides four inputs, so this board wires two.
+constexpr size_t MAX_DISPENSER_CHANNELS = 8;
+constexpr size_t DISPENSER_CHANNEL_COUNT = 2;
+
+static_assert(DISPENSER_CHANNEL_COUNT > 0 && DISPENSER_CHANNEL_COUNT <= MAX_DISPENSER_CHANNELS,
+              "DISPENSER_CHANNEL_COUNT must be within 1..MAX_DISPENSER_CHANNELS");
+
 // Motor Driver 1 Pins
 constexpr int VNH7070AS_INA1Pin = 25;
 constexpr int VNH7070AS_INB1Pin = 14;
@@ -24,6 +35,7 @@ constexpr int VNH7070AS_SEL2Pin = 18;
 // GPS UART Pins
 constexpr int GPS_UART_RX_PIN = 13;
 constexpr int GPS_UART_TX_PIN = 21;
+constexpr uint32_t GPS_UART_BAUD = 9600;
 
 // RGB LED Pins
 constexpr int RGB_LEDRPin = 15;
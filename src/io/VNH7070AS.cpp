@@ -17,7 +17,7 @@
 
 void VNH7070AS::init(const VNH7070ASPins& pins, const int channel) {
     _pins = pins;
-    _pwmChannel = (channel == 0) ? LEDC_CHANNEL_0 : LEDC_CHANNEL_1;
+    _pwmChannel = static_cast<ledc_channel_t>(channel);
 
     // Initialize pins
     pinMode(_pins.INA, OUTPUT);
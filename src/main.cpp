@@ -9,9 +9,11 @@
 //
 // Structure:
 //   - setup(): Initializes system, BLE, timers
-//   - loop(): Processes periodic control tasks and GPS data
+//   - loop(): Processes deferred tasks, serial commands and log flushing
 //   - taskLoopUpdateCallback(): Task state and metrics updates
-//   - controlLoopUpdateCallback(): PI control loop updates
+//   - controlLoopUpdateCallback(): wakes the control task
+//   - controlTask(): ADC sweep -> PI -> actuator write, once per tick
+//   - gpsTask (GPSReceiver): UART events -> NMEA parse -> GPS fix snapshot
 //
 // License: Proprietary License
 // Author: Mehmet H Suzer
@@ -21,7 +23,6 @@
 #include <Arduino.h>
 #include <esp32/rom/rtc.h>
 #include <Wire.h>
-#include <TinyGPSPlus.h>
 #include <stdarg.h>  // Required for va_list, va_start, va_end
 #include "driver/ledc.h"
 
@@ -31,8 +32,12 @@
 #include "io/DS18B20Sensor.h"
 
 #include "core/SystemContext.h"
+#include "control/ControlLoop.h"
 #include "core/DebugInfoPrinter.h"
 #include "core/LogUtils.h"
+#include "core/LatencyProfiler.h"
+#include "core/JobSession.h"
+#include "core/JobRecorder.h"
 
 #include "serial/SerialHandler.h"
 
@@ -40,6 +45,11 @@
 #define TASK_LOOP_UPDATE_FREQUENCY_HZ         1  // Task loop frequency in Hz
 #define TIMER_PERIOD_US(Freq)                 (1000000ull / Freq)  // Period in microseconds
 
+// === Control Task ===
+#define CONTROL_TASK_STACK_SIZE               4096
+#define CONTROL_TASK_PRIORITY                 (configMAX_PRIORITIES - 5)  // above loop(), below BLE host
+#define CONTROL_TASK_CORE                     1
+
 
 // --- Create Services ---
 static SystemContext& context = SystemContext::instance();
@@ -52,9 +62,10 @@ char bufferB[bufferSize];
 SerialHandler serialHandler(bufferA, bufferB, bufferSize);
 
 // === Timer Setup ===
-portMUX_TYPE timerMux = portMUX_INITIALIZER_UNLOCKED;
-bool notifyDeferredTasks = false;
+volatile bool notifyDeferredTasks = false;
 static bool timeToRefresh = false;
+static TaskHandle_t controlTaskHandle = nullptr;
+static volatile int64_t controlTimerFireUs = 0;
 
 static void taskLoopUpdateCallback(void *p);
 static void controlLoopUpdateCallback(void *p);
@@ -63,18 +74,26 @@ static void controlLoopUpdateCallback(void *p);
 static void taskLoopUpdateCallback(void *p) {
   static int counterRefresh = 0;
 
-  DispenserChannel& left = context.getLeftChannel();
-  DispenserChannel& right = context.getRightChannel();
-
-  // Process each channel
-  left.checkLowSpeedState();
-  right.checkLowSpeedState();
+  // Every channel sees the same snapshot from the latest control tick
+  SensorFrame frame = context.getSensorFrame();
 
-  left.updateApplicationMetrics();
-  right.updateApplicationMetrics();
+  // Tank prediction first, so the channels below raise its warning this second
+  double areaM2 = 0.0;
+  bool dispensing = false;
+  for (size_t i = 0; i < context.getChannelCount(); ++i) {
+    const DispenserChannel& channel = context.getChannel(i);
+    areaM2 += channel.getTaskController().getMetrics().getSnapshot().areaM2;
+    dispensing |= channel.getTaskController().isTaskActive() && channel.isWorking(frame);
+  }
+  context.getTankEstimator().update(ApplicationMetrics::getTankLevel(), areaM2, dispensing, frame.timestampMs);
 
-  left.reportErrorFlags();
-  right.reportErrorFlags();
+  // Process each channel
+  for (size_t i = 0; i < context.getChannelCount(); ++i) {
+    DispenserChannel& channel = context.getChannel(i);
+    channel.checkLowSpeedState(frame);
+    channel.updateApplicationMetrics(frame);
+    channel.reportErrorFlags();
+  }
 
   // Auto-refresh
   int arPeriod = context.getParams().autoRefreshPeriod;
@@ -84,16 +103,35 @@ static void taskLoopUpdateCallback(void *p) {
   }
 }
 
-// periodic callback 10 Hz frequency
+// periodic callback 10 Hz frequency; only releases the control task
 static void controlLoopUpdateCallback(void *p) {
-  portENTER_CRITICAL_ISR(&timerMux);
+  controlTimerFireUs = esp_timer_get_time();
+  if (controlTaskHandle) {
+    xTaskNotifyGive(controlTaskHandle);
+  }
+}
 
-  context.getLeftChannel().applyPIControl();
-  context.getRightChannel().applyPIControl();
+// Sample -> compute -> actuate in a fixed order, so every decision uses the
+// ADC sweep taken at the start of the same tick and the delay stays constant.
+static void controlTask(void *p) {
+  ADS1115& ads1115 = context.getADS1115();
+
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    LatencyProfiler::markFire();
+    if (LatencyProfiler::isEnabled()) {
+      LatencyProfiler::recordWake(static_cast<uint32_t>(esp_timer_get_time() - controlTimerFireUs));
+    }
 
-  notifyDeferredTasks = true;
+    ads1115.pushBuffer(); // blocking I2C sweep
 
-  portEXIT_CRITICAL_ISR(&timerMux);
+    // No critical section: this task alone runs the passes, and state shared with
+    // loop() and the BLE task goes through SeqLocks, queues or requests applied here.
+    ControlLoop::tick(context);
+
+    notifyDeferredTasks = true;
+  }
 }
 
 esp_err_t setupPeriodicAlarmWrapper(const char* timerName, esp_timer_cb_t callback, uint64_t periodUs) {
@@ -131,20 +169,16 @@ esp_err_t setupMCPWM(void) {
     return ret;
   }
 
-  ledc_channel_config_t ledc_channel_0 = {VNH7070AS_PWM1Pin, LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_0, LEDC_INTR_DISABLE, LEDC_TIMER_0, 0, 0 };
-  ret = ledc_channel_config(&ledc_channel_0);
-
-  if (ret != ESP_OK) {
-    LogUtils::die("[MCPWM] ERROR configuring channel 0!\n");
-    return ret;
-  }
-
-  ledc_channel_config_t ledc_channel_1 = {VNH7070AS_PWM2Pin, LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_1, LEDC_INTR_DISABLE, LEDC_TIMER_0, 0, 0 };
-  ret = ledc_channel_config(&ledc_channel_1);
+  // One LEDC channel per dispenser section, matching VNH7070AS::init()
+  for (size_t i = 0; i < SystemContext::getChannelCount(); ++i) {
+    ledc_channel_t ledcChannel = static_cast<ledc_channel_t>(LEDC_CHANNEL_0 + i);
+    ledc_channel_config_t ledc_channel = {SystemContext::getChannelPins(i).motor.PWM, LEDC_HIGH_SPEED_MODE, ledcChannel, LEDC_INTR_DISABLE, LEDC_TIMER_0, 0, 0 };
+    ret = ledc_channel_config(&ledc_channel);
 
-  if (ret != ESP_OK) {
-    LogUtils::die("[MCPWM] ERROR configuring channel 1!\n");
-    return ret;
+    if (ret != ESP_OK) {
+      LogUtils::die("[MCPWM] ERROR configuring channel %u!\n", (unsigned) i);
+      return ret;
+    }
   }
 
   return ESP_OK;
@@ -177,7 +211,6 @@ void setup() {
   pinMode(RGB_LEDBPin, OUTPUT);
 
   Serial.begin(115200);
-  Serial1.begin(9600, SERIAL_8N1, GPS_UART_RX_PIN, GPS_UART_TX_PIN);
 
   context.writeRGBLEDs(LOW, HIGH, LOW);
 
@@ -200,6 +233,9 @@ void setup() {
   setupMCPWM(); // Initialize MCPWM for motor control
 
   context.init(); // Initialize all services
+
+  xTaskCreatePinnedToCore(controlTask, "controlTask", CONTROL_TASK_STACK_SIZE,
+    nullptr, CONTROL_TASK_PRIORITY, &controlTaskHandle, CONTROL_TASK_CORE);
   
   DebugInfoPrinter::printTempSensorStatus(context.getTempSensor());
 
@@ -209,29 +245,22 @@ void setup() {
 }
 
 void loop() {
-  ADS1115& ads1115 = context.getADS1115();
-  VNH7070AS& leftMotor = context.getLeftChannel().getMotor();
-  VNH7070AS& rightMotor = context.getRightChannel().getMotor();
-  TinyGPSPlus& gpsModule = context.getGPSModule();
-
   if (notifyDeferredTasks) {
     notifyDeferredTasks = false;
 
-    ads1115.pushBuffer(); // Push all channels to the buffer
+    SensorFrame frame = context.getSensorFrame();
+    for (size_t i = 0; i < context.getChannelCount(); ++i) {
+      DispenserChannel& channel = context.getChannel(i);
 
-    float current1 = ads1115.readFilteredCurrent(ADS1115Channels::CH2);
-    float current2 = ads1115.readFilteredCurrent(ADS1115Channels::CH3);
-  
-    if (leftMotor.checkStuck(current1)) {
-        LogUtils::warn("[MOTOR] Left Motor STUCK!\n");
-        context.getLeftChannel().getTaskController().getErrorManager().setError(MOTOR_STUCK);
-        context.getLeftChannel().getTaskController().setTaskState(UserTaskState::Paused);
-    }
+      if (channel.getMotor().checkStuck(frame.motorCurrent[i])) {
+          LogUtils::warn("[MOTOR] %s Motor STUCK!\n", channel.getName().c_str());
+          channel.getTaskController().getErrorManager().setError(MOTOR_STUCK);
+          channel.getTaskController().setTaskState(UserTaskState::Paused);
+      }
 
-    if (rightMotor.checkStuck(current2)) {
-        LogUtils::warn("[MOTOR] Right Motor STUCK!\n");
-        context.getRightChannel().getTaskController().getErrorManager().setError(MOTOR_STUCK);
-        context.getRightChannel().getTaskController().setTaskState(UserTaskState::Paused);
+      if (channel.getTaskController().reportTransitions(channel.getName().c_str())) {
+          CommandHandler::notifyTaskStateRejected(i, channel.getTaskController());
+      }
     }
   }
 
@@ -240,21 +269,23 @@ void loop() {
     serialHandler.onReceiveChar(c);
   }
 
-  while (Serial1.available()) {
-    char c = Serial1.read();
-    gpsModule.encode(c);
-  }
-
   serialHandler.process(); // Process any pending serial messages
 
+  JobSession::service(millis()); // wear-aware NVS copy of the job checkpoint
+  JobRecorder::service(context, millis()); // job history record, written when the job closes
+  context.getTimeSeriesLog().service(context.getGPSProvider().getUnixTime()); // staged samples to flash blocks
+  context.getAsAppliedLog().service(context.getGPSProvider().getUnixTime()); // staged map points to flash blocks
+
   if (timeToRefresh) {
     timeToRefresh = false;
-    if (context.getLeftChannel().isClientInWorkZone()) {
+    if (DispenserChannel::isClientInWorkZone()) {
       context.getCommandHandler().handlerGetTaskInfo({}); // pass empty ParsedInstruction
     }
 
-    // TODO make printMotorCurrent static
-    context.getLeftChannel().printMotorCurrent();
+    SensorFrame frame = context.getSensorFrame();
+    for (size_t i = 0; i < context.getChannelCount(); ++i) {
+      context.getChannel(i).printMotorCurrent(frame);
+    }
     DebugInfoPrinter::printAll(context);
   }
 }
@@ -0,0 +1,121 @@
+// ============================================
+// File: AsAppliedLog.cpp
+// Purpose: As-applied map stream: position and per-section actual rate over time
+// Part of: Storage Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include "AsAppliedLog.h"
+#include <string.h>
+#include "control/PIController.h"
+#include "storage/VarintCodec.h"
+
+static_assert(AsAppliedLog::MAX_POINT_BYTES < AsAppliedLog::PAYLOAD_CAPACITY, "point does not fit a block");
+
+bool AsAppliedLog::begin(FlashRegion* flashRegion) {
+    return ring.begin(flashRegion, MAGIC, "[AALOG]");
+}
+
+bool AsAppliedLog::isPointDue(bool gpsValid, uint32_t dispensingMask) {
+    uint32_t tick = tickCounter + 1;
+    tickCounter = tick;
+    if (!isReady() || !gpsValid) {
+        return false;
+    }
+
+    bool edge = dispensingMask != lastMask;
+    bool due = edge || (dispensingMask != 0 && tick - lastPointTick >= POINT_INTERVAL_TICKS);
+    if (due) {
+        lastMask = dispensingMask;
+        lastPointTick = tick;
+    }
+    return due;
+}
+
+void AsAppliedLog::push(AsAppliedPoint& point) {
+    point.tick = tickCounter;
+    if (!staging.push(point)) {
+        droppedPoints = droppedPoints + 1;
+        return;
+    }
+    lastStagedTick = point.tick;
+}
+
+void AsAppliedLog::service(uint32_t unixTime) {
+    if (!isReady()) {
+        return;
+    }
+
+    while (!staging.isEmpty()) {
+        const AsAppliedPoint& point = staging.front();
+        if (!blockOpen) {
+            startBlock(point, unixTime);
+        }
+        encode(point);
+        staging.pop();
+    }
+
+    if (blockOpen && tickCounter - lastStagedTick > IDLE_FLUSH_TICKS) {
+        flushBlock();
+    }
+}
+
+void AsAppliedLog::startBlock(const AsAppliedPoint& first, uint32_t unixTime) {
+    memset(&header, 0, sizeof(header));
+    header.version = VERSION;
+    header.channelCount = DISPENSER_CHANNEL_COUNT;
+    header.tickRateHz = CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
+    header.firstTick = first.tick;
+
+    uint32_t ageSec = (tickCounter - first.tick) / CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
+    header.unixTime = unixTime ? unixTime - ageSec : 0;
+
+    memset(&previous, 0, sizeof(previous));
+    previous.tick = first.tick;
+    payloadBytes = 0;
+    blockOpen = true;
+}
+
+void AsAppliedLog::encode(const AsAppliedPoint& point) {
+    uint8_t encoded[MAX_POINT_BYTES];
+    uint8_t* p = putVarint(encoded, point.tick - previous.tick);
+    p = putDelta(p, point.lat, previous.lat);
+    p = putDelta(p, point.lng, previous.lng);
+    for (size_t i = 0; i < DISPENSER_CHANNEL_COUNT; ++i) {
+        p = putDelta(p, point.rate[i], previous.rate[i]);
+    }
+    size_t length = p - encoded;
+
+    if (payloadBytes + length > PAYLOAD_CAPACITY || header.pointCount == UINT8_MAX) {
+        uint32_t unixTime = header.unixTime;
+        uint32_t elapsed = (point.tick - header.firstTick) / CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
+        flushBlock();
+        startBlock(point, 0);
+        header.unixTime = unixTime ? unixTime + elapsed : 0;
+        encode(point); // against the fresh zero reference
+        return;
+    }
+
+    memcpy(payload + payloadBytes, encoded, length);
+    payloadBytes += length;
+    ++header.pointCount;
+    ++pointCount;
+    previous = point;
+}
+
+void AsAppliedLog::flushBlock() {
+    blockOpen = false;
+    if (header.pointCount == 0) {
+        return;
+    }
+
+    float perPoint = static_cast<float>(payloadBytes) / header.pointCount;
+    bytesPerPoint = bytesPerPoint > 0.0f ? bytesPerPoint + 0.1f * (perPoint - bytesPerPoint) : perPoint;
+
+    uint8_t block[FlashBlockRing::MAX_PAYLOAD_BYTES];
+    memcpy(block, &header, sizeof(header));
+    memcpy(block + sizeof(header), payload, payloadBytes);
+    ring.append(block, sizeof(header) + payloadBytes);
+}
@@ -0,0 +1,112 @@
+// ============================================
+// File: AsAppliedLog.h
+// Purpose: As-applied map stream: position and per-section actual rate over time
+// Part of: Storage Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "io/IOConfig.h"
+#include "core/SpscRing.h"
+#include "storage/FlashBlockRing.h"
+
+// One map point, fixed point
+struct AsAppliedPoint {
+    uint32_t tick;                                  // control ticks since boot
+    int32_t lat;                                    // degrees × 1e7
+    int32_t lng;                                    // degrees × 1e7
+    uint16_t rate[DISPENSER_CHANNEL_COUNT];         // actual rate, kg/daa × 100, 0 while the section is shut
+};
+
+/*
+  Payload of one FlashBlockRing block, little endian:
+
+    header   AsAppliedBlockHeader
+    points   pointCount points, each encoded against the previous one:
+             varint(tick delta), zigzag varint deltas of lat and lng, then
+             one zigzag varint rate delta per section
+
+  The first point of a block is encoded against lat = lng = 0, zero rates
+  and the block's firstTick, so every block decodes on its own. At working
+  speed a point takes 7-9 bytes, about 25 points (25 s) per block.
+  tools/asapplied_decode.py turns downloaded blocks into CSV or GeoJSON.
+*/
+struct __attribute__((packed)) AsAppliedBlockHeader {
+    uint8_t version;
+    uint8_t channelCount;
+    uint8_t pointCount;
+    uint8_t tickRateHz;     // control ticks per second
+    uint32_t firstTick;     // ticks restart at 0 after a reboot
+    uint32_t unixTime;      // UTC seconds at firstTick, 0 without a GPS fix
+};
+
+/*
+  A point is taken once per POINT_INTERVAL_TICKS while any section is
+  dispensing with a GPS fix, and immediately whenever the set of dispensing
+  sections changes, so section on/off edges land where they happened; the
+  edge that shuts the last section writes a final all-zero point. Like the
+  time series, the control task only stages points and loop() encodes and
+  appends whole blocks, so nothing beyond one block is ever held in RAM.
+*/
+class AsAppliedLog {
+public:
+    static constexpr uint16_t MAGIC = 0x4141; // "AA"
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t PAYLOAD_CAPACITY = FlashBlockRing::MAX_PAYLOAD_BYTES - sizeof(AsAppliedBlockHeader);
+    static constexpr size_t MAX_POINT_BYTES = 5 + 2 * 5 + 3 * DISPENSER_CHANNEL_COUNT;
+    static constexpr uint32_t POINT_INTERVAL_TICKS = 10;    // 1 s at 10 Hz
+    static constexpr size_t STAGING_CAPACITY = 16;
+    static constexpr uint32_t IDLE_FLUSH_TICKS = 50;        // write a part-filled block 5 s after the last point
+
+    bool begin(FlashRegion* flashRegion);
+    bool isReady() const { return ring.isReady(); }
+
+    // Control task: advances the tick counter; true when this tick should produce a point.
+    // dispensingMask has bit i set while section i is dispensing.
+    bool isPointDue(bool gpsValid, uint32_t dispensingMask);
+    void push(AsAppliedPoint& point);
+
+    // loop(): encode staged points, append full blocks
+    void service(uint32_t unixTime);
+
+    // Streaming export, oldest block first; readNextBlock() returns 0 at the end
+    inline void rewindReader() { ring.rewindReader(); }
+    inline size_t readNextBlock(uint8_t* out, size_t outSize) { return ring.readNextBlock(out, outSize); }
+
+    inline uint32_t getSequence() const { return ring.getSequence(); }
+    inline size_t getRingBlocks() const { return ring.getRingBlocks(); }
+    inline uint32_t getPointCount() const { return pointCount; }
+    inline float getBytesPerPoint() const { return bytesPerPoint; }
+    inline uint32_t getDroppedPoints() const { return droppedPoints; }
+
+private:
+    void encode(const AsAppliedPoint& point);
+    void startBlock(const AsAppliedPoint& first, uint32_t unixTime);
+    void flushBlock();
+
+    FlashBlockRing ring;
+
+    // Control task only
+    uint32_t lastMask = 0;
+    uint32_t lastPointTick = 0;
+
+    // Control task -> loop(), single producer / single consumer
+    SpscRing<AsAppliedPoint, STAGING_CAPACITY> staging;
+    volatile uint32_t tickCounter = 0;
+    volatile uint32_t lastStagedTick = 0;
+    volatile uint32_t droppedPoints = 0;
+
+    // Block being filled, loop() only
+    AsAppliedBlockHeader header;
+    uint8_t payload[PAYLOAD_CAPACITY];
+    size_t payloadBytes = 0;
+    AsAppliedPoint previous;
+    bool blockOpen = false;
+    uint32_t pointCount = 0;
+    float bytesPerPoint = 0.0f;
+};
@@ -0,0 +1,146 @@
+// ============================================
+// File: FlashBlockRing.cpp
+// Purpose: Ring of self-checking, page-sized blocks in a flash region
+// Part of: Storage Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include "FlashBlockRing.h"
+#include <string.h>
+#include <esp_crc.h>
+#include "core/LogUtils.h"
+
+static_assert(FlashBlockRing::MAX_BLOCK_BYTES <= FlashBlockRing::BLOCK_SLOT_SIZE, "block does not fit its slot");
+
+bool FlashBlockRing::begin(FlashRegion* flashRegion, uint16_t blockMagic, const char* logTag) {
+    tag = logTag;
+    size_t sectorSize = flashRegion->getSectorSize();
+    if (flashRegion->getSize() < 2 * sectorSize || sectorSize % BLOCK_SLOT_SIZE != 0) {
+        LogUtils::error("%s Region too small or misaligned, log disabled.\n", tag);
+        return false;
+    }
+
+    magic = blockMagic;
+    blocksPerSector = sectorSize / BLOCK_SLOT_SIZE;
+    blockCount = flashRegion->getSize() / BLOCK_SLOT_SIZE;
+    ringSectors = blockCount / blocksPerSector;
+    region = flashRegion;
+
+    // A header can be torn too (bits still erased read as ones), so a candidate only
+    // becomes the newest once its CRC checks out; all-ones would also wrap the sequence.
+    static uint8_t scratch[MAX_BLOCK_BYTES];
+    FlashBlockHeader h;
+    bool found = false;
+    size_t newest = 0;
+    for (size_t block = 0; block < blockCount; ++block) {
+        if (readHeader(block, h) && h.sequence != UINT32_MAX && (!found || h.sequence >= sequence) &&
+            readBlock(block, h, scratch)) {
+            sequence = h.sequence + 1;
+            newest = block;
+            found = true;
+        }
+    }
+    headBlock = found ? newest + 1 : 0;
+    if (headBlock >= getRingBlocks()) {
+        headBlock = 0;
+    }
+
+    LogUtils::info("%s Next block #%u at slot %u of %u\n", tag,
+                   static_cast<unsigned>(sequence), static_cast<unsigned>(headBlock), static_cast<unsigned>(blockCount));
+    return true;
+}
+
+void FlashBlockRing::setRingSectors(size_t sectors) {
+    size_t total = getTotalSectors();
+    ringSectors = sectors < 2 ? 2 : (sectors > total ? total : sectors);
+}
+
+uint32_t FlashBlockRing::computeCrc(const FlashBlockHeader& h, const uint8_t* data) const {
+    uint32_t crc = esp_crc32_le(0, reinterpret_cast<const uint8_t*>(&h), offsetof(FlashBlockHeader, crc));
+    return esp_crc32_le(crc, data, h.payloadBytes);
+}
+
+bool FlashBlockRing::readHeader(size_t block, FlashBlockHeader& h) const {
+    return region->read(block * BLOCK_SLOT_SIZE, &h, sizeof(h)) &&
+           h.magic == magic && h.payloadBytes <= MAX_PAYLOAD_BYTES;
+}
+
+// Whole block into out (header + payload, room for MAX_BLOCK_BYTES), true when the CRC matches
+bool FlashBlockRing::readBlock(size_t block, const FlashBlockHeader& h, uint8_t* out) const {
+    return region->read(block * BLOCK_SLOT_SIZE, out, sizeof(h) + h.payloadBytes) &&
+           computeCrc(h, out + sizeof(h)) == h.crc;
+}
+
+// Erase ahead at a sector start; a dirty slot elsewhere (torn write) skips to the next sector
+bool FlashBlockRing::prepareSlot() {
+    if (headBlock >= getRingBlocks()) {
+        headBlock = 0;
+    }
+
+    if (headBlock % blocksPerSector != 0) {
+        uint32_t first;
+        if (region->read(headBlock * BLOCK_SLOT_SIZE, &first, sizeof(first)) && first == 0xFFFFFFFF) {
+            return true;
+        }
+        headBlock = (headBlock / blocksPerSector + 1) * blocksPerSector;
+        if (headBlock >= getRingBlocks()) {
+            headBlock = 0;
+        }
+    }
+    return region->eraseSector(headBlock * BLOCK_SLOT_SIZE);
+}
+
+bool FlashBlockRing::append(const uint8_t* payload, size_t length) {
+    if (!isReady() || length > MAX_PAYLOAD_BYTES) {
+        return false;
+    }
+
+    FlashBlockHeader h;
+    h.magic = magic;
+    h.payloadBytes = static_cast<uint16_t>(length);
+    h.sequence = sequence;
+    h.crc = computeCrc(h, payload);
+
+    uint8_t block[MAX_BLOCK_BYTES];
+    memcpy(block, &h, sizeof(h));
+    memcpy(block + sizeof(h), payload, length);
+
+    bool ok = prepareSlot() && region->write(headBlock * BLOCK_SLOT_SIZE, block, sizeof(h) + length);
+    if (!ok) {
+        LogUtils::error("%s Write of block #%u failed\n", tag, static_cast<unsigned>(sequence));
+    }
+    ++headBlock;
+    ++sequence;
+    return ok;
+}
+
+void FlashBlockRing::rewindReader() {
+    readerBlock = headBlock < blockCount ? headBlock : 0;
+    readerRemaining = isReady() ? blockCount : 0;
+    readerEndSeq = sequence;
+    readerFirstSeq = sequence > getRingBlocks() ? sequence - getRingBlocks() : 0;
+}
+
+size_t FlashBlockRing::readNextBlock(uint8_t* out, size_t outSize) {
+    FlashBlockHeader h;
+
+    while (readerRemaining > 0) {
+        size_t block = readerBlock;
+        readerBlock = (readerBlock + 1) % blockCount;
+        --readerRemaining;
+
+        // Blocks outside the window predate a ring size change or were written after the rewind
+        if (!readHeader(block, h) || h.sequence < readerFirstSeq || h.sequence >= readerEndSeq) {
+            continue;
+        }
+
+        size_t length = sizeof(h) + h.payloadBytes;
+        if (length > outSize || !readBlock(block, h, out)) {
+            continue;
+        }
+        return length;
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+// ============================================
+// File: FlashBlockRing.h
+// Purpose: Ring of self-checking, page-sized blocks in a flash region
+// Part of: Storage Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "storage/FlashRegion.h"
+
+// Little endian, at the start of every slot
+struct __attribute__((packed)) FlashBlockHeader {
+    uint16_t magic;         // which log the block belongs to
+    uint16_t payloadBytes;
+    uint32_t sequence;      // increases by one per block, across reboots
+    uint32_t crc;           // over the header up to here and the payload
+};
+
+/*
+  One block per flash program page and per BLE notification. The first
+  block of a sector erases that sector; a slot that is not blank when its
+  turn comes (torn write, reboot mid-sector) skips the rest of the sector.
+  At boot the newest sequence is taken from the blocks whose CRC matches,
+  so a torn header cannot send the ring to the wrong slot; CRCs are
+  checked again when a block is read back.
+
+  The ring can be limited to the first N sectors of the region. Blocks left
+  beyond it from a larger setting are ignored by the reader through the
+  sequence window, so shrinking never exports stale data out of order.
+*/
+class FlashBlockRing {
+public:
+    static constexpr size_t BLOCK_SLOT_SIZE = 256;      // flash program page
+    static constexpr size_t MAX_BLOCK_BYTES = 244;      // header + payload, one BLE notification
+    static constexpr size_t MAX_PAYLOAD_BYTES = MAX_BLOCK_BYTES - sizeof(FlashBlockHeader);
+
+    bool begin(FlashRegion* flashRegion, uint16_t blockMagic, const char* logTag);
+    bool isReady() const { return region != nullptr; }
+
+    // Clamped to 2..all sectors
+    void setRingSectors(size_t sectors);
+
+    bool append(const uint8_t* payload, size_t length);
+
+    // Streaming export, oldest block first; readNextBlock() returns header + payload, 0 at the end
+    void rewindReader();
+    size_t readNextBlock(uint8_t* out, size_t outSize);
+
+    inline uint32_t getSequence() const { return sequence; }
+    inline size_t getTotalSectors() const { return blocksPerSector ? blockCount / blocksPerSector : 0; }
+    inline size_t getRingSectors() const { return ringSectors; }
+    inline size_t getRingBlocks() const { return ringSectors * blocksPerSector; }
+    inline size_t getBlocksPerSector() const { return blocksPerSector; }
+    inline bool isAtSectorStart() const { return blocksPerSector && headBlock % blocksPerSector == 0; } // next append erases
+
+private:
+    bool prepareSlot();
+    uint32_t computeCrc(const FlashBlockHeader& header, const uint8_t* payload) const;
+    bool readHeader(size_t block, FlashBlockHeader& header) const;
+    bool readBlock(size_t block, const FlashBlockHeader& header, uint8_t* out) const;
+
+    FlashRegion* region = nullptr;
+    uint16_t magic = 0;
+    const char* tag = "";
+    size_t blockCount = 0;
+    size_t blocksPerSector = 0;
+    size_t ringSectors = 0;
+    size_t headBlock = 0;           // next slot to program
+    uint32_t sequence = 0;          // of the next block
+
+    // Export cursor
+    size_t readerBlock = 0;
+    size_t readerRemaining = 0;
+    uint32_t readerFirstSeq = 0;
+    uint32_t readerEndSeq = 0;
+};
@@ -0,0 +1,50 @@
+// ============================================
+// File: FlashRegion.cpp
+// Purpose: Raw erase/program access to one flash area for on-device logs
+// Part of: Storage Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include "FlashRegion.h"
+#include <esp_partition.h>
+#include "core/LogUtils.h"
+
+static inline const esp_partition_t* asPartition(const void* p) {
+    return static_cast<const esp_partition_t*>(p);
+}
+
+bool PartitionFlashRegion::open(const char* label) {
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (partition == nullptr) {
+        LogUtils::error("[FLASH] Partition '%s' not found, check partitions.csv\n", label);
+        return false;
+    }
+
+    LogUtils::info("[FLASH] Partition '%s': %u KB at 0x%06x\n", label,
+                   static_cast<unsigned>(asPartition(partition)->size / 1024),
+                   static_cast<unsigned>(asPartition(partition)->address));
+    return true;
+}
+
+bool PartitionFlashRegion::read(size_t offset, void* data, size_t length) {
+    return partition && esp_partition_read(asPartition(partition), offset, data, length) == ESP_OK;
+}
+
+bool PartitionFlashRegion::write(size_t offset, const void* data, size_t length) {
+    return partition && esp_partition_write(asPartition(partition), offset, data, length) == ESP_OK;
+}
+
+bool PartitionFlashRegion::eraseSector(size_t offset) {
+    size_t sector = getSectorSize();
+    return partition && esp_partition_erase_range(asPartition(partition), offset - offset % sector, sector) == ESP_OK;
+}
+
+size_t PartitionFlashRegion::getSize() const {
+    return partition ? asPartition(partition)->size : 0;
+}
+
+size_t PartitionFlashRegion::getSectorSize() const {
+    return SPI_FLASH_SEC_SIZE;
+}
@@ -0,0 +1,46 @@
+// ============================================
+// File: FlashRegion.h
+// Purpose: Raw erase/program access to one flash area for on-device logs
+// Part of: Storage Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+  NOR flash semantics: erase sets a whole sector to 0xFF, writes can only
+  clear bits. Logs built on top never rewrite a byte without erasing its
+  sector first. The interface exists so the same log code can run against
+  a file-backed stand-in on a host build.
+*/
+class FlashRegion {
+public:
+    virtual ~FlashRegion() {}
+
+    virtual bool read(size_t offset, void* data, size_t length) = 0;
+    virtual bool write(size_t offset, const void* data, size_t length) = 0;
+    virtual bool eraseSector(size_t offset) = 0;
+    virtual size_t getSize() const = 0;
+    virtual size_t getSectorSize() const = 0;
+};
+
+// A data partition from partitions.csv, located by label
+class PartitionFlashRegion : public FlashRegion {
+public:
+    bool open(const char* label);
+    bool isOpen() const { return partition != nullptr; }
+
+    bool read(size_t offset, void* data, size_t length) override;
+    bool write(size_t offset, const void* data, size_t length) override;
+    bool eraseSector(size_t offset) override;
+    size_t getSize() const override;
+    size_t getSectorSize() const override;
+
+private:
+    const void* partition = nullptr; // esp_partition_t, kept opaque to keep ESP-IDF out of this header
+};
@@ -0,0 +1,177 @@
+// ============================================
+// File: JobLog.cpp
+// Purpose: Append-only job history in a dedicated flash partition
+// Part of: Storage Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include "JobLog.h"
+#include <string.h>
+#include <esp_crc.h>
+#include "core/LogUtils.h"
+
+static_assert(JobLog::getSlotSize() >= sizeof(JobRecord), "JobRecord does not fit its slot");
+
+uint32_t JobLog::computeCrc(const JobRecord& record) const {
+    return esp_crc32_le(0, reinterpret_cast<const uint8_t*>(&record), offsetof(JobRecord, crc));
+}
+
+bool JobLog::readSlot(size_t slot, JobRecord& out) const {
+    if (!region->read(slot * getSlotSize(), &out, sizeof(out))) {
+        return false;
+    }
+    return out.magic == MAGIC && out.channelCount == DISPENSER_CHANNEL_COUNT && out.crc == computeCrc(out);
+}
+
+bool JobLog::isSlotBlank(size_t slot) const {
+    uint32_t words[getSlotSize() / sizeof(uint32_t)];
+    if (!region->read(slot * getSlotSize(), words, sizeof(words))) {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); ++i) {
+        if (words[i] != 0xFFFFFFFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool JobLog::begin(FlashRegion* flashRegion) {
+    size_t sectorSize = flashRegion->getSectorSize();
+    if (flashRegion->getSize() < 2 * sectorSize || sectorSize % getSlotSize() != 0) {
+        LogUtils::error("[JOBLOG] Region too small or misaligned, job history disabled.\n");
+        return false;
+    }
+
+    region = flashRegion;
+    slotsPerSector = sectorSize / getSlotSize();
+    slotCount = region->getSize() / getSlotSize();
+
+    // The newest record marks the write position
+    JobRecord record;
+    bool found = false;
+    size_t newestSlot = 0;
+    for (size_t slot = 0; slot < slotCount; ++slot) {
+        if (readSlot(slot, record) && (!found || record.jobNumber >= nextJobNumber)) {
+            nextJobNumber = record.jobNumber + 1;
+            newestSlot = slot;
+            found = true;
+        }
+    }
+    headSlot = found ? (newestSlot + 1) % slotCount : 0;
+
+    // Walking the ring from the write position visits records oldest first
+    for (size_t i = 0; i < slotCount; ++i) {
+        size_t slot = (headSlot + i) % slotCount;
+        if (readSlot(slot, record) && (count == 0 || record.jobNumber > getLastJob())) {
+            pushIndex(record, slot);
+        }
+    }
+
+    LogUtils::info("[JOBLOG] %u jobs stored (#%u..#%u), capacity %u\n",
+                   static_cast<unsigned>(count), static_cast<unsigned>(getFirstJob()),
+                   static_cast<unsigned>(getLastJob()), static_cast<unsigned>(getCapacity()));
+    return true;
+}
+
+size_t JobLog::getCapacity() const {
+    // One sector is always being recycled
+    size_t capacity = slotCount - slotsPerSector;
+    return capacity < MAX_INDEX_ENTRIES ? capacity : MAX_INDEX_ENTRIES;
+}
+
+void JobLog::pushIndex(const JobRecord& record, size_t slot) {
+    if (count == MAX_INDEX_ENTRIES) {
+        tail = (tail + 1) % MAX_INDEX_ENTRIES;
+        --count;
+    }
+    IndexEntry& entry = index[(tail + count) % MAX_INDEX_ENTRIES];
+    entry.jobNumber = record.jobNumber;
+    entry.startTime = record.startTime;
+    entry.slot = static_cast<uint16_t>(slot);
+    ++count;
+}
+
+// Erasing a sector removes the oldest records, which sit at the tail of the index
+void JobLog::dropSector(size_t sector) {
+    while (count > 0 && index[tail].slot / slotsPerSector == sector) {
+        tail = (tail + 1) % MAX_INDEX_ENTRIES;
+        --count;
+    }
+}
+
+bool JobLog::append(JobRecord& record) {
+    if (!isReady()) {
+        return false;
+    }
+
+    // A torn write leaves a dirty slot behind; start over on a freshly erased sector
+    if (headSlot % slotsPerSector != 0 && !isSlotBlank(headSlot)) {
+        LogUtils::warn("[JOBLOG] Slot %u not blank, skipping to next sector\n", static_cast<unsigned>(headSlot));
+        headSlot = (headSlot / slotsPerSector + 1) * slotsPerSector % slotCount;
+    }
+
+    if (headSlot % slotsPerSector == 0) {
+        size_t sector = headSlot / slotsPerSector;
+        dropSector(sector);
+        if (!region->eraseSector(sector * region->getSectorSize())) {
+            LogUtils::error("[JOBLOG] Erase of sector %u failed\n", static_cast<unsigned>(sector));
+            return false;
+        }
+    }
+
+    record.magic = MAGIC;
+    record.jobNumber = nextJobNumber;
+    record.channelCount = DISPENSER_CHANNEL_COUNT;
+    memset(record.reserved, 0, sizeof(record.reserved));
+    record.crc = computeCrc(record);
+
+    size_t slot = headSlot;
+    headSlot = (headSlot + 1) % slotCount;  // a failed write still uses up the slot
+
+    JobRecord check;
+    if (!region->write(slot * getSlotSize(), &record, sizeof(record)) || !readSlot(slot, check)) {
+        LogUtils::error("[JOBLOG] Write of job #%u failed\n", static_cast<unsigned>(record.jobNumber));
+        return false;
+    }
+
+    ++nextJobNumber;
+    pushIndex(record, slot);
+    LogUtils::info("[JOBLOG] Job #%u saved to slot %u\n", static_cast<unsigned>(record.jobNumber), static_cast<unsigned>(slot));
+    return true;
+}
+
+size_t JobLog::lowerBound(uint32_t jobNumber) const {
+    size_t lo = 0;
+    size_t hi = count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (getEntry(mid).jobNumber < jobNumber) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+bool JobLog::readJob(uint32_t jobNumber, JobRecord& out) const {
+    size_t position = lowerBound(jobNumber);
+    if (position >= count || getEntry(position).jobNumber != jobNumber) {
+        return false;
+    }
+    return readSlot(getEntry(position).slot, out);
+}
+
+// Start times are not monotonic (jobs without a fix have none), so this is a linear scan of RAM
+uint32_t JobLog::findFirstJobAtOrAfter(uint32_t unixTime) const {
+    for (size_t i = 0; i < count; ++i) {
+        const IndexEntry& entry = getEntry(i);
+        if (entry.startTime != 0 && entry.startTime >= unixTime) {
+            return entry.jobNumber;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+// ============================================
+// File: JobLog.h
+// Purpose: Append-only job history in a dedicated flash partition
+// Part of: Storage Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "io/IOConfig.h"
+#include "control/ErrorManager.h"
+#include "storage/FlashRegion.h"
+
+// Per-channel result of one job; floats are plenty for a single job's totals
+struct __attribute__((packed)) JobChannelSummary {
+    float areaM2;
+    float consumptionKg;
+    float distanceM;
+    uint32_t durationSec;
+    float avgRateErrorPct;                      // mean |flow rate error| while dispensing
+    uint16_t errorSeconds[ERROR_FLAG_COUNT];    // seconds each UserErrorCodes bit was set
+};
+
+struct __attribute__((packed)) JobRecord {
+    uint32_t magic;
+    uint32_t jobNumber;       // increases by one per job, never reused
+    uint32_t startTime;       // UTC seconds from GPS, 0 if there was no fix
+    uint32_t endTime;
+    uint32_t wallSeconds;     // from millis(), valid without GPS
+    uint8_t channelCount;
+    uint8_t reserved[3];
+    JobChannelSummary channels[DISPENSER_CHANNEL_COUNT];
+    uint32_t crc;             // over everything above
+};
+
+/*
+  Records go into fixed-size slots written round-robin over the partition,
+  so every sector is erased equally often. A sector is erased just before
+  its first slot is written, which drops the oldest records it held. A
+  slot that is not blank when its turn comes (a write torn by power loss)
+  makes the log skip to the next sector.
+
+  The boot scan rebuilds a RAM index of {job, start time, slot} in job
+  order, so lookups by job number or date never scan the flash. Flash
+  writes stall both cores for the erase, so append() is only called from
+  loop(), at most once per job.
+*/
+class JobLog {
+public:
+    static constexpr uint32_t MAGIC = 0x4A4C4F47; // "JLOG"
+    static constexpr size_t MAX_INDEX_ENTRIES = 512;
+
+    struct IndexEntry {
+        uint32_t jobNumber;
+        uint32_t startTime;
+        uint16_t slot;
+    };
+
+    bool begin(FlashRegion* flashRegion);
+    bool isReady() const { return region != nullptr; }
+
+    // Assigns the job number and CRC, then writes the record
+    bool append(JobRecord& record);
+
+    bool readJob(uint32_t jobNumber, JobRecord& out) const;
+    uint32_t findFirstJobAtOrAfter(uint32_t unixTime) const;  // 0 if none
+    size_t lowerBound(uint32_t jobNumber) const;               // index position of the first job >= jobNumber
+
+    size_t getCount() const { return count; }
+    const IndexEntry& getEntry(size_t position) const { return index[(tail + position) % MAX_INDEX_ENTRIES]; }
+    uint32_t getFirstJob() const { return count ? getEntry(0).jobNumber : 0; }
+    uint32_t getLastJob() const { return count ? getEntry(count - 1).jobNumber : 0; }
+    size_t getCapacity() const;  // records kept once the log has wrapped
+
+    static constexpr size_t getSlotSize() { return nextPowerOfTwo(sizeof(JobRecord)); }
+
+private:
+    static constexpr size_t nextPowerOfTwo(size_t n, size_t p = 1) { return p >= n ? p : nextPowerOfTwo(n, p * 2); }
+
+    uint32_t computeCrc(const JobRecord& record) const;
+    bool readSlot(size_t slot, JobRecord& out) const;
+    bool isSlotBlank(size_t slot) const;
+    void dropSector(size_t sector);
+    void pushIndex(const JobRecord& record, size_t slot);
+
+    FlashRegion* region = nullptr;
+    size_t slotCount = 0;
+    size_t slotsPerSector = 0;
+    size_t headSlot = 0;        // next slot to write
+    uint32_t nextJobNumber = 1;
+
+    IndexEntry index[MAX_INDEX_ENTRIES];  // ring, oldest at tail
+    size_t tail = 0;
+    size_t count = 0;
+};
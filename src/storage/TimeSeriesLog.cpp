@@ -0,0 +1,172 @@
+// ============================================
+// File: TimeSeriesLog.cpp
+// Purpose: Control-rate recording of gate, speed and rate signals into a flash ring
+// Part of: Storage Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include "TimeSeriesLog.h"
+#include <string.h>
+#include <math.h>
+#include "control/PIController.h"
+#include "storage/VarintCodec.h"
+
+static_assert(TimeSeriesLog::MAX_SAMPLE_BYTES < TimeSeriesLog::PAYLOAD_CAPACITY, "sample does not fit a block");
+
+bool TimeSeriesLog::begin(FlashRegion* flashRegion) {
+    if (!ring.begin(flashRegion, MAGIC, "[TSLOG]")) {
+        return false;
+    }
+    applySettings();
+    ring.setRingSectors(computeRingSectors());
+    return true;
+}
+
+void TimeSeriesLog::setDecimation(uint8_t ticks) {
+    Settings settings = requested.read();
+    settings.decimation = ticks < 1 ? 1 : (ticks > MAX_DECIMATION ? MAX_DECIMATION : ticks);
+    requested.write(settings);
+}
+
+void TimeSeriesLog::setRetentionMinutes(uint16_t minutes) {
+    Settings settings = requested.read();
+    settings.retentionMinutes = minutes;
+    requested.write(settings);
+}
+
+// loop() only: the ring is resized between appends, never under one
+void TimeSeriesLog::applySettings() {
+    uint32_t sequence = requested.getSequence();
+    if (sequence == takenSequence || (sequence & 1u)) {
+        return;
+    }
+    Settings settings = requested.read();
+    if (requested.getSequence() != sequence) {
+        return; // overwritten while reading: take the newer one next pass
+    }
+    takenSequence = sequence;
+
+    // The open block's header carries the decimation its samples were taken at
+    if (blockOpen && settings.decimation != decimation) {
+        flushBlock();
+    }
+    decimation = settings.decimation;
+    retentionMinutes = settings.retentionMinutes;
+    if (isReady()) {
+        ring.setRingSectors(computeRingSectors());
+    }
+}
+
+// One sector more than the retention needs, since the oldest sector is the one being recycled
+size_t TimeSeriesLog::computeRingSectors() const {
+    size_t total = ring.getTotalSectors();
+    if (retentionMinutes == 0) {
+        return total;
+    }
+
+    float samplesPerMinute = 60.0f * CONTROL_LOOP_UPDATE_FREQUENCY_HZ / decimation;
+    float samplesPerBlock = PAYLOAD_CAPACITY / bytesPerSample;
+    float blocks = retentionMinutes * samplesPerMinute / samplesPerBlock;
+    return static_cast<size_t>(ceilf(blocks / ring.getBlocksPerSector())) + 1;
+}
+
+bool TimeSeriesLog::isSampleDue(bool recording) {
+    uint32_t tick = tickCounter + 1;
+    tickCounter = tick;
+    return recording && isReady() && tick % decimation == 0;
+}
+
+void TimeSeriesLog::push(TimeSeriesSample& sample) {
+    sample.tick = tickCounter;
+    if (!staging.push(sample)) {
+        droppedSamples = droppedSamples + 1; // loop() stalled; the tick gap shows in the data
+        return;
+    }
+    lastSampleTick = sample.tick;
+}
+
+void TimeSeriesLog::service(uint32_t unixTime) {
+    if (!isReady()) {
+        return;
+    }
+
+    while (!staging.isEmpty()) {
+        const TimeSeriesSample& sample = staging.front();
+        if (!blockOpen) {
+            startBlock(sample, unixTime);
+        }
+        encode(sample);
+        staging.pop();
+    }
+    applySettings();
+
+    if (blockOpen && tickCounter - lastSampleTick > IDLE_FLUSH_TICKS) {
+        flushBlock();
+    }
+}
+
+void TimeSeriesLog::startBlock(const TimeSeriesSample& first, uint32_t unixTime) {
+    memset(&header, 0, sizeof(header));
+    header.version = VERSION;
+    header.channelCount = DISPENSER_CHANNEL_COUNT;
+    header.firstTick = first.tick;
+    header.decimation = decimation;
+
+    // The sample was staged a few ticks ago at most
+    uint32_t ageSec = (tickCounter - first.tick) / CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
+    header.unixTime = unixTime ? unixTime - ageSec : 0;
+
+    memset(&previous, 0, sizeof(previous));
+    previous.tick = first.tick;
+    payloadBytes = 0;
+    blockOpen = true;
+}
+
+void TimeSeriesLog::encode(const TimeSeriesSample& sample) {
+    uint8_t encoded[MAX_SAMPLE_BYTES];
+    uint8_t* p = putVarint(encoded, sample.tick - previous.tick);
+    p = putDelta(p, sample.speed, previous.speed);
+    for (size_t i = 0; i < DISPENSER_CHANNEL_COUNT; ++i) {
+        p = putDelta(p, sample.position[i], previous.position[i]);
+        p = putDelta(p, sample.target[i], previous.target[i]);
+        p = putDelta(p, sample.rate[i], previous.rate[i]);
+        p = putDelta(p, sample.errorFlags[i], previous.errorFlags[i]);
+    }
+    size_t length = p - encoded;
+
+    if (payloadBytes + length > PAYLOAD_CAPACITY || header.sampleCount == UINT8_MAX) {
+        uint32_t unixTime = header.unixTime;
+        uint32_t elapsed = (sample.tick - header.firstTick) / CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
+        flushBlock();
+        startBlock(sample, 0);
+        header.unixTime = unixTime ? unixTime + elapsed : 0;
+        encode(sample); // against the fresh zero reference
+        return;
+    }
+
+    memcpy(payload + payloadBytes, encoded, length);
+    payloadBytes += length;
+    ++header.sampleCount;
+    previous = sample;
+}
+
+void TimeSeriesLog::flushBlock() {
+    blockOpen = false;
+    if (header.sampleCount == 0) {
+        return;
+    }
+
+    // Ring size follows the measured compression, re-evaluated once per sector before it is erased
+    const float alpha = 0.1f;
+    bytesPerSample += alpha * (static_cast<float>(payloadBytes) / header.sampleCount - bytesPerSample);
+    if (ring.isAtSectorStart()) {
+        ring.setRingSectors(computeRingSectors());
+    }
+
+    uint8_t block[FlashBlockRing::MAX_PAYLOAD_BYTES];
+    memcpy(block, &header, sizeof(header));
+    memcpy(block + sizeof(header), payload, payloadBytes);
+    ring.append(block, sizeof(header) + payloadBytes);
+}
@@ -0,0 +1,135 @@
+// ============================================
+// File: TimeSeriesLog.h
+// Purpose: Control-rate recording of gate, speed and rate signals into a flash ring
+// Part of: Storage Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "io/IOConfig.h"
+#include "core/SpscRing.h"
+#include "core/SeqLock.h"
+#include "storage/FlashBlockRing.h"
+
+// One recorded control tick, fixed point
+struct TimeSeriesSample {
+    uint32_t tick;                                  // control ticks since boot
+    int16_t speed;                                  // ground speed, m/s × 100
+    int16_t position[DISPENSER_CHANNEL_COUNT];      // gate position, % × 100
+    int16_t target[DISPENSER_CHANNEL_COUNT];        // shaped target, % × 100
+    int16_t rate[DISPENSER_CHANNEL_COUNT];          // estimated flow, kg/min × 100
+    uint16_t errorFlags[DISPENSER_CHANNEL_COUNT];   // UserErrorCodes
+};
+
+/*
+  Payload of one FlashBlockRing block, little endian:
+
+    header   TimeSeriesBlockHeader
+    samples  sampleCount samples, each encoded against the previous one:
+             varint(tick delta), then zigzag varint deltas of speed and,
+             per channel, position, target, rate, errorFlags
+
+  The first sample of a block is encoded against an all-zero sample with
+  the block's firstTick, so every block decodes on its own and a torn or
+  overwritten block only loses itself.
+*/
+struct __attribute__((packed)) TimeSeriesBlockHeader {
+    uint8_t version;
+    uint8_t channelCount;
+    uint8_t decimation;     // control ticks per sample when the block was written
+    uint8_t sampleCount;
+    uint32_t firstTick;     // ticks restart at 0 after a reboot
+    uint32_t unixTime;      // UTC seconds at firstTick, 0 without a GPS fix
+};
+
+/*
+  The control task only copies a sample into a small RAM staging ring.
+  loop() drains it, delta-encodes into a block buffer and appends a full
+  block at a time. Samples are taken only while a channel is not Stopped,
+  and a part-filled block is written once recording has been idle for a
+  moment.
+
+  Retention (minutes, 0 = whole partition) limits the ring to as many
+  sectors as that time needs at the measured bytes per sample; decimation
+  records every Nth control tick. Both are requested from any task and
+  applied by service(), which owns the ring.
+*/
+class TimeSeriesLog {
+public:
+    static constexpr uint16_t MAGIC = 0x5354; // "TS"
+    static constexpr uint8_t VERSION = 2;
+    static constexpr size_t MAX_BLOCK_BYTES = FlashBlockRing::MAX_BLOCK_BYTES;
+    static constexpr size_t PAYLOAD_CAPACITY = FlashBlockRing::MAX_PAYLOAD_BYTES - sizeof(TimeSeriesBlockHeader);
+    static constexpr size_t MAX_SAMPLE_BYTES = 5 + 3 * (1 + 4 * DISPENSER_CHANNEL_COUNT);
+    static constexpr size_t STAGING_CAPACITY = 32;      // 3.2 s of samples at 10 Hz
+    static constexpr uint32_t IDLE_FLUSH_TICKS = 20;    // write a part-filled block after 2 s without samples
+    static constexpr float DEFAULT_BYTES_PER_SAMPLE = 10.0f; // until measured
+    static constexpr uint8_t MAX_DECIMATION = 100;
+
+    bool begin(FlashRegion* flashRegion);
+    bool isReady() const { return ring.isReady(); }
+
+    // Requested values, live from the next service()
+    void setDecimation(uint8_t ticks);
+    void setRetentionMinutes(uint16_t minutes);
+    inline uint8_t getDecimation() const { return requested.read().decimation; }
+    inline uint16_t getRetentionMinutes() const { return requested.read().retentionMinutes; }
+
+    // Control task: advances the tick counter; true when this tick should be recorded
+    bool isSampleDue(bool recording);
+    void push(TimeSeriesSample& sample);
+
+    // loop(): encode staged samples, program full blocks
+    void service(uint32_t unixTime);
+
+    // Streaming export, oldest block first; readNextBlock() returns 0 at the end
+    inline void rewindReader() { ring.rewindReader(); }
+    inline size_t readNextBlock(uint8_t* out, size_t outSize) { return ring.readNextBlock(out, outSize); }
+
+    inline uint32_t getSequence() const { return ring.getSequence(); }
+    inline size_t getRingSectors() const { return ring.getRingSectors(); }
+    inline size_t getRingBlocks() const { return ring.getRingBlocks(); }
+    inline float getBytesPerSample() const { return bytesPerSample; }
+    inline uint32_t getDroppedSamples() const { return droppedSamples; }
+
+private:
+    struct Settings {
+        uint8_t decimation;
+        uint16_t retentionMinutes;
+    };
+
+    void applySettings();
+    void encode(const TimeSeriesSample& sample);
+    void startBlock(const TimeSeriesSample& first, uint32_t unixTime);
+    void flushBlock();
+    size_t computeRingSectors() const;
+
+    FlashBlockRing ring;
+
+    // Requested by BLE or preferences, taken by loop()
+    SeqLock<Settings> requested{ Settings{ 1, 0 } };
+    uint32_t takenSequence = 0;
+
+    // Applied, written by loop() only
+    volatile uint8_t decimation = 1;
+    uint16_t retentionMinutes = 0;
+
+    // Control task -> loop(), single producer / single consumer
+    SpscRing<TimeSeriesSample, STAGING_CAPACITY> staging;
+    volatile uint32_t tickCounter = 0;
+    volatile uint32_t lastSampleTick = 0;
+    volatile uint32_t droppedSamples = 0;
+
+    // Block being filled, loop() only
+    TimeSeriesBlockHeader header;
+    uint8_t payload[PAYLOAD_CAPACITY];
+    size_t payloadBytes = 0;
+    TimeSeriesSample previous;
+    bool blockOpen = false;
+    float bytesPerSample = DEFAULT_BYTES_PER_SAMPLE;
+};
@@ -0,0 +1,31 @@
+// ============================================
+// File: VarintCodec.h
+// Purpose: LEB128 varints and zigzag deltas shared by the flash log encoders
+// Part of: Storage Layer
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+
+// Small signed values, positive or negative, map to small unsigned ones
+static inline uint32_t zigzag(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+// Seven bits per byte, low group first, high bit set on all but the last
+static inline uint8_t* putVarint(uint8_t* out, uint32_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+static inline uint8_t* putDelta(uint8_t* out, int32_t current, int32_t previous) {
+    return putVarint(out, zigzag(static_cast<int32_t>(static_cast<uint32_t>(current) - static_cast<uint32_t>(previous))));
+}
@@ -0,0 +1,43 @@
+// ============================================
+// File: Arduino.h
+// Purpose: Minimal Arduino core for host tests of the control, storage and GPS code
+// Part of: Host Tests
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include "freertos/FreeRTOS.h"
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define radians(deg) ((deg) * DEG_TO_RAD)
+#define degrees(rad) ((rad) * RAD_TO_DEG)
+#define sq(x) ((x) * (x))
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+#define TWO_PI 6.283185307179586476925286766559
+
+typedef uint8_t byte;
+
+// Only what the headers under test declare with it
+class String {
+public:
+    String(const char* text = "") : value(text ? text : "") {}
+    const char* c_str() const { return value.c_str(); }
+    unsigned length() const { return static_cast<unsigned>(value.size()); }
+
+private:
+    std::string value;
+};
+
+// Simulated clock, advanced by the tests
+unsigned long millis();
+void hostSetMillis(unsigned long value);
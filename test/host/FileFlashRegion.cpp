@@ -0,0 +1,96 @@
+// ============================================
+// File: FileFlashRegion.cpp
+// Purpose: File-backed stand-in for a flash partition in host tests
+// Part of: Host Tests
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include "FileFlashRegion.h"
+#include <string.h>
+
+bool FileFlashRegion::open(const char* path, size_t regionSize) {
+    close();
+    if (regionSize == 0 || regionSize % SECTOR_SIZE != 0) {
+        return false;
+    }
+
+    file = fopen(path, "r+b");
+    if (file == nullptr) {
+        file = fopen(path, "w+b");
+    }
+    if (file == nullptr) {
+        return false;
+    }
+
+    // Whatever the file lacks is blank flash
+    fseek(file, 0, SEEK_END);
+    long existing = ftell(file);
+    uint8_t blank[SECTOR_SIZE];
+    memset(blank, 0xFF, sizeof(blank));
+    for (size_t at = existing > 0 ? static_cast<size_t>(existing) : 0; at < regionSize; ) {
+        size_t chunk = regionSize - at < sizeof(blank) ? regionSize - at : sizeof(blank);
+        if (fwrite(blank, 1, chunk, file) != chunk) {
+            close();
+            return false;
+        }
+        at += chunk;
+    }
+    fflush(file);
+
+    size = regionSize;
+    eraseCounts.assign(size / SECTOR_SIZE, 0);
+    return true;
+}
+
+void FileFlashRegion::close() {
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+    size = 0;
+}
+
+bool FileFlashRegion::read(size_t offset, void* data, size_t length) {
+    if (!inRange(offset, length) || fseek(file, static_cast<long>(offset), SEEK_SET) != 0) {
+        return false;
+    }
+    return fread(data, 1, length, file) == length;
+}
+
+// Programming only turns ones into zeros, like the flash cells
+bool FileFlashRegion::write(size_t offset, const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint8_t cells[256];
+    while (length > 0) {
+        size_t chunk = length < sizeof(cells) ? length : sizeof(cells);
+        if (!read(offset, cells, chunk)) {
+            return false;
+        }
+        for (size_t i = 0; i < chunk; ++i) {
+            cells[i] &= bytes[i];
+        }
+        if (fseek(file, static_cast<long>(offset), SEEK_SET) != 0 || fwrite(cells, 1, chunk, file) != chunk) {
+            return false;
+        }
+        offset += chunk;
+        bytes += chunk;
+        length -= chunk;
+    }
+    return fflush(file) == 0;
+}
+
+bool FileFlashRegion::eraseSector(size_t offset) {
+    offset -= offset % SECTOR_SIZE;
+    if (!inRange(offset, SECTOR_SIZE) || fseek(file, static_cast<long>(offset), SEEK_SET) != 0) {
+        return false;
+    }
+    uint8_t blank[SECTOR_SIZE];
+    memset(blank, 0xFF, sizeof(blank));
+    if (fwrite(blank, 1, sizeof(blank), file) != sizeof(blank) || fflush(file) != 0) {
+        return false;
+    }
+    ++eraseCounts[offset / SECTOR_SIZE];
+    return true;
+}
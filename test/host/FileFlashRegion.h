@@ -0,0 +1,51 @@
+// ============================================
+// File: FileFlashRegion.h
+// Purpose: File-backed stand-in for a flash partition in host tests
+// Part of: Host Tests
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdio.h>
+#include <vector>
+#include "storage/FlashRegion.h"
+
+/*
+  Keeps NOR semantics so logs meet the same constraints as on the chip: a
+  new file starts erased (0xFF), write() can only clear bits, and
+  eraseSector() sets the whole sector containing offset back to 0xFF.
+  Closing and reopening the file is a power cycle; erase counts per sector
+  are kept in RAM for wear checks.
+*/
+class FileFlashRegion : public FlashRegion {
+public:
+    static constexpr size_t SECTOR_SIZE = 4096;  // SPI_FLASH_SEC_SIZE
+
+    FileFlashRegion() = default;
+    FileFlashRegion(const FileFlashRegion&) = delete;
+    FileFlashRegion& operator=(const FileFlashRegion&) = delete;
+    ~FileFlashRegion() { close(); }
+
+    // Opens path, creating or extending it erased up to size (a multiple of SECTOR_SIZE)
+    bool open(const char* path, size_t size);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    bool read(size_t offset, void* data, size_t length) override;
+    bool write(size_t offset, const void* data, size_t length) override;
+    bool eraseSector(size_t offset) override;
+    size_t getSize() const override { return size; }
+    size_t getSectorSize() const override { return SECTOR_SIZE; }
+
+    uint32_t getEraseCount(size_t sector) const { return sector < eraseCounts.size() ? eraseCounts[sector] : 0; }
+
+private:
+    bool inRange(size_t offset, size_t length) const { return file && offset <= size && length <= size - offset; }
+
+    FILE* file = nullptr;
+    size_t size = 0;
+    std::vector<uint32_t> eraseCounts;
+};
@@ -0,0 +1,44 @@
+// ============================================
+// File: GpsReplay.h
+// Purpose: Feeds synthetic fixes through GPSReceiver into GPSProvider for replay tests
+// Part of: Host Tests
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <Arduino.h>
+#include "gps/GPSProvider.h"
+#include "gps/GPSReceiver.h"
+
+/*
+  publish() does what the GPS task does after a sentence, so the provider
+  reads the fix through the same SeqLock and stamps. GPSReceiver and
+  GPSProvider name GpsReplay as a friend for this; the UART side of the
+  receiver is not built for the host.
+*/
+class GpsReplay {
+public:
+    GpsReplay() { provider.setReceiver(&receiver); }
+
+    // A good fix with every motion field stamped now (one RMC + GGA epoch)
+    void publish(double lat, double lng, float speedMps, float courseDeg, uint32_t nowMs) {
+        GPSFix fix = receiver.getFix();
+        ++fix.sentences;
+        fix.locationValid = fix.speedValid = fix.courseValid = true;
+        fix.satellitesValid = fix.hdopValid = true;
+        fix.lat = lat;
+        fix.lng = lng;
+        fix.speedMps = speedMps;
+        fix.courseDeg = courseDeg;
+        fix.satellites = 12;
+        fix.hdop = 0.8f;
+        fix.locationMs = fix.speedMs = fix.courseMs = fix.satellitesMs = fix.hdopMs = nowMs;
+        receiver.fix.write(fix);
+    }
+
+    GPSReceiver receiver;
+    GPSProvider provider;
+};
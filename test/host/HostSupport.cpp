@@ -0,0 +1,102 @@
+// ============================================
+// File: HostSupport.cpp
+// Purpose: Clock, CRC and logging behind the host stubs, linked into every host test
+// Part of: Host Tests
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include <Arduino.h>
+#include <esp_crc.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include "core/LogUtils.h"
+
+static unsigned long hostMillis = 0;
+
+unsigned long millis() {
+    return hostMillis;
+}
+
+void hostSetMillis(unsigned long value) {
+    hostMillis = value;
+}
+
+// Reflected CRC-32 (polynomial 0xEDB88320), same result as the ROM routine
+uint32_t esp_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+    crc = ~crc;
+    while (len--) {
+        crc ^= *buf++;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1UL)));
+        }
+    }
+    return ~crc;
+}
+
+// Warnings and errors only, so test output stays readable; nothing blinks or halts here
+LogLevel LogUtils::currentLogLevel = LogLevel::Warn;
+
+void LogUtils::setLogLevel(LogLevel level) {
+    currentLogLevel = level;
+}
+
+LogLevel LogUtils::getLogLevel() {
+    return currentLogLevel;
+}
+
+const char* LogUtils::logLevelToString(LogLevel level) {
+    switch (level) {
+        case LogLevel::Silent:  return "Silent";
+        case LogLevel::Error:   return "Error";
+        case LogLevel::Warn:    return "Warn";
+        case LogLevel::Info:    return "Info";
+        case LogLevel::Verbose: return "Verbose";
+        default:                return "Unknown";
+    }
+}
+
+static void print(LogLevel level, const char* prefix, const char* format, va_list args) {
+    if (LogUtils::getLogLevel() < level) {
+        return;
+    }
+    printf("%s", prefix);
+    vprintf(format, args);
+}
+
+void LogUtils::die(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    print(LogLevel::Fatal, "[DIE] ", format, args);
+    va_end(args);
+    abort();
+}
+
+void LogUtils::error(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    print(LogLevel::Error, "[ERROR] ", format, args);
+    va_end(args);
+}
+
+void LogUtils::warn(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    print(LogLevel::Warn, "[WARN] ", format, args);
+    va_end(args);
+}
+
+void LogUtils::info(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    print(LogLevel::Info, "[INFO] ", format, args);
+    va_end(args);
+}
+
+void LogUtils::verbose(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    print(LogLevel::Verbose, "[VERBOSE] ", format, args);
+    va_end(args);
+}
@@ -0,0 +1,14 @@
+// ============================================
+// File: Preferences.h
+// Purpose: Placeholder for the NVS wrapper; host tests never touch preferences
+// Part of: Host Tests
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <Arduino.h>
+
+class Preferences {};
@@ -0,0 +1,33 @@
+// ============================================
+// File: TestRandom.h
+// Purpose: Seeded noise source shared by the host tests
+// Part of: Host Tests
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+
+/*
+  The same LCG in every host test, so a failing sequence can be reproduced
+  from its seed. Tests reset their generator in setUp(); a plant model that
+  needs its own stream holds its own instance.
+*/
+class TestRandom {
+public:
+    explicit TestRandom(uint32_t initialSeed = 1) : seed(initialSeed) {}
+
+    void reset(uint32_t newSeed = 1) { seed = newSeed; }
+
+    // Uniform in [low, high), 24-bit resolution
+    float uniform(float low, float high) {
+        seed = seed * 1664525UL + 1013904223UL;
+        return low + (high - low) * ((seed >> 8) / 16777216.0f);
+    }
+
+private:
+    uint32_t seed;
+};
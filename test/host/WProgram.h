@@ -0,0 +1,12 @@
+// ============================================
+// File: WProgram.h
+// Purpose: Pre-1.0 Arduino header name, included by TinyGPSPlus when ARDUINO is not defined
+// Part of: Host Tests
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <Arduino.h>
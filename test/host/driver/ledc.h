@@ -0,0 +1,12 @@
+// ============================================
+// File: ledc.h
+// Purpose: LEDC channel type used by the VNH7070AS header
+// Part of: Host Tests
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+typedef enum { LEDC_CHANNEL_0, LEDC_CHANNEL_1 } ledc_channel_t;
@@ -0,0 +1,12 @@
+// ============================================
+// File: uart.h
+// Purpose: UART port type used by the GPSReceiver header
+// Part of: Host Tests
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+typedef enum { UART_NUM_0, UART_NUM_1, UART_NUM_2 } uart_port_t;
@@ -0,0 +1,14 @@
+// ============================================
+// File: esp_crc.h
+// Purpose: CRC-32 as in the ESP32 ROM, implemented in HostSupport.cpp
+// Part of: Host Tests
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#pragma once
+
+#include <stdint.h>
+
+uint32_t esp_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len);
@@ -0,0 +1,341 @@
+// ============================================
+// File: test_main.cpp
+// Purpose: Coverage map replay over a field: overlap with and without shutoff, cost per tick
+// Part of: Host Tests
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "control/CoverageMap.h"
+
+// Friend of CoverageMap (private constructor)
+class SystemContext {
+public:
+    CoverageMap map;
+};
+
+static const float DT = 0.1f;                 // control tick, one GPS fix per tick
+static const float SPEED_MPS = 3.0f;
+static const float LATENCY_SEC = 1.0f;        // gate lag, also used as look-ahead
+static const int LATENCY_TICKS = 10;
+static const double ORIGIN_LAT = 39.9;
+static const double ORIGIN_LNG = 32.8;
+static const double METRES_PER_DEG_LAT = 6371000.0 * M_PI / 180.0;
+
+// Two sections of 6 m either side of the antenna; the field takes a headland lap
+// and PASSES passes between the side headlands, each swath overlapping its
+// neighbours by half a metre as a driver would leave it
+static const float SECTION_WIDTH = 6.0f;
+static const float SECTION_OFFSET[2] = { -3.0f, 3.0f };
+static const float SWATH = 2.0f * SECTION_WIDTH;
+static const float PASS_OVERLAP = 0.5f;
+static const float PASS_SPACING = SWATH - PASS_OVERLAP;
+static const int PASSES = 8;
+static const float HEADLAND = SWATH;
+static const float FIELD_W = 2.0f * HEADLAND + PASSES * SWATH - (PASSES + 1) * PASS_OVERLAP;
+static const float FIELD_H = 200.0f;
+
+struct Pose {
+    float x;       // east, m
+    float y;       // north, m
+    float course;  // degrees, 0 = north, clockwise
+    bool valid;
+};
+
+// Straights and constant-radius turns sampled at the tick rate
+class TrackBuilder {
+public:
+    std::vector<Pose> poses;
+
+    void start(float x, float y, float course) {
+        px = x;
+        py = y;
+        heading = course;
+        poses.push_back(Pose{ px, py, heading, false }); // first fix after a gap
+    }
+
+    void straight(float distance) {
+        for (float done = 0.0f; done < distance; done += SPEED_MPS * DT) {
+            advance(SPEED_MPS * DT, 0.0f);
+        }
+    }
+
+    // Positive angle turns right
+    void turn(float angleDeg, float radius) {
+        float arc = fabsf(angleDeg) * static_cast<float>(M_PI / 180.0) * radius;
+        int steps = static_cast<int>(ceilf(arc / (SPEED_MPS * DT)));
+        for (int i = 0; i < steps; ++i) {
+            advance(arc / steps, angleDeg / steps);
+        }
+    }
+
+private:
+    void advance(float distance, float turnDeg) {
+        float mid = (heading + 0.5f * turnDeg) * static_cast<float>(M_PI / 180.0);
+        px += distance * sinf(mid);
+        py += distance * cosf(mid);
+        heading = fmodf(heading + turnDeg + 360.0f, 360.0f);
+        poses.push_back(Pose{ px, py, heading, true });
+    }
+
+    float px = 0.0f, py = 0.0f, heading = 0.0f;
+};
+
+// One headland lap around the field, then up-and-back passes driven through the headlands
+static std::vector<Pose> buildTrack() {
+    TrackBuilder track;
+    const float r = HEADLAND / 2.0f;
+    track.start(r, HEADLAND, 0.0f);
+    track.straight(FIELD_H - 2.0f * HEADLAND);
+    track.turn(90.0f, r);
+    track.straight(FIELD_W - 2.0f * HEADLAND);
+    track.turn(90.0f, r);
+    track.straight(FIELD_H - 2.0f * HEADLAND);
+    track.turn(90.0f, r);
+    track.straight(FIELD_W - 2.0f * HEADLAND);
+    track.turn(90.0f, r);
+
+    const float overrun = 8.0f;
+    track.start(HEADLAND - PASS_OVERLAP + SWATH / 2.0f, -overrun, 0.0f);
+    for (int pass = 0; pass < PASSES; ++pass) {
+        track.straight(FIELD_H + 2.0f * overrun);
+        if (pass + 1 < PASSES) {
+            track.turn((pass % 2) ? -180.0f : 180.0f, PASS_SPACING / 2.0f);
+        }
+    }
+    return track.poses;
+}
+
+// Ground truth at 0.2 m: how often each cell was dispensed on, counted once per visit
+class TruthRaster {
+public:
+    static constexpr float CELL = 0.2f;
+    static constexpr float MARGIN = 20.0f;
+    static constexpr int REVISIT_TICKS = 30;   // a later hit than this is a second pass
+
+    TruthRaster()
+        : columns(static_cast<int>((FIELD_W + 2 * MARGIN) / CELL)),
+          rows(static_cast<int>((FIELD_H + 2 * MARGIN) / CELL)),
+          count(static_cast<size_t>(columns) * rows, 0),
+          lastTick(static_cast<size_t>(columns) * rows, -1000) {}
+
+    // Section line swept from the previous to the current pose
+    void sweep(const Pose& from, const Pose& to, float offset, int tick) {
+        const int alongSteps = 4;
+        for (int a = 1; a <= alongSteps; ++a) {
+            float t = static_cast<float>(a) / alongSteps;
+            float x = from.x + (to.x - from.x) * t;
+            float y = from.y + (to.y - from.y) * t;
+            float course = to.course * static_cast<float>(M_PI / 180.0);
+            float rx = cosf(course);   // unit vector to the right of travel
+            float ry = -sinf(course);
+            for (float s = -SECTION_WIDTH / 2.0f; s <= SECTION_WIDTH / 2.0f; s += 0.1f) {
+                hit(x + (offset + s) * rx, y + (offset + s) * ry, tick);
+            }
+        }
+    }
+
+    void summarise(float& coveredM2, float& overlapM2, float& missedM2) const {
+        int covered = 0, overlap = 0, missed = 0;
+        for (int row = 0; row < rows; ++row) {
+            for (int column = 0; column < columns; ++column) {
+                float x = column * CELL - MARGIN + CELL / 2.0f;
+                float y = row * CELL - MARGIN + CELL / 2.0f;
+                if (x < 0.0f || x > FIELD_W || y < 0.0f || y > FIELD_H) {
+                    continue;
+                }
+                uint8_t n = count[static_cast<size_t>(row) * columns + column];
+                covered += n >= 1;
+                overlap += n >= 2;
+                missed += n == 0;
+            }
+        }
+        coveredM2 = covered * CELL * CELL;
+        overlapM2 = overlap * CELL * CELL;
+        missedM2 = missed * CELL * CELL;
+    }
+
+private:
+    void hit(float x, float y, int tick) {
+        int column = static_cast<int>(floorf((x + MARGIN) / CELL));
+        int row = static_cast<int>(floorf((y + MARGIN) / CELL));
+        if (column < 0 || column >= columns || row < 0 || row >= rows) {
+            return;
+        }
+        size_t i = static_cast<size_t>(row) * columns + column;
+        if (tick - lastTick[i] > REVISIT_TICKS && count[i] < 255) {
+            ++count[i];
+        }
+        lastTick[i] = tick;
+    }
+
+    int columns;
+    int rows;
+    std::vector<uint8_t> count;
+    std::vector<int> lastTick;
+};
+
+static Location_t toLocation(const Pose& pose) {
+    double metresPerDegLng = METRES_PER_DEG_LAT * cos(ORIGIN_LAT * M_PI / 180.0);
+    return Location_t(ORIGIN_LAT + pose.y / METRES_PER_DEG_LAT, ORIGIN_LNG + pose.x / metresPerDegLng);
+}
+
+static bool inField(float x, float y) {
+    return x >= 0.0f && x <= FIELD_W && y >= 0.0f && y <= FIELD_H;
+}
+
+struct ReplayResult {
+    float coveredM2;
+    float overlapM2;
+    float missedM2;
+    double nsPerTick;
+    size_t tilesUsed;
+    uint32_t evictions;
+    int ticks;
+};
+
+/*
+  Same per-tick order as ControlLoop::updateCoverage(): pose, a query per
+  section at its look-ahead distance with the channel's close/open
+  hysteresis, then marks for sections that are actually dispensing. The
+  operator opens the sections for ground inside the field one gate lag
+  ahead; what a section does on the ground follows its command after the lag.
+*/
+static ReplayResult replay(const std::vector<Pose>& track, bool shutoff) {
+    std::unique_ptr<SystemContext> context(new SystemContext());
+    CoverageMap& map = context->map;
+    map.setShutoffEnabled(shutoff);
+    std::unique_ptr<TruthRaster> truth(new TruthRaster());
+
+    bool closed[2] = { false, false };
+    bool commanded[2][LATENCY_TICKS] = {};
+    double mapNs = 0.0;
+    int mapTicks = 0;
+
+    for (size_t tick = 0; tick < track.size(); ++tick) {
+        const Pose& pose = track[tick];
+        float course = pose.course * static_cast<float>(M_PI / 180.0);
+        float aheadX = pose.x + SPEED_MPS * LATENCY_SEC * sinf(course);
+        float aheadY = pose.y + SPEED_MPS * LATENCY_SEC * cosf(course);
+        bool active = inField(aheadX, aheadY);
+
+        bool on[2];
+        for (int s = 0; s < 2; ++s) {
+            on[s] = pose.valid && commanded[s][tick % LATENCY_TICKS];
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bool posed = map.updatePose(pose.valid, toLocation(pose), pose.course);
+        if (posed) {
+            for (int s = 0; s < 2; ++s) {
+                float covered = map.queryCovered(SECTION_OFFSET[s], SECTION_WIDTH, SPEED_MPS * LATENCY_SEC);
+                if (!map.isShutoffEnabled()) {
+                    closed[s] = false;
+                } else if (covered >= CoverageMap::CLOSE_FRACTION) {
+                    closed[s] = true;
+                } else if (covered <= CoverageMap::OPEN_FRACTION) {
+                    closed[s] = false;
+                }
+                if (on[s]) {
+                    map.markSection(SECTION_OFFSET[s], SECTION_WIDTH);
+                }
+            }
+        }
+        mapNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        ++mapTicks;
+
+        for (int s = 0; s < 2; ++s) {
+            commanded[s][tick % LATENCY_TICKS] = active && !closed[s];
+            if (on[s] && tick > 0 && track[tick - 1].valid) {
+                truth->sweep(track[tick - 1], pose, SECTION_OFFSET[s], static_cast<int>(tick));
+            }
+        }
+    }
+
+    ReplayResult result;
+    truth->summarise(result.coveredM2, result.overlapM2, result.missedM2);
+    result.nsPerTick = mapNs / mapTicks;
+    result.tilesUsed = map.getTilesUsed();
+    result.evictions = map.getEvictions();
+    result.ticks = mapTicks;
+    return result;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_shutoff_reduces_overlap(void) {
+    std::vector<Pose> track = buildTrack();
+    ReplayResult off = replay(track, false);
+    ReplayResult on = replay(track, true);
+
+    const float fieldM2 = FIELD_W * FIELD_H;
+    char message[200];
+    snprintf(message, sizeof(message), "%d ticks, field %.0f m2: overlap %.0f -> %.0f m2 (%.0f %% less), missed %.0f -> %.0f m2",
+             on.ticks, fieldM2, off.overlapM2, on.overlapM2, 100.0f * (1.0f - on.overlapM2 / off.overlapM2),
+             off.missedM2, on.missedM2);
+    TEST_MESSAGE(message);
+    snprintf(message, sizeof(message), "map cost %.0f ns per tick (pose + 2 queries + 2 marks, host), %u tiles, %u evictions",
+             on.nsPerTick, static_cast<unsigned>(on.tilesUsed), static_cast<unsigned>(on.evictions));
+    TEST_MESSAGE(message);
+
+    // Headland double dosing mostly gone, without opening gaps in the field
+    TEST_ASSERT_GREATER_THAN_FLOAT(0.05f * fieldM2, off.overlapM2);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.5f * off.overlapM2, on.overlapM2);
+    TEST_ASSERT_LESS_THAN_FLOAT(off.missedM2 + 0.01f * fieldM2, on.missedM2);
+
+    // Working set fits the pool for a field this size, and a tick costs far less than its 100 ms
+    TEST_ASSERT_EQUAL_UINT32(0, on.evictions);
+    TEST_ASSERT_LESS_THAN_FLOAT(50000.0, on.nsPerTick);
+}
+
+// A field larger than the pool: old tiles are recycled, the map keeps working with bounded memory
+static void test_large_field_stays_bounded(void) {
+    std::unique_ptr<SystemContext> context(new SystemContext());
+    CoverageMap& map = context->map;
+
+    Pose pose = { 0.0f, 0.0f, 0.0f, true };
+    const float passLength = 1000.0f;
+    int ticks = 0;
+    for (int pass = 0; pass < 40; ++pass) {
+        pose.x = pass * 12.0f;
+        for (float y = 0.0f; y <= passLength; y += SPEED_MPS * DT) {
+            pose.y = (pass % 2) ? passLength - y : y;
+            pose.course = (pass % 2) ? 180.0f : 0.0f;
+            pose.valid = (y > 0.0f);
+            if (map.updatePose(pose.valid, toLocation(pose), pose.course)) {
+                map.markSection(0.0f, 12.0f);
+            }
+            ++ticks;
+        }
+    }
+
+    char message[128];
+    snprintf(message, sizeof(message), "%d ticks over %.0f ha: %u tiles in use, %u evictions",
+             ticks, 40 * 12.0f * passLength / 10000.0f, static_cast<unsigned>(map.getTilesUsed()),
+             static_cast<unsigned>(map.getEvictions()));
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL(CoverageMap::POOL_TILES, map.getTilesUsed());
+    TEST_ASSERT_GREATER_THAN(0, map.getEvictions());
+
+    // Ground of the pass before the last is still known: halfway down the last pass, heading south,
+    // the previous pass is to the right
+    pose = Pose{ 39 * 12.0f, passLength / 2.0f, 180.0f, true };
+    TEST_ASSERT_TRUE(map.updatePose(true, toLocation(pose), pose.course));
+    TEST_ASSERT_GREATER_THAN_FLOAT(0.9f, map.queryCovered(12.0f, 6.0f, 5.0f));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_shutoff_reduces_overlap);
+    RUN_TEST(test_large_field_stays_bounded);
+    return UNITY_END();
+}
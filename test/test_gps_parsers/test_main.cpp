@@ -0,0 +1,282 @@
+// ============================================
+// File: test_main.cpp
+// Purpose: NmeaParser vs TinyGPSPlus on an NMEA corpus: identical fixes, cost per byte
+// Part of: Host Tests
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "gps/NmeaParser.h"
+#include "gps/TinyGpsParser.h"
+#include "TestRandom.h"
+
+static const int EPOCHS = 6000;   // 10 min at 10 Hz
+static const uint32_t EPOCH_MS = 100;
+
+static TestRandom rng;
+
+static bool chance(float probability) {
+    return rng.uniform(0.0f, 1.0f) < probability;
+}
+
+struct Line {
+    std::string text;
+    uint32_t nowMs;
+};
+
+// "$body*hh\r\n", with the checksum in either case
+static std::string sentence(const char* body, bool lowercase) {
+    uint8_t checksum = 0;
+    for (const char* p = body; *p; ++p) {
+        checksum ^= static_cast<uint8_t>(*p);
+    }
+    char text[272];
+    snprintf(text, sizeof(text), lowercase ? "$%s*%02x\r\n" : "$%s*%02X\r\n", body, checksum);
+    return text;
+}
+
+// One character of the body changed: the checksum no longer matches
+static void corrupt(std::string& text) {
+    size_t at = 1 + static_cast<size_t>(rng.uniform(0.0f, 1.0f) * (text.find('*') - 1));
+    text[at] = (text[at] == '7') ? '3' : '7';
+}
+
+static void formatDegrees(char* out, size_t size, double degrees, bool longitude) {
+    double value = fabs(degrees);
+    int whole = static_cast<int>(value);
+    double minutes = (value - whole) * 60.0;
+    snprintf(out, size, longitude ? "%03d%08.5f" : "%02d%08.5f", whole, minutes);
+}
+
+/*
+  A receiver's output for a drive over a field, one epoch every 100 ms:
+  RMC and GGA every epoch, VTG from some receivers, GSA and GSV now and
+  then. Fix loss (RMC 'V', GGA quality 0, with or without a stale position), both
+  hemispheres, negative altitude, lowercase checksums, corrupted bytes and
+  cut-off sentences are mixed in. Only sentences both parsers read the
+  same way: GP/GN talkers, no empty field in a group that gets committed,
+  and VTG only once an RMC has arrived.
+*/
+static std::vector<Line> buildCorpus() {
+    std::vector<Line> corpus;
+    const char* talker = "GP";
+    double lat = 39.912345;
+    double lng = 32.812345;
+    float course = 10.0f;
+    float knots = 5.4f;
+    float altitude = 912.3f;
+    bool rmcArrived = false;
+    bool sendsVtg = false;
+    int fixLostFor = 0;
+
+    for (int epoch = 0; epoch < EPOCHS; ++epoch) {
+        uint32_t now = static_cast<uint32_t>(epoch) * EPOCH_MS + 37;
+
+        // A different receiver, location or configuration every minute
+        if (epoch % 600 == 0) {
+            int setup = epoch / 600;
+            talker = (setup % 2) ? "GN" : "GP";
+            sendsVtg = (setup % 3) == 1;
+            lat = (setup % 4 == 2) ? -33.8688 : 39.912345 + 0.01 * setup;
+            lng = (setup % 4 == 3) ? -58.3816 : 32.812345 - 0.01 * setup;
+            altitude = (setup % 5 == 4) ? -12.6f : 912.3f;
+        }
+        if (fixLostFor == 0 && chance(0.005f)) {
+            fixLostFor = 20;
+        }
+        bool hasFix = fixLostFor == 0;
+        fixLostFor -= fixLostFor > 0 ? 1 : 0;
+
+        course = fmodf(course + rng.uniform(-2.0f, 2.5f) + 360.0f, 360.0f);
+        knots = constrain(knots + rng.uniform(-0.2f, 0.2f), 0.0f, 12.0f);
+        double metres = knots * 0.514444 * EPOCH_MS / 1000.0;
+        lat += metres * cos(radians(course)) / 111195.0;
+        lng += metres * sin(radians(course)) / (111195.0 * cos(radians(lat)));
+        altitude += rng.uniform(-0.05f, 0.05f);
+
+        uint32_t seconds = 8 * 3600 + 14 * 60 + epoch / 10;
+        char timeText[32];
+        snprintf(timeText, sizeof(timeText), "%02u%02u%02u.%02u", seconds / 3600, (seconds / 60) % 60, seconds % 60, (epoch % 10) * 10);
+        char latText[32], lngText[32];
+        formatDegrees(latText, sizeof(latText), lat, false);
+        formatDegrees(lngText, sizeof(lngText), lng, true);
+        char ns = lat < 0 ? 'S' : 'N';
+        char ew = lng < 0 ? 'W' : 'E';
+
+        char body[256];
+        std::string rmc, gga;
+        if (hasFix) {
+            snprintf(body, sizeof(body), "%sRMC,%s,A,%s,%c,%s,%c,%.3f,%.2f,140625,,,A", talker, timeText,
+                     latText, ns, lngText, ew, knots, course);
+            rmc = sentence(body, chance(0.1f));
+            snprintf(body, sizeof(body), "%sGGA,%s,%s,%c,%s,%c,%d,%02d,%.2f,%.1f,M,36.2,M,,", talker, timeText,
+                     latText, ns, lngText, ew, chance(0.2f) ? 2 : 1, 6 + static_cast<int>(rng.uniform(0.0f, 8.0f)),
+                     rng.uniform(0.6f, 2.5f), altitude);
+            gga = sentence(body, false);
+        } else if (epoch % 2) {
+            snprintf(body, sizeof(body), "%sRMC,%s,V,,,,,,,140625,,,N", talker, timeText);
+            rmc = sentence(body, false);
+            snprintf(body, sizeof(body), "%sGGA,%s,,,,,0,%02d,99.99,,,,,,", talker, timeText,
+                     static_cast<int>(rng.uniform(0.0f, 4.0f)));
+            gga = sentence(body, false);
+        } else {
+            // Some receivers keep reporting the last position while flagging it invalid
+            snprintf(body, sizeof(body), "%sRMC,%s,V,%s,%c,%s,%c,%.3f,%.2f,140625,,,N", talker, timeText,
+                     latText, ns, lngText, ew, knots, course);
+            rmc = sentence(body, false);
+            snprintf(body, sizeof(body), "%sGGA,%s,%s,%c,%s,%c,0,%02d,99.99,%.1f,M,36.2,M,,", talker, timeText,
+                     latText, ns, lngText, ew, static_cast<int>(rng.uniform(0.0f, 4.0f)), altitude);
+            gga = sentence(body, false);
+        }
+
+        bool rmcBad = chance(0.01f);
+        if (rmcBad) {
+            corrupt(rmc);
+        } else {
+            rmcArrived = true;
+        }
+        if (chance(0.01f)) {
+            corrupt(gga);
+        }
+        corpus.push_back(Line{ rmc, now });
+
+        if (sendsVtg && rmcArrived && hasFix) {
+            snprintf(body, sizeof(body), "%sVTG,%.2f,T,,M,%.3f,N,%.3f,K,A", talker, course, knots, knots * 1.852f);
+            corpus.push_back(Line{ sentence(body, false), now });
+        }
+        corpus.push_back(Line{ gga, now });
+
+        if (epoch % 10 == 3) {
+            snprintf(body, sizeof(body), "%sGSA,A,3,04,05,09,12,24,25,29,31,,,,,1.8,1.0,1.5", talker);
+            corpus.push_back(Line{ sentence(body, false), now });
+            snprintf(body, sizeof(body), "GPGSV,3,1,11,04,62,210,43,05,23,071,38,09,48,289,45,12,17,155,31");
+            corpus.push_back(Line{ sentence(body, chance(0.5f)), now });
+        }
+        // Sentence cut off by a reset or a dropped UART chunk; the next '$' restarts
+        if (chance(0.003f)) {
+            corpus.push_back(Line{ gga.substr(0, gga.size() / 2), now });
+        }
+    }
+    return corpus;
+}
+
+static void checkSameFix(const GPSFix& a, const GPSFix& b, size_t line) {
+    char where[32];
+    snprintf(where, sizeof(where), "corpus line %u", static_cast<unsigned>(line));
+    TEST_ASSERT_EQUAL_MESSAGE(a.locationValid, b.locationValid, where);
+    TEST_ASSERT_EQUAL_MESSAGE(a.speedValid, b.speedValid, where);
+    TEST_ASSERT_EQUAL_MESSAGE(a.courseValid, b.courseValid, where);
+    TEST_ASSERT_EQUAL_MESSAGE(a.altitudeValid, b.altitudeValid, where);
+    TEST_ASSERT_EQUAL_MESSAGE(a.satellitesValid, b.satellitesValid, where);
+    TEST_ASSERT_EQUAL_MESSAGE(a.hdopValid, b.hdopValid, where);
+    TEST_ASSERT_EQUAL_MESSAGE(a.dateValid, b.dateValid, where);
+    TEST_ASSERT_EQUAL_MESSAGE(a.timeValid, b.timeValid, where);
+
+    // Same fixed point underneath, so the values are bit-identical
+    TEST_ASSERT_TRUE_MESSAGE(a.lat == b.lat && a.lng == b.lng, where);
+    TEST_ASSERT_TRUE_MESSAGE(a.speedMps == b.speedMps && a.courseDeg == b.courseDeg, where);
+    TEST_ASSERT_TRUE_MESSAGE(a.altitudeM == b.altitudeM && a.hdop == b.hdop, where);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(a.satellites, b.satellites, where);
+
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(a.year, b.year, where);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(a.month, b.month, where);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(a.day, b.day, where);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(a.hour, b.hour, where);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(a.minute, b.minute, where);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(a.second, b.second, where);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(a.centisecond, b.centisecond, where);
+
+    // Stamps say which sentence last updated a field; GPSProvider's rates depend on them
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(a.locationMs, b.locationMs, where);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(a.speedMs, b.speedMs, where);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(a.courseMs, b.courseMs, where);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(a.altitudeMs, b.altitudeMs, where);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(a.hdopMs, b.hdopMs, where);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(a.satellitesMs, b.satellitesMs, where);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(a.dateMs, b.dateMs, where);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(a.timeMs, b.timeMs, where);
+}
+
+void setUp(void) {
+    rng.reset();
+}
+
+void tearDown(void) {}
+
+// Both parsers fed byte by byte: the fixes match after every line
+static void test_corpus_gives_identical_fixes(void) {
+    std::vector<Line> corpus = buildCorpus();
+    NmeaParser nmea;
+    TinyGpsParser tiny;
+    size_t bytes = 0;
+    uint32_t committed = 0;
+
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        const Line& line = corpus[i];
+        for (size_t c = 0; c < line.text.size(); ++c) {
+            committed += nmea.encode(line.text[c], line.nowMs) ? 1 : 0;
+            tiny.encode(line.text[c], line.nowMs);
+        }
+        bytes += line.text.size();
+        checkSameFix(nmea.getFix(), tiny.getFix(), i);
+    }
+
+    char message[160];
+    snprintf(message, sizeof(message), "%u lines, %u bytes: %u committed, checksum passed %u / %u, failed %u / %u (NmeaParser / TinyGPSPlus)",
+             static_cast<unsigned>(corpus.size()), static_cast<unsigned>(bytes), committed,
+             nmea.passedChecksum(), tiny.passedChecksum(), nmea.failedChecksum(), tiny.failedChecksum());
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT32(tiny.passedChecksum(), nmea.passedChecksum());
+    TEST_ASSERT_EQUAL_UINT32(tiny.failedChecksum(), nmea.failedChecksum());
+    TEST_ASSERT_GREATER_THAN(0, nmea.failedChecksum());
+    TEST_ASSERT_TRUE(nmea.getFix().locationValid && nmea.getFix().speedValid);
+}
+
+template <typename Parser>
+static double nanosecondsPerByte(const std::string& stream, int repeats) {
+    Parser parser;
+    volatile uint32_t sink = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (size_t i = 0; i < stream.size(); ++i) {
+            sink = sink + (parser.encode(stream[i], static_cast<uint32_t>(i)) ? 1 : 0);
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (static_cast<double>(stream.size()) * repeats);
+}
+
+static void test_benchmark_cost_per_byte(void) {
+    std::vector<Line> corpus = buildCorpus();
+    std::string stream;
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        stream += corpus[i].text;
+    }
+
+    const int repeats = 20;
+    double nmeaNs = nanosecondsPerByte<NmeaParser>(stream, repeats);
+    double tinyNs = nanosecondsPerByte<TinyGpsParser>(stream, repeats);
+
+    char message[160];
+    snprintf(message, sizeof(message), "encode(): NmeaParser %.1f ns, TinyGPSPlus %.1f ns per byte (host); %.0f bytes/s in this corpus",
+             nmeaNs, tinyNs, stream.size() / (EPOCHS * EPOCH_MS / 1000.0));
+    TEST_MESSAGE(message);
+
+    // The point of the in-place parser: it must not cost more than the library
+    TEST_ASSERT_LESS_THAN_FLOAT(tinyNs, nmeaNs);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_corpus_gives_identical_fixes);
+    RUN_TEST(test_benchmark_cost_per_byte);
+    return UNITY_END();
+}
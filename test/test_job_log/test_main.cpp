@@ -0,0 +1,228 @@
+// ============================================
+// File: test_main.cpp
+// Purpose: JobLog on a file-backed partition: append, wrap, torn slots, boot re-scan
+// Part of: Host Tests
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <memory>
+#include "storage/JobLog.h"
+#include "FileFlashRegion.h"
+
+static const char* PATH = "test_job_log.bin";
+static const size_t REGION_SIZE = 0x10000;  // joblog partition in partitions.csv
+static const size_t SLOTS_PER_SECTOR = FileFlashRegion::SECTOR_SIZE / JobLog::getSlotSize();
+static const size_t SLOT_COUNT = REGION_SIZE / JobLog::getSlotSize();
+
+static FileFlashRegion region;
+
+// A record whose contents can be checked from its start time alone
+static JobRecord makeRecord(uint32_t startTime) {
+    JobRecord record;
+    memset(&record, 0, sizeof(record));
+    record.startTime = startTime;
+    record.endTime = startTime ? startTime + 3600 : 0;
+    record.wallSeconds = 3600;
+    for (size_t i = 0; i < DISPENSER_CHANNEL_COUNT; ++i) {
+        record.channels[i].areaM2 = startTime * 0.5f + i;
+        record.channels[i].durationSec = startTime % 7000;
+        record.channels[i].errorSeconds[i] = static_cast<uint16_t>(startTime % 60);
+    }
+    return record;
+}
+
+static void checkRecord(const JobRecord& record, uint32_t jobNumber) {
+    JobRecord expected = makeRecord(record.startTime);
+    TEST_ASSERT_EQUAL_UINT32(JobLog::MAGIC, record.magic);
+    TEST_ASSERT_EQUAL_UINT32(jobNumber, record.jobNumber);
+    TEST_ASSERT_EQUAL_MEMORY(expected.channels, record.channels, sizeof(expected.channels));
+}
+
+// Power cycle: the file is closed and the log rebuilt from what is on "flash"
+static std::unique_ptr<JobLog> reboot() {
+    region.close();
+    TEST_ASSERT_TRUE(region.open(PATH, REGION_SIZE));
+    std::unique_ptr<JobLog> log(new JobLog());
+    TEST_ASSERT_TRUE(log->begin(&region));
+    return log;
+}
+
+static void appendJobs(JobLog& log, uint32_t firstStartTime, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        JobRecord record = makeRecord(firstStartTime + static_cast<uint32_t>(i) * 10);
+        TEST_ASSERT_TRUE(log.append(record));
+    }
+}
+
+// Index entries are in job order, consecutive, and every one reads back intact
+static void checkIndex(const JobLog& log) {
+    for (size_t i = 0; i < log.getCount(); ++i) {
+        const JobLog::IndexEntry& entry = log.getEntry(i);
+        TEST_ASSERT_EQUAL_UINT32(log.getFirstJob() + i, entry.jobNumber);
+        JobRecord record;
+        TEST_ASSERT_TRUE(log.readJob(entry.jobNumber, record));
+        TEST_ASSERT_EQUAL_UINT32(entry.startTime, record.startTime);
+        checkRecord(record, entry.jobNumber);
+    }
+}
+
+void setUp(void) {
+    remove(PATH);
+    TEST_ASSERT_TRUE(region.open(PATH, REGION_SIZE));
+}
+
+void tearDown(void) {
+    region.close();
+    remove(PATH);
+}
+
+static void test_region_keeps_nor_semantics(void) {
+    uint8_t value = 0xF0;
+    uint8_t read = 0;
+    TEST_ASSERT_TRUE(region.write(10, &value, 1));
+    value = 0x3C;
+    TEST_ASSERT_TRUE(region.write(10, &value, 1));
+    TEST_ASSERT_TRUE(region.read(10, &read, 1));
+    TEST_ASSERT_EQUAL_UINT8(0x30, read);
+
+    TEST_ASSERT_TRUE(region.eraseSector(100));
+    TEST_ASSERT_TRUE(region.read(10, &read, 1));
+    TEST_ASSERT_EQUAL_UINT8(0xFF, read);
+    TEST_ASSERT_FALSE(region.read(REGION_SIZE - 1, &read, 2));
+}
+
+static void test_append_and_query(void) {
+    std::unique_ptr<JobLog> log(new JobLog());
+    TEST_ASSERT_TRUE(log->begin(&region));
+    TEST_ASSERT_EQUAL(0, log->getCount());
+
+    appendJobs(*log, 1000, 20);
+    TEST_ASSERT_EQUAL(20, log->getCount());
+    TEST_ASSERT_EQUAL_UINT32(1, log->getFirstJob());
+    TEST_ASSERT_EQUAL_UINT32(20, log->getLastJob());
+    checkIndex(*log);
+
+    // A job without a GPS fix has no start time and is never found by date
+    JobRecord noFix = makeRecord(0);
+    TEST_ASSERT_TRUE(log->append(noFix));
+    TEST_ASSERT_EQUAL_UINT32(21, noFix.jobNumber);
+    TEST_ASSERT_EQUAL_UINT32(6, log->findFirstJobAtOrAfter(1045));
+    TEST_ASSERT_EQUAL_UINT32(0, log->findFirstJobAtOrAfter(5000));
+    TEST_ASSERT_EQUAL(5, log->lowerBound(6));
+
+    JobRecord record;
+    TEST_ASSERT_FALSE(log->readJob(22, record));
+    TEST_ASSERT_FALSE(log->readJob(0, record));
+}
+
+// Many times the capacity: the oldest sector is recycled, erases are spread evenly
+static void test_wrap_drops_oldest_and_levels_wear(void) {
+    std::unique_ptr<JobLog> log(new JobLog());
+    TEST_ASSERT_TRUE(log->begin(&region));
+
+    const size_t jobs = 5 * SLOT_COUNT + 7;
+    appendJobs(*log, 1, jobs);
+
+    TEST_ASSERT_EQUAL_UINT32(jobs, log->getLastJob());
+    TEST_ASSERT_LESS_OR_EQUAL(log->getCapacity() + SLOTS_PER_SECTOR, log->getCount());
+    TEST_ASSERT_GREATER_OR_EQUAL(log->getCapacity(), log->getCount());
+    checkIndex(*log);
+
+    JobRecord record;
+    TEST_ASSERT_FALSE(log->readJob(log->getFirstJob() - 1, record));
+
+    uint32_t fewest = UINT32_MAX;
+    uint32_t most = 0;
+    for (size_t sector = 0; sector < REGION_SIZE / FileFlashRegion::SECTOR_SIZE; ++sector) {
+        uint32_t erases = region.getEraseCount(sector);
+        fewest = erases < fewest ? erases : fewest;
+        most = erases > most ? erases : most;
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(fewest + 1, most);
+}
+
+// A write cut short at the head leaves a dirty slot; the next append moves to a fresh sector
+static void test_torn_slot_is_skipped(void) {
+    std::unique_ptr<JobLog> log(new JobLog());
+    TEST_ASSERT_TRUE(log->begin(&region));
+    appendJobs(*log, 100, 5);
+
+    JobRecord torn = makeRecord(999);
+    torn.magic = JobLog::MAGIC;
+    TEST_ASSERT_TRUE(region.write(5 * JobLog::getSlotSize(), &torn, sizeof(torn) / 3));
+
+    // Same session: the dirty slot is noticed before writing over it
+    JobRecord next = makeRecord(200);
+    TEST_ASSERT_TRUE(log->append(next));
+    TEST_ASSERT_EQUAL(SLOTS_PER_SECTOR, log->getEntry(log->getCount() - 1).slot);
+    checkIndex(*log);
+
+    // After a reboot the torn slot fails its CRC and is not indexed
+    log = reboot();
+    TEST_ASSERT_EQUAL(6, log->getCount());
+    TEST_ASSERT_EQUAL_UINT32(6, log->getLastJob());
+    checkIndex(*log);
+
+    appendJobs(*log, 300, 3);
+    TEST_ASSERT_EQUAL_UINT32(9, log->getLastJob());
+    TEST_ASSERT_EQUAL(SLOTS_PER_SECTOR + 3, log->getEntry(log->getCount() - 1).slot);
+}
+
+// Torn write found only at boot: the scan ignores it and the head still follows the newest record
+static void test_torn_slot_after_power_loss(void) {
+    std::unique_ptr<JobLog> log(new JobLog());
+    TEST_ASSERT_TRUE(log->begin(&region));
+    appendJobs(*log, 100, 3);
+
+    JobRecord torn = makeRecord(999);
+    torn.magic = JobLog::MAGIC;
+    torn.jobNumber = 4;
+    TEST_ASSERT_TRUE(region.write(3 * JobLog::getSlotSize(), &torn, offsetof(JobRecord, channels)));
+
+    log = reboot();
+    TEST_ASSERT_EQUAL(3, log->getCount());
+    appendJobs(*log, 500, 1);
+    TEST_ASSERT_EQUAL_UINT32(4, log->getLastJob());
+    TEST_ASSERT_EQUAL(SLOTS_PER_SECTOR, log->getEntry(3).slot);
+    checkIndex(*log);
+}
+
+// The boot scan rebuilds the same index, in job order, from a wrapped log
+static void test_boot_rescan_rebuilds_index(void) {
+    std::unique_ptr<JobLog> log(new JobLog());
+    TEST_ASSERT_TRUE(log->begin(&region));
+    appendJobs(*log, 1000, 2 * SLOT_COUNT + SLOTS_PER_SECTOR / 2);
+
+    std::unique_ptr<JobLog> rebooted = reboot();
+    TEST_ASSERT_EQUAL(log->getCount(), rebooted->getCount());
+    for (size_t i = 0; i < log->getCount(); ++i) {
+        TEST_ASSERT_EQUAL_UINT32(log->getEntry(i).jobNumber, rebooted->getEntry(i).jobNumber);
+        TEST_ASSERT_EQUAL_UINT32(log->getEntry(i).startTime, rebooted->getEntry(i).startTime);
+        TEST_ASSERT_EQUAL_UINT16(log->getEntry(i).slot, rebooted->getEntry(i).slot);
+    }
+    TEST_ASSERT_EQUAL_UINT32(log->findFirstJobAtOrAfter(5000), rebooted->findFirstJobAtOrAfter(5000));
+
+    // Numbering continues where it stopped, writing right after the newest slot
+    uint32_t last = rebooted->getLastJob();
+    size_t lastSlot = rebooted->getEntry(rebooted->getCount() - 1).slot;
+    appendJobs(*rebooted, 90000, 1);
+    TEST_ASSERT_EQUAL_UINT32(last + 1, rebooted->getLastJob());
+    TEST_ASSERT_EQUAL((lastSlot + 1) % SLOT_COUNT, rebooted->getEntry(rebooted->getCount() - 1).slot);
+    checkIndex(*rebooted);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_region_keeps_nor_semantics);
+    RUN_TEST(test_append_and_query);
+    RUN_TEST(test_wrap_drops_oldest_and_levels_wear);
+    RUN_TEST(test_torn_slot_is_skipped);
+    RUN_TEST(test_torn_slot_after_power_loss);
+    RUN_TEST(test_boot_rescan_rebuilds_index);
+    return UNITY_END();
+}
@@ -0,0 +1,271 @@
+// ============================================
+// File: test_main.cpp
+// Purpose: Speed-profile replay: dose error along the track with and without look-ahead
+// Part of: Host Tests
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include "control/ActuatorLatencyEstimator.h"
+#include "control/PIController.h"
+#include "GpsReplay.h"
+#include "TestRandom.h"
+
+static const float DT = 1.0f / CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
+static const uint32_t TICK_MS = 1000 / CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
+static const float PERCENT_PER_MPS = 20.0f;   // gate opening for the target rate, per m/s of speed
+static const double ORIGIN_LAT = 39.9;
+static const double ORIGIN_LNG = 32.8;
+static const double METRES_PER_DEG_LAT = 6371000.0 * M_PI / 180.0;
+
+static TestRandom rng;
+
+/*
+  Ground speed of a spreading job as the tractor drives it: pull away,
+  passes at working speed with throttle variation, slowing for the
+  headland turn and accelerating out of it, a stop to refill. Synthetic,
+  shaped after logged runs: accelerations within ±0.8 m/s².
+*/
+struct SpeedSegment {
+    float durationSec;
+    float speedMps;     // reached at the given acceleration, then held
+    float accelMps2;
+};
+
+static const SpeedSegment PROFILE[] = {
+    {  15.0f, 3.0f, 0.5f },     // pull away
+    {  40.0f, 3.3f, 0.2f },
+    {  20.0f, 2.7f, 0.3f },
+    {  10.0f, 1.2f, 0.8f },     // headland turn
+    {  25.0f, 3.2f, 0.6f },
+    {  30.0f, 3.6f, 0.3f },
+    {  10.0f, 1.0f, 0.8f },     // headland turn
+    {  20.0f, 3.4f, 0.5f },
+    {  15.0f, 2.4f, 0.4f },     // soft ground
+    {  25.0f, 3.4f, 0.4f },
+    {  12.0f, 0.0f, 0.6f },     // stop to refill
+    {  20.0f, 3.0f, 0.5f },
+};
+
+static std::vector<float> buildSpeedTrace() {
+    std::vector<float> trace;
+    float speed = 0.0f;
+    for (size_t s = 0; s < sizeof(PROFILE) / sizeof(PROFILE[0]); ++s) {
+        const SpeedSegment& segment = PROFILE[s];
+        for (int t = 0; t < static_cast<int>(segment.durationSec / DT); ++t) {
+            float step = segment.accelMps2 * DT;
+            float delta = segment.speedMps - speed;
+            speed += (delta > step) ? step : (delta < -step ? -step : delta);
+            trace.push_back(speed);
+        }
+    }
+    return trace;
+}
+
+/*
+  The gate under its position controller as seen from the target: a dead
+  time before it starts moving, then a first-order approach limited by the
+  motor's travel speed.
+*/
+struct SimulatedGate {
+    static constexpr int DEAD_TICKS = 3;
+    static constexpr float TIME_CONSTANT_SEC = 0.4f;
+    static constexpr float MAX_RATE = 25.0f;   // %/s
+    static constexpr float NOISE = 0.05f;      // %, potentiometer reading
+
+    float position = 0.0f;
+    float pending[DEAD_TICKS] = {};
+    int head = 0;
+
+    void step(float target) {
+        float delayed = pending[head];
+        pending[head] = target;
+        head = (head + 1) % DEAD_TICKS;
+
+        float rate = (delayed - position) / TIME_CONSTANT_SEC;
+        position += constrain(rate, -MAX_RATE, MAX_RATE) * DT;
+    }
+
+    float measure() const {
+        return constrain(position + rng.uniform(-NOISE, NOISE), 0.0f, 100.0f);
+    }
+};
+
+// Friend of ActuatorLatencyEstimator; same look-ahead choice as the real channel
+class DispenserChannel {
+public:
+    ActuatorLatencyEstimator latencyEstimator;
+    SimulatedGate gate;
+    float actuatorLatencySec = 0.0f;
+    bool latencyLearning = false;
+
+    float getLookAheadSec() const {
+        float latency = (latencyLearning && latencyEstimator.hasEstimate()) ? latencyEstimator.getEstimate() : actuatorLatencySec;
+        return constrain(latency, 0.0f, GPSProvider::MAX_PREDICTION_HORIZON_SEC);
+    }
+
+    // One control tick: target from the predicted speed, estimator fed, gate moved
+    void tick(const GPSProvider& provider) {
+        float target = constrain(PERCENT_PER_MPS * provider.getPredictedSpeed(getLookAheadSec(), true), 0.0f, 100.0f);
+        latencyEstimator.observe(target, gate.measure(), DT);
+        gate.step(target);
+    }
+};
+
+struct ReplayResult {
+    float doseErrorPercent;   // misapplied product over the track, % of the target amount
+    float latenessM;          // distance the gate's rate changes trail the wanted ones
+    float distanceM;
+};
+
+/*
+  Drives the trace north along a straight line, one GPS fix per tick with
+  the receiver's speed noise. The product put down in each tick is
+  proportional to the gate opening, the wanted amount to the true speed,
+  so the dose error per metre of track is |gate - wanted| integrated over
+  time. Lateness is the shift along the track that best lines the gate's
+  profile up with the wanted one.
+*/
+static ReplayResult replay(DispenserChannel& channel, const std::vector<float>& trace) {
+    static const int MAX_SHIFT_TICKS = 30;
+    GpsReplay gps;
+    ReplayResult result = { 0.0f, 0.0f, 0.0f };
+    std::vector<float> gate;
+    std::vector<float> wanted;
+    std::vector<float> trackM;
+    double northM = 0.0;
+
+    rng.reset();
+    for (size_t t = 0; t < trace.size(); ++t) {
+        uint32_t now = static_cast<uint32_t>((t + 1) * TICK_MS);
+        hostSetMillis(now);
+        float reported = trace[t] > 0.0f ? fmaxf(trace[t] + rng.uniform(-0.03f, 0.03f), 0.0f) : 0.0f;
+        gps.publish(ORIGIN_LAT + northM / METRES_PER_DEG_LAT, ORIGIN_LNG, reported, 0.0f, now);
+        gps.provider.update();
+
+        channel.tick(gps.provider);
+
+        northM += trace[t] * DT;
+        gate.push_back(channel.gate.position);
+        wanted.push_back(PERCENT_PER_MPS * trace[t]);
+        trackM.push_back(static_cast<float>(northM));
+    }
+
+    float misapplied = 0.0f;
+    float total = 0.0f;
+    for (size_t t = 0; t < trace.size(); ++t) {
+        misapplied += fabsf(gate[t] - wanted[t]) * DT;
+        total += wanted[t] * DT;
+    }
+
+    float bestError = INFINITY;
+    int bestShift = 0;
+    for (int shift = 0; shift <= MAX_SHIFT_TICKS; ++shift) {
+        float error = 0.0f;
+        for (size_t t = MAX_SHIFT_TICKS; t < trace.size(); ++t) {
+            error += fabsf(gate[t] - wanted[t - shift]);
+        }
+        if (error < bestError) {
+            bestError = error;
+            bestShift = shift;
+        }
+    }
+    size_t last = trace.size() - 1;
+    result.latenessM = (trackM[last] - trackM[MAX_SHIFT_TICKS]) * bestShift / (last - MAX_SHIFT_TICKS);
+
+    result.doseErrorPercent = 100.0f * misapplied / total;
+    result.distanceM = static_cast<float>(northM);
+    return result;
+}
+
+static void report(const char* name, const DispenserChannel& channel, const ReplayResult& result) {
+    char message[160];
+    snprintf(message, sizeof(message), "%-10s look-ahead %.2f s: dose error %5.2f %% over %.0f m, rate changes %.2f m late",
+             name, channel.getLookAheadSec(), result.doseErrorPercent, result.distanceM, result.latenessM);
+    TEST_MESSAGE(message);
+}
+
+void setUp(void) {
+    rng.reset();
+}
+
+void tearDown(void) {}
+
+static void rampGate(DispenserChannel& channel, float periodSec, int ticks) {
+    for (int t = 0; t < ticks; ++t) {
+        float target = 10.0f + 50.0f * fabsf(fmodf(2.0f * t * DT / periodSec, 2.0f) - 1.0f);
+        channel.latencyEstimator.observe(target, channel.gate.measure(), DT);
+        channel.gate.step(target);
+    }
+}
+
+// Speed changes make ramps, not steps: the learned lag is the one the gate shows on them
+static void test_estimator_learns_ramp_lag(void) {
+    DispenserChannel channel;
+    rampGate(channel, 10.0f, 600);   // 10 %/s
+
+    float expected = SimulatedGate::DEAD_TICKS * DT + SimulatedGate::TIME_CONSTANT_SEC;
+    char message[96];
+    snprintf(message, sizeof(message), "learned %.2f s from %u samples, gate ramp lag %.2f s",
+             channel.latencyEstimator.getEstimate(), channel.latencyEstimator.getSampleCount(), expected);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_GREATER_OR_EQUAL(10, channel.latencyEstimator.getSampleCount());
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, expected, channel.latencyEstimator.getEstimate());
+
+    // A ramp slow enough to follow inside the settle band gives no sample at all
+    DispenserChannel slow;
+    rampGate(slow, 120.0f, 1200);    // 0.83 %/s
+    TEST_ASSERT_FALSE(slow.latencyEstimator.hasEstimate());
+}
+
+// The look-ahead puts rate changes down where the speed changes, not metres later
+static void test_look_ahead_reduces_spatial_error(void) {
+    std::vector<float> trace = buildSpeedTrace();
+
+    DispenserChannel none;
+    ReplayResult noneResult = replay(none, trace);
+    report("none", none, noneResult);
+
+    DispenserChannel configured;
+    configured.actuatorLatencySec = SimulatedGate::DEAD_TICKS * DT + SimulatedGate::TIME_CONSTANT_SEC;
+    ReplayResult configuredResult = replay(configured, trace);
+    report("configured", configured, configuredResult);
+
+    DispenserChannel learned;
+    learned.latencyLearning = true;
+    ReplayResult learnedResult = replay(learned, trace);
+    report("learned", learned, learnedResult);
+
+    TEST_ASSERT_TRUE(learned.latencyEstimator.hasEstimate());
+    TEST_ASSERT_LESS_THAN_FLOAT(noneResult.doseErrorPercent * 0.7f, configuredResult.doseErrorPercent);
+    TEST_ASSERT_LESS_THAN_FLOAT(noneResult.doseErrorPercent * 0.7f, learnedResult.doseErrorPercent);
+    TEST_ASSERT_LESS_THAN_FLOAT(noneResult.latenessM, learnedResult.latenessM);
+}
+
+// A steady speed gives nothing to anticipate: look-ahead must not add error of its own
+static void test_look_ahead_neutral_at_constant_speed(void) {
+    std::vector<float> trace(1200, 3.0f);
+
+    DispenserChannel none;
+    ReplayResult noneResult = replay(none, trace);
+    DispenserChannel configured;
+    configured.actuatorLatencySec = 1.0f;
+    ReplayResult configuredResult = replay(configured, trace);
+
+    report("none", none, noneResult);
+    report("configured", configured, configuredResult);
+    TEST_ASSERT_TRUE(configuredResult.doseErrorPercent <= noneResult.doseErrorPercent);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_estimator_learns_ramp_lag);
+    RUN_TEST(test_look_ahead_reduces_spatial_error);
+    RUN_TEST(test_look_ahead_neutral_at_constant_speed);
+    return UNITY_END();
+}
@@ -0,0 +1,284 @@
+// ============================================
+// File: test_main.cpp
+// Purpose: MPC vs PI on a simulated gate: constraints, settling and compute time
+// Part of: Host Tests
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include "control/MPCController.h"
+#include "control/PIController.h"
+#include "control/GatePlantModel.h"
+#include "control/SetpointShaper.h"
+#include "io/VNH7070AS.h"
+#include "TestRandom.h"
+
+static const float DT = 1.0f / CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
+
+/*
+  The real gate, not the model: static friction above the modelled
+  deadband, a lower speed per duty than the initial model gain, and a
+  potentiometer reading with a little noise.
+*/
+struct SimulatedGate {
+    static constexpr int STICTION_DUTY = 14;
+    static constexpr float GAIN = 0.25f;  // %/s per duty
+    static constexpr float NOISE = 0.05f; // %
+
+    float position = 20.0f;
+    TestRandom noise;
+
+    void step(int duty) {
+        if (abs(duty) >= STICTION_DUTY) {
+            position = constrain(position + GAIN * duty * DT, 0.0f, 100.0f);
+        }
+    }
+
+    float measure() {
+        return constrain(position + noise.uniform(-NOISE, NOISE), 0.0f, 100.0f);
+    }
+};
+
+// Friend of the controllers and the shaper; runs the same per-tick sequence as the real channel
+class DispenserChannel {
+public:
+    SetpointShaper shaper;
+    PIController pi;
+    MPCController mpc;
+    GatePlantModel model;
+    SimulatedGate gate;
+    bool useMpc = false;
+
+    int tick(float rawTarget) {
+        float measured = gate.measure();
+        float target = shaper.update(rawTarget, DT);
+        int signal;
+        if (useMpc) {
+            mpc.setPlantGain(model.getGain());
+            mpc.setReferenceTrend(shaper.getRate(), rawTarget);
+            mpc.compute(target, measured);
+            signal = mpc.getControlSignal();
+        } else {
+            pi.compute(target, measured);
+            signal = pi.getControlSignal();
+        }
+        model.observe(measured, signal, DT);
+        gate.step(signal);
+        return signal;
+    }
+
+    // MPC state a test starts from, through the friendship
+    void setMpcSignal(int duty) { mpc.controlSignal = duty; }
+    void setBreakaway(int duty) { mpc.breakawayDuty = duty; }
+    int getBreakaway() const { return mpc.breakawayDuty; }
+
+    void start(RampProfile profile) {
+        shaper.setProfile(profile);
+        shaper.reset(gate.position);
+        pi.reset(gate.position);
+        mpc.reset(gate.position);
+    }
+};
+
+struct StepResult {
+    float settleSec;   // until within SETTLE_BAND for good; NAN if never
+    float iae;         // integral of |raw target - position|, %·s
+    float overshoot;   // % past the raw target
+    int maxSlew;       // largest duty change between ticks
+};
+
+static constexpr float SETTLE_BAND = 1.0f;
+static constexpr int STEP_TICKS = 80;
+
+static const float STEPS[] = { 60.0f, 25.0f, 90.0f, 85.0f, 40.0f, 42.0f, 5.0f, 70.0f };
+static const size_t STEP_COUNT = sizeof(STEPS) / sizeof(STEPS[0]);
+
+static void runSchedule(DispenserChannel& channel, StepResult* results) {
+    int lastSignal = 0;
+    for (size_t s = 0; s < STEP_COUNT; ++s) {
+        float raw = STEPS[s];
+        float start = channel.gate.position;
+        StepResult& r = results[s];
+        r.settleSec = NAN;
+        r.iae = 0.0f;
+        r.overshoot = 0.0f;
+        r.maxSlew = 0;
+
+        for (int t = 0; t < STEP_TICKS; ++t) {
+            int signal = channel.tick(raw);
+            r.maxSlew = abs(signal - lastSignal) > r.maxSlew ? abs(signal - lastSignal) : r.maxSlew;
+            lastSignal = signal;
+
+            float position = channel.gate.position;
+            float error = raw - position;
+            r.iae += fabsf(error) * DT;
+            float past = (raw > start) ? -error : error;
+            r.overshoot = past > r.overshoot ? past : r.overshoot;
+
+            if (fabsf(error) > SETTLE_BAND) {
+                r.settleSec = NAN;
+            } else if (isnan(r.settleSec)) {
+                r.settleSec = (t + 1) * DT;
+            }
+        }
+    }
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// maxSettleRatio bounds the MPC's total settling time against the PI's on the same schedule
+static void compareOnProfile(RampProfile profile, float maxSettleRatio) {
+    DispenserChannel piChannel;
+    DispenserChannel mpcChannel;
+    mpcChannel.useMpc = true;
+    piChannel.start(profile);
+    mpcChannel.start(profile);
+
+    StepResult pi[STEP_COUNT];
+    StepResult mpc[STEP_COUNT];
+    runSchedule(piChannel, pi);
+    runSchedule(mpcChannel, mpc);
+
+    float piIae = 0.0f, mpcIae = 0.0f, piSettle = 0.0f, mpcSettle = 0.0f;
+    int piUnsettled = 0;
+    for (size_t s = 0; s < STEP_COUNT; ++s) {
+        char line[160];
+        snprintf(line, sizeof(line), "%s step to %5.1f %%: settle PI %5.1f s / MPC %5.1f s, IAE %6.1f / %6.1f, overshoot %4.1f / %4.1f %%",
+                 SetpointShaper::profileToString(profile), STEPS[s], pi[s].settleSec, mpc[s].settleSec,
+                 pi[s].iae, mpc[s].iae, pi[s].overshoot, mpc[s].overshoot);
+        TEST_MESSAGE(line);
+
+        // Slew limit is a hard constraint for the MPC, not for the PI
+        TEST_ASSERT_LESS_OR_EQUAL(MPCController::MAX_DUTY_STEP, mpc[s].maxSlew);
+        TEST_ASSERT_FALSE(isnan(mpc[s].settleSec));
+        piUnsettled += isnan(pi[s].settleSec) ? 1 : 0;
+        piIae += pi[s].iae;
+        mpcIae += mpc[s].iae;
+        piSettle += isnan(pi[s].settleSec) ? STEP_TICKS * DT : pi[s].settleSec;
+        mpcSettle += mpc[s].settleSec;
+    }
+
+    char summary[160];
+    snprintf(summary, sizeof(summary), "%s total: settle PI %.1f s (%d unsettled) / MPC %.1f s, IAE %.1f / %.1f",
+             SetpointShaper::profileToString(profile), piSettle, piUnsettled, mpcSettle, piIae, mpcIae);
+    TEST_MESSAGE(summary);
+    TEST_ASSERT_LESS_OR_EQUAL(piIae * 1.05f, mpcIae);
+    TEST_ASSERT_TRUE(mpcSettle <= piSettle * maxSettleRatio);
+}
+
+// The PI overshoots and never settles on most steps; the MPC settles on all of them, faster
+static void test_settling_fast_ramp(void) {
+    compareOnProfile(RampProfile::Fast, 1.0f);
+}
+
+/*
+  Known regression: on the Gentle ramp the MPC settles later than the PI,
+  27.4 s against 22.6 s over the schedule (seven of the eight steps 0.2 to
+  0.9 s later), for a slightly lower IAE and no overshoot. The bound keeps
+  it from growing.
+*/
+static void test_settling_gentle_ramp(void) {
+    compareOnProfile(RampProfile::Gentle, 1.25f);
+}
+
+// Near the end stops the travel constraint must keep the output inside the range
+static void test_output_respects_travel_and_duty_limits(void) {
+    DispenserChannel channel;
+    channel.useMpc = true;
+    channel.gate.position = 97.0f;
+    channel.start(RampProfile::Off);
+
+    for (int t = 0; t < 50; ++t) {
+        float before = channel.gate.position;
+        int signal = channel.tick(100.0f);
+        TEST_ASSERT_LESS_OR_EQUAL(VNH7070AS::MAX_DUTY, abs(signal));
+        // As the model predicts it, with the noise of the reading the bound was computed from
+        TEST_ASSERT_TRUE(before + channel.model.getGain() * signal * DT <= 100.0f + SimulatedGate::NOISE);
+    }
+}
+
+// Running into an end stop faster than the slew limit can take back: brake at the slew limit
+static void test_empty_constraint_interval_keeps_slew(void) {
+    DispenserChannel channel;
+    channel.useMpc = true;
+    channel.start(RampProfile::Off);
+    channel.setMpcSignal(VNH7070AS::MAX_DUTY);
+
+    channel.mpc.compute(100.0f, 99.5f);
+    TEST_ASSERT_EQUAL_INT(VNH7070AS::MAX_DUTY - MPCController::MAX_DUTY_STEP, channel.mpc.getControlSignal());
+
+    channel.setMpcSignal(-VNH7070AS::MAX_DUTY);
+    channel.mpc.compute(0.0f, 0.5f);
+    TEST_ASSERT_EQUAL_INT(-VNH7070AS::MAX_DUTY + MPCController::MAX_DUTY_STEP, channel.mpc.getControlSignal());
+}
+
+// A breakaway learned at a stiction peak comes back down once the gate moves freely again
+static void test_breakaway_relaxes_after_sustained_motion(void) {
+    DispenserChannel channel;
+    channel.useMpc = true;
+    channel.start(RampProfile::Gentle);
+    channel.setBreakaway(MPCController::MAX_BREAKAWAY_DUTY);
+
+    // Two passes of the schedule, some two minutes of work
+    StepResult results[STEP_COUNT];
+    runSchedule(channel, results);
+    runSchedule(channel, results);
+
+    char message[96];
+    snprintf(message, sizeof(message), "breakaway %d -> %d duty, gate stiction %d",
+             MPCController::MAX_BREAKAWAY_DUTY, channel.getBreakaway(), SimulatedGate::STICTION_DUTY);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_THAN(MPCController::MAX_BREAKAWAY_DUTY / 2, channel.getBreakaway());
+    TEST_ASSERT_GREATER_OR_EQUAL(SimulatedGate::STICTION_DUTY - MPCController::BREAKAWAY_STEP, channel.getBreakaway());
+}
+
+static void test_benchmark_compute_time(void) {
+    DispenserChannel channel;
+    channel.useMpc = true;
+    channel.start(RampProfile::Gentle);
+
+    const int calls = 1000000;
+    volatile int sink = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; ++i) {
+        channel.mpc.setReferenceTrend((i & 1) ? 15.0f : -15.0f, (i & 2) ? 80.0f : 20.0f);
+        channel.mpc.compute(static_cast<float>(i % 101), static_cast<float>((i * 37) % 101));
+        sink = sink + channel.mpc.getControlSignal();
+    }
+    std::chrono::duration<double, std::nano> mpcElapsed = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; ++i) {
+        channel.pi.compute(static_cast<float>(i % 101), static_cast<float>((i * 37) % 101));
+        sink = sink + channel.pi.getControlSignal();
+    }
+    std::chrono::duration<double, std::nano> piElapsed = std::chrono::steady_clock::now() - start;
+
+    double mpcNs = mpcElapsed.count() / calls;
+    double piNs = piElapsed.count() / calls;
+    char message[128];
+    snprintf(message, sizeof(message), "compute(): MPC %.1f ns, PI %.1f ns per call (host); control period %.0f ms",
+             mpcNs, piNs, DT * 1000.0f);
+    TEST_MESSAGE(message);
+
+    // A 240 MHz core is some 10-50x slower than the host; still far inside 1 % of the period
+    TEST_ASSERT_LESS_THAN_FLOAT(DT * 1e9 * 0.01 / 50.0, mpcNs);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_settling_fast_ramp);
+    RUN_TEST(test_settling_gentle_ramp);
+    RUN_TEST(test_output_respects_travel_and_duty_limits);
+    RUN_TEST(test_empty_constraint_interval_keeps_slew);
+    RUN_TEST(test_breakaway_relaxes_after_sustained_motion);
+    RUN_TEST(test_benchmark_compute_time);
+    return UNITY_END();
+}
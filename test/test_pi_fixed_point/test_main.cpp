@@ -0,0 +1,241 @@
+// ============================================
+// File: test_main.cpp
+// Purpose: Float vs Q16.16 PI controller: numeric agreement and cost per compute
+// Part of: Host Tests
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include "control/PIController.h"
+#include "io/VNH7070AS.h"
+#include "TestRandom.h"
+
+// Friend of PIControllerT; owns one controller of each number type
+class DispenserChannel {
+public:
+    PIControllerT<float> floating;
+    PIControllerT<Q16_16> fixed;
+
+    void setGains(float kp, float ki, float kd) {
+        floating.setPIKp(kp);
+        floating.setPIKi(ki);
+        floating.setPIKd(kd);
+        fixed.setPIKp(kp);
+        fixed.setPIKi(ki);
+        fixed.setPIKd(kd);
+    }
+};
+
+static const float DT = 1.0f / CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
+
+// The gate as a motor on a screw: speed proportional to duty once it clears static friction
+static float stepGate(float position, int signal) {
+    if (abs(signal) < 10) {
+        return position;
+    }
+    return constrain(position + 0.3f * signal * DT, 0.0f, 100.0f);
+}
+
+static TestRandom rng;
+
+void setUp(void) {
+    rng.reset();
+}
+
+void tearDown(void) {}
+
+// Same inputs into both: outputs differ only by Q16.16 quantization
+static void test_open_loop_outputs_match(void) {
+    DispenserChannel channel;
+    channel.setGains(25.0f, 4.0f, 0.5f);
+
+    float worstOutput = 0.0f;
+    float worstIntegral = 0.0f;
+    int signalMismatches = 0;
+    const int steps = 20000;
+    for (int i = 0; i < steps; ++i) {
+        float setpoint = rng.uniform(0.0f, 100.0f);
+        float measured = constrain(setpoint + rng.uniform(-8.0f, 8.0f), 0.0f, 100.0f);
+        float a = channel.floating.compute(setpoint, measured);
+        float b = channel.fixed.compute(setpoint, measured);
+
+        worstOutput = fmaxf(worstOutput, fabsf(a - b));
+        worstIntegral = fmaxf(worstIntegral, fabsf(channel.floating.getIntegral() - channel.fixed.getIntegral()));
+        int signalDelta = abs(channel.floating.getControlSignal() - channel.fixed.getControlSignal());
+        TEST_ASSERT_LESS_OR_EQUAL(1, signalDelta);
+        signalMismatches += signalDelta;
+    }
+
+    char message[128];
+    snprintf(message, sizeof(message), "max |output diff| %.5f duty, max |integral diff| %.5f, integer signal differs in %d/%d ticks",
+             worstOutput, worstIntegral, signalMismatches, steps);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.0f, worstOutput);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, worstIntegral);
+    TEST_ASSERT_LESS_THAN(steps / 100, signalMismatches);
+}
+
+// Each controller drives its own copy of the gate through a setpoint schedule
+static void test_closed_loop_trajectories_match(void) {
+    DispenserChannel channel;
+    channel.setGains(DEFAULT_KP_VALUE, DEFAULT_KI_VALUE, DEFAULT_KD_VALUE);
+
+    const float schedule[] = { 40.0f, 75.0f, 10.0f, 55.5f, 100.0f, 0.0f, 33.3f };
+    float floatPosition = 20.0f;
+    float fixedPosition = 20.0f;
+    float worst = 0.0f;
+    for (size_t s = 0; s < sizeof(schedule) / sizeof(schedule[0]); ++s) {
+        for (int tick = 0; tick < 100; ++tick) {
+            channel.floating.compute(schedule[s], floatPosition);
+            channel.fixed.compute(schedule[s], fixedPosition);
+            floatPosition = stepGate(floatPosition, channel.floating.getControlSignal());
+            fixedPosition = stepGate(fixedPosition, channel.fixed.getControlSignal());
+            worst = fmaxf(worst, fabsf(floatPosition - fixedPosition));
+        }
+    }
+
+    char message[96];
+    snprintf(message, sizeof(message), "max |position diff| %.4f %%", worst);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 0.0f, worst);
+}
+
+// Saturated for a long time, then released: both integrals sit at the same clamp
+static void test_anti_windup_matches(void) {
+    DispenserChannel channel;
+    channel.setGains(25.0f, 4.0f, 0.0f);
+
+    for (int i = 0; i < 500; ++i) {
+        channel.floating.compute(100.0f, 0.0f);
+        channel.fixed.compute(100.0f, 0.0f);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, VNH7070AS::MAX_DUTY / 4.0f, channel.floating.getIntegral());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, channel.floating.getIntegral(), channel.fixed.getIntegral());
+
+    // Overshoot: the output leaves saturation on the same tick in both
+    int floatRelease = -1;
+    int fixedRelease = -1;
+    for (int i = 0; i < 200 && (floatRelease < 0 || fixedRelease < 0); ++i) {
+        channel.floating.compute(50.0f, 60.0f);
+        channel.fixed.compute(50.0f, 60.0f);
+        if (floatRelease < 0 && channel.floating.getControlSignal() < VNH7070AS::MAX_DUTY) floatRelease = i;
+        if (fixedRelease < 0 && channel.fixed.getControlSignal() < VNH7070AS::MAX_DUTY) fixedRelease = i;
+    }
+    TEST_ASSERT_GREATER_OR_EQUAL(0, floatRelease);
+    TEST_ASSERT_EQUAL_INT(floatRelease, fixedRelease);
+}
+
+// Output the controller would hold with its current state, from the public getters
+template <typename T>
+static float heldOutput(const PIControllerT<T>& controller) {
+    return controller.getPIKp() * controller.getError() + controller.getPIKi() * controller.getIntegral() -
+           controller.getPIKd() * controller.getDerivative();
+}
+
+// Gain changes rescale the integral so the held output does not jump, in both
+static void test_gain_change_keeps_output_continuous(void) {
+    DispenserChannel channel;
+    channel.setGains(25.0f, 4.0f, 0.2f);
+
+    for (int i = 0; i < 30; ++i) {
+        channel.floating.compute(60.0f, 55.0f + 0.1f * i);
+        channel.fixed.compute(60.0f, 55.0f + 0.1f * i);
+    }
+    float floatBefore = heldOutput(channel.floating);
+    float fixedBefore = heldOutput(channel.fixed);
+
+    channel.setGains(18.0f, 6.5f, 0.4f);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, floatBefore, heldOutput(channel.floating));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, fixedBefore, heldOutput(channel.fixed));
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, channel.floating.compute(60.0f, 58.0f), channel.fixed.compute(60.0f, 58.0f));
+}
+
+// Taking over a running gate: the first output is the duty already applied, in both
+static void test_track_continues_from_applied_duty(void) {
+    DispenserChannel channel;
+    channel.setGains(DEFAULT_KP_VALUE, DEFAULT_KI_VALUE, DEFAULT_KD_VALUE);
+
+    const int applied = 37;
+    channel.floating.track(56.0f, 55.0f, applied);
+    channel.fixed.track(56.0f, 55.0f, applied);
+    TEST_ASSERT_FALSE(channel.floating.isControlSignalChanged());
+    TEST_ASSERT_FALSE(channel.fixed.isControlSignalChanged());
+
+    channel.floating.compute(56.0f, 55.0f);
+    channel.fixed.compute(56.0f, 55.0f);
+    TEST_ASSERT_INT_WITHIN(1, applied, channel.floating.getControlSignal());
+    TEST_ASSERT_INT_WITHIN(1, applied, channel.fixed.getControlSignal());
+    TEST_ASSERT_GREATER_THAN_FLOAT(0.0f, channel.floating.getIntegral());
+
+    // A full reset instead starts from Kp * e alone
+    channel.floating.reset(55.0f);
+    channel.floating.compute(56.0f, 55.0f);
+    TEST_ASSERT_LESS_THAN(applied - 1, channel.floating.getControlSignal());
+}
+
+// Two controllers of one type must not mask each other's signal changes
+static void test_change_tracking_is_per_instance(void) {
+    DispenserChannel left;
+    DispenserChannel right;
+
+    left.fixed.compute(60.0f, 50.0f);
+    right.fixed.compute(60.0f, 50.0f);
+    TEST_ASSERT_TRUE(left.fixed.isControlSignalChanged());
+    TEST_ASSERT_TRUE(right.fixed.isControlSignalChanged());
+    TEST_ASSERT_FALSE(left.fixed.isControlSignalChanged());
+}
+
+// Host cost of one computeRaw(); the fixed path has no float operation to time on the target FPU
+template <typename T>
+static double nanosecondsPerCompute(PIControllerT<T>& controller) {
+    typedef PINumeric<T> Num;
+    const int calls = 2000000;
+    T setpoints[64];
+    T measurements[64];
+    for (int i = 0; i < 64; ++i) {
+        setpoints[i] = Num::fromFloat(rng.uniform(0.0f, 100.0f));
+        measurements[i] = Num::fromFloat(rng.uniform(0.0f, 100.0f));
+    }
+
+    volatile int sink = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; ++i) {
+        sink = sink + Num::toInt(controller.computeRaw(setpoints[i & 63], measurements[(i * 7) & 63]));
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / calls;
+}
+
+static void test_benchmark_compute_cost(void) {
+    DispenserChannel channel;
+    channel.setGains(25.0f, 4.0f, 0.5f);
+
+    double floatNs = nanosecondsPerCompute(channel.floating);
+    double fixedNs = nanosecondsPerCompute(channel.fixed);
+
+    char message[128];
+    snprintf(message, sizeof(message), "computeRaw: float %.1f ns, Q16.16 %.1f ns per call (host)", floatNs, fixedNs);
+    TEST_MESSAGE(message);
+
+    // Orders of magnitude inside the 100 ms tick even on a much slower core
+    TEST_ASSERT_LESS_THAN_FLOAT(10000.0, floatNs);
+    TEST_ASSERT_LESS_THAN_FLOAT(10000.0, fixedNs);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_open_loop_outputs_match);
+    RUN_TEST(test_closed_loop_trajectories_match);
+    RUN_TEST(test_anti_windup_matches);
+    RUN_TEST(test_gain_change_keeps_output_continuous);
+    RUN_TEST(test_track_continues_from_applied_duty);
+    RUN_TEST(test_change_tracking_is_per_instance);
+    RUN_TEST(test_benchmark_compute_cost);
+    return UNITY_END();
+}
@@ -0,0 +1,223 @@
+// ============================================
+// File: test_main.cpp
+// Purpose: Curved-track replay: ground covered per section with and without turn compensation
+// Part of: Host Tests
+//
+// License: Proprietary License
+// Author: Mehmet H Suzer
+// Date: 13 June 2025
+// ============================================
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include "control/PIController.h"
+#include "GpsReplay.h"
+#include "TestRandom.h"
+
+static const float DT = 1.0f / CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
+static const uint32_t TICK_MS = 1000 / CONTROL_LOOP_UPDATE_FREQUENCY_HZ;
+static const double ORIGIN_LAT = 39.9;
+static const double ORIGIN_LNG = 32.8;
+static const double METRES_PER_DEG_LAT = 6371000.0 * M_PI / 180.0;
+static const float COURSE_NOISE_DEG = 0.3f;
+static const float SPEED_NOISE_MPS = 0.03f;
+
+// Sections across a 12 m boom, positive to the right of the antenna
+static const float OFFSETS[] = { -5.0f, -3.0f, -1.0f, 1.0f, 3.0f, 5.0f };
+static const size_t SECTION_COUNT = sizeof(OFFSETS) / sizeof(OFFSETS[0]);
+
+static TestRandom rng;
+
+struct Pose {
+    double x;       // east, m
+    double y;       // north, m
+    float course;   // degrees, 0 = north, clockwise
+    float speed;    // m/s
+    bool turning;
+};
+
+// Straights and constant-radius turns sampled at the tick rate
+class TrackBuilder {
+public:
+    std::vector<Pose> poses;
+
+    void straight(float distance, float speed) {
+        int steps = static_cast<int>(ceilf(distance / (speed * DT)));
+        for (int i = 0; i < steps; ++i) {
+            advance(speed, 0.0f);
+        }
+    }
+
+    // Positive angle turns right
+    void turn(float angleDeg, float radius, float speed) {
+        float arc = fabsf(angleDeg) * static_cast<float>(M_PI / 180.0) * radius;
+        int steps = static_cast<int>(ceilf(arc / (speed * DT)));
+        for (int i = 0; i < steps; ++i) {
+            advance(arc / steps / DT, angleDeg / steps);
+        }
+    }
+
+private:
+    void advance(float speed, float turnDeg) {
+        double mid = (heading + 0.5 * turnDeg) * M_PI / 180.0;
+        x += speed * DT * sin(mid);
+        y += speed * DT * cos(mid);
+        heading = fmod(heading + turnDeg + 360.0, 360.0);
+        poses.push_back(Pose{ x, y, static_cast<float>(heading), speed, turnDeg != 0.0f });
+    }
+
+    double x = 0.0, y = 0.0, heading = 0.0;
+};
+
+/*
+  A field edge as a tractor drives it: a straight, a 90° right bend around
+  a corner, a headland U-turn to the left, an S-bend along a curved field
+  boundary, a tight turn at reduced speed, and back onto a straight.
+  Synthetic, at speeds and radii of logged jobs.
+*/
+static std::vector<Pose> buildTrack() {
+    TrackBuilder track;
+    track.straight(40.0f, 2.8f);
+    track.turn(90.0f, 20.0f, 2.8f);
+    track.straight(30.0f, 2.8f);
+    track.turn(-180.0f, 9.0f, 1.8f);
+    track.straight(30.0f, 2.8f);
+    track.turn(45.0f, 30.0f, 3.0f);
+    track.turn(-45.0f, 30.0f, 3.0f);
+    track.straight(20.0f, 3.0f);
+    track.turn(120.0f, 7.0f, 1.5f);
+    track.straight(40.0f, 2.8f);
+    return track.poses;
+}
+
+struct SectionResult {
+    float trueM;          // ground the section actually covered
+    float compensatedM;   // speed × section factor, as the channel meters it
+    float plainM;         // centre-line speed for every section
+    float compensatedErrorM;
+    float plainErrorM;    // per-tick |estimate - true|, so errors of opposite turns do not cancel
+};
+
+/*
+  Replays the track one GPS fix per tick with course and speed noise, and
+  meters each section's ground per tick both ways. The section's true
+  path is the offset point of consecutive poses.
+*/
+static void replay(const std::vector<Pose>& track, bool turnsOnly, SectionResult* results) {
+    GpsReplay gps;
+    for (size_t i = 0; i < SECTION_COUNT; ++i) {
+        results[i] = SectionResult{ 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    }
+
+    for (size_t t = 0; t < track.size(); ++t) {
+        const Pose& pose = track[t];
+        uint32_t now = static_cast<uint32_t>((t + 1) * TICK_MS);
+        hostSetMillis(now);
+        float course = fmodf(pose.course + rng.uniform(-COURSE_NOISE_DEG, COURSE_NOISE_DEG) + 360.0f, 360.0f);
+        float speed = pose.speed + rng.uniform(-SPEED_NOISE_MPS, SPEED_NOISE_MPS);
+        gps.publish(ORIGIN_LAT + pose.y / METRES_PER_DEG_LAT,
+                    ORIGIN_LNG + pose.x / (METRES_PER_DEG_LAT * cos(ORIGIN_LAT * M_PI / 180.0)),
+                    speed, course, now);
+        gps.provider.update();
+
+        if (t == 0 || (turnsOnly && !pose.turning)) {
+            continue;
+        }
+
+        const Pose& previous = track[t - 1];
+        double before = previous.course * M_PI / 180.0;
+        double after = pose.course * M_PI / 180.0;
+        for (size_t i = 0; i < SECTION_COUNT; ++i) {
+            // Unit vector to the right of travel is (cos, -sin) of the course
+            double dx = (pose.x + OFFSETS[i] * cos(after)) - (previous.x + OFFSETS[i] * cos(before));
+            double dy = (pose.y - OFFSETS[i] * sin(after)) - (previous.y - OFFSETS[i] * sin(before));
+            float trueStep = static_cast<float>(sqrt(dx * dx + dy * dy));
+            float compensatedStep = gps.provider.getSpeed(true) * gps.provider.getSectionSpeedFactor(OFFSETS[i]) * DT;
+            float plainStep = gps.provider.getSpeed(true) * DT;
+
+            SectionResult& r = results[i];
+            r.trueM += trueStep;
+            r.compensatedM += compensatedStep;
+            r.plainM += plainStep;
+            r.compensatedErrorM += fabsf(compensatedStep - trueStep);
+            r.plainErrorM += fabsf(plainStep - trueStep);
+        }
+    }
+}
+
+void setUp(void) {
+    rng.reset();
+}
+
+void tearDown(void) {}
+
+// In the bends each section meters its own ground, not the centre line's
+static void test_sections_meter_their_own_ground_in_turns(void) {
+    std::vector<Pose> track = buildTrack();
+    SectionResult results[SECTION_COUNT];
+    replay(track, true, results);
+
+    float compensatedError = 0.0f;
+    float plainError = 0.0f;
+    for (size_t i = 0; i < SECTION_COUNT; ++i) {
+        const SectionResult& r = results[i];
+        char message[160];
+        snprintf(message, sizeof(message), "offset %+4.1f m: true %6.1f m, compensated %6.1f m (%5.1f %% off), plain %6.1f m (%5.1f %% off)",
+                 OFFSETS[i], r.trueM, r.compensatedM, 100.0f * r.compensatedErrorM / r.trueM,
+                 r.plainM, 100.0f * r.plainErrorM / r.trueM);
+        TEST_MESSAGE(message);
+
+        // Outer sections, at least: the plain estimate is well off there
+        if (fabsf(OFFSETS[i]) >= 3.0f) {
+            TEST_ASSERT_LESS_THAN_FLOAT(r.plainErrorM * 0.3f, r.compensatedErrorM);
+        }
+        compensatedError += r.compensatedErrorM;
+        plainError += r.plainErrorM;
+    }
+
+    char summary[96];
+    snprintf(summary, sizeof(summary), "misapplied along the bends: compensated %.1f m, plain %.1f m of section travel",
+             compensatedError, plainError);
+    TEST_MESSAGE(summary);
+    TEST_ASSERT_LESS_THAN_FLOAT(plainError * 0.25f, compensatedError);
+}
+
+// Over the whole track the error is bounded by the yaw filter's lag at the ends of the bends
+static void test_whole_track_error_stays_small(void) {
+    std::vector<Pose> track = buildTrack();
+    SectionResult results[SECTION_COUNT];
+    replay(track, false, results);
+
+    for (size_t i = 0; i < SECTION_COUNT; ++i) {
+        const SectionResult& r = results[i];
+        TEST_ASSERT_LESS_THAN_FLOAT(r.trueM * 0.03f, r.compensatedErrorM);
+        TEST_ASSERT_FLOAT_WITHIN(r.trueM * 0.01f, r.trueM, r.compensatedM);
+    }
+}
+
+// Course jitter on a straight pass stays inside the deadband: no worse than no compensation
+static void test_straight_pass_barely_changes(void) {
+    TrackBuilder track;
+    track.straight(200.0f, 2.8f);
+    SectionResult results[SECTION_COUNT];
+    replay(track.poses, false, results);
+
+    for (size_t i = 0; i < SECTION_COUNT; ++i) {
+        const SectionResult& r = results[i];
+        char message[128];
+        snprintf(message, sizeof(message), "straight, offset %+4.1f m: compensated %5.2f %% off, plain %5.2f %% off",
+                 OFFSETS[i], 100.0f * r.compensatedErrorM / r.trueM, 100.0f * r.plainErrorM / r.trueM);
+        TEST_MESSAGE(message);
+        TEST_ASSERT_TRUE(r.compensatedErrorM <= r.plainErrorM);
+        TEST_ASSERT_FLOAT_WITHIN(r.trueM * 0.001f, r.plainM, r.compensatedM);
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_sections_meter_their_own_ground_in_turns);
+    RUN_TEST(test_whole_track_error_stays_small);
+    RUN_TEST(test_straight_pass_barely_changes);
+    return UNITY_END();
+}
@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+# ============================================
+# File: asapplied_decode.py
+# Purpose: Decodes downloaded as-applied blocks into CSV or GeoJSON
+# Part of: Host tools
+#
+# License: Proprietary License
+# Author: Mehmet H Suzer
+# Date: 13 June 2025
+# ============================================
+"""
+Input is either the raw BLE notifications of getAsAppliedBlock written back
+to back into one file, or a serial capture in which each block is a line
+"getAsAppliedBlock=<hex>" (other lines are ignored). Layouts follow
+src/storage/FlashBlockRing.h and src/storage/AsAppliedLog.h.
+
+    asapplied_decode.py capture.txt --format geojson -o field.geojson
+"""
+
+import argparse
+import binascii
+import csv
+import json
+import re
+import struct
+import sys
+import zlib
+from datetime import datetime, timezone
+
+RING_HEADER = struct.Struct("<HHII")        # magic, payloadBytes, sequence, crc
+BLOCK_HEADER = struct.Struct("<BBBBII")     # version, channelCount, pointCount, tickRateHz, firstTick, unixTime
+MAGIC = 0x4141
+VERSION = 1
+HEX_LINE = re.compile(r"^(?:getAsAppliedBlock=)?([0-9A-Fa-f]+)\s*$")
+
+
+def split_blocks(data):
+    """Consecutive ring blocks; the header says how long each one is."""
+    offset = 0
+    while offset + RING_HEADER.size <= len(data):
+        magic, length, sequence, crc = RING_HEADER.unpack_from(data, offset)
+        end = offset + RING_HEADER.size + length
+        if end > len(data):
+            break
+        yield data[offset:end]
+        offset = end
+
+
+def read_blocks(path):
+    with open(path, "rb") as f:
+        raw = f.read()
+    try:
+        lines = raw.decode("ascii").splitlines()
+    except UnicodeDecodeError:
+        lines = None
+
+    if lines is not None:
+        matches = [HEX_LINE.match(line.strip()) for line in lines]
+        blocks = [binascii.unhexlify(m.group(1)) for m in matches if m and len(m.group(1)) % 2 == 0]
+        if blocks:
+            return blocks
+    return list(split_blocks(raw))
+
+
+def read_varint(data, offset):
+    value = 0
+    shift = 0
+    while True:
+        if offset >= len(data):
+            raise ValueError("truncated varint")
+        byte = data[offset]
+        offset += 1
+        value |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return value, offset
+        shift += 7
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def decode_block(block):
+    """Returns (sequence, points) or None when the block is not a valid as-applied block."""
+    if len(block) < RING_HEADER.size + BLOCK_HEADER.size:
+        return None
+    magic, length, sequence, crc = RING_HEADER.unpack_from(block, 0)
+    payload = block[RING_HEADER.size:RING_HEADER.size + length]
+    if magic != MAGIC or len(payload) != length:
+        return None
+    if zlib.crc32(block[:RING_HEADER.size - 4] + payload) & 0xFFFFFFFF != crc:
+        return None
+
+    version, channels, count, tick_rate, first_tick, unix_time = BLOCK_HEADER.unpack_from(payload, 0)
+    if version != VERSION or tick_rate == 0:
+        return None
+
+    offset = BLOCK_HEADER.size
+    tick, lat, lng = first_tick, 0, 0
+    rates = [0] * channels
+    points = []
+    for _ in range(count):
+        delta, offset = read_varint(payload, offset)
+        tick = (tick + delta) & 0xFFFFFFFF
+        value, offset = read_varint(payload, offset)
+        lat += unzigzag(value)
+        value, offset = read_varint(payload, offset)
+        lng += unzigzag(value)
+        for i in range(channels):
+            value, offset = read_varint(payload, offset)
+            rates[i] += unzigzag(value)
+
+        elapsed = ((tick - first_tick) & 0xFFFFFFFF) / tick_rate
+        points.append({
+            "time": unix_time + elapsed if unix_time else None,
+            "tick": tick,
+            "lat": lat / 1e7,
+            "lng": lng / 1e7,
+            "rates": [r / 100.0 for r in rates],
+        })
+    return sequence, points
+
+
+def iso_time(t):
+    if t is None:
+        return ""
+    return datetime.fromtimestamp(t, tz=timezone.utc).isoformat().replace("+00:00", "Z")
+
+
+def write_csv(points, out):
+    channels = max((len(p["rates"]) for p in points), default=0)
+    writer = csv.writer(out, lineterminator="\n")
+    writer.writerow(["time", "tick", "lat", "lng"] + ["rate%d_kg_per_daa" % (i + 1) for i in range(channels)])
+    for p in points:
+        writer.writerow([iso_time(p["time"]), p["tick"], "%.7f" % p["lat"], "%.7f" % p["lng"]] +
+                        ["%.2f" % r for r in p["rates"]])
+
+
+def write_geojson(points, out):
+    features = []
+    for p in points:
+        properties = {"time": iso_time(p["time"]) or None, "tick": p["tick"]}
+        for i, rate in enumerate(p["rates"]):
+            properties["rate%d" % (i + 1)] = rate
+        features.append({
+            "type": "Feature",
+            "geometry": {"type": "Point", "coordinates": [round(p["lng"], 7), round(p["lat"], 7)]},
+            "properties": properties,
+        })
+    json.dump({"type": "FeatureCollection", "features": features}, out)
+    out.write("\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode as-applied map blocks")
+    parser.add_argument("input", help="raw block dump or serial capture")
+    parser.add_argument("--format", choices=("csv", "geojson"), default="csv")
+    parser.add_argument("-o", "--output", help="output file (default: stdout)")
+    args = parser.parse_args()
+
+    decoded = []
+    skipped = 0
+    for block in read_blocks(args.input):
+        result = decode_block(block)
+        if result is None:
+            skipped += 1
+            continue
+        decoded.append(result)
+    decoded.sort(key=lambda r: r[0])
+    points = [p for _, block_points in decoded for p in block_points]
+
+    out = open(args.output, "w", newline="") if args.output else sys.stdout
+    try:
+        if args.format == "csv":
+            write_csv(points, out)
+        else:
+            write_geojson(points, out)
+    finally:
+        if args.output:
+            out.close()
+
+    print("%d blocks, %d points, %d skipped" % (len(decoded), len(points), skipped), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()